@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+// Renders a binary sync run log (OWNCLOUD_SYNC_RUN_LOG_BINARY=1) as the text sync run log.
+
+#include <iostream>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QTextStream>
+
+#include "syncrunlogformat.h"
+
+using namespace OCC;
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    const auto args = app.arguments();
+    if (args.size() != 2) {
+        std::cerr << "Usage: " << qPrintable(args.value(0)) << " <folder>_sync.log.bin.gz" << std::endl;
+        return 1;
+    }
+
+    if (!SyncRunLogFormat::isBinaryLogSupported()) {
+        std::cerr << "Built without zlib, binary sync run logs can't be read" << std::endl;
+        return 1;
+    }
+
+    const auto fileName = args.at(1);
+    const auto data = SyncRunLogFormat::readBinaryLog(fileName);
+    if (!data.startsWith(SyncRunLogFormat::binaryMagic)) {
+        std::cerr << qPrintable(fileName) << " is not a binary sync run log" << std::endl;
+        return 1;
+    }
+
+    QDataStream in(data.mid(SyncRunLogFormat::binaryMagicSize));
+    in.setVersion(SyncRunLogFormat::streamVersion);
+    QTextStream out(stdout);
+
+    SyncRunLogFormat::Record record;
+    while (!in.atEnd()) {
+        if (!SyncRunLogFormat::readRecord(in, record)) {
+            out.flush();
+            std::cerr << "Truncated or corrupt record at offset " << SyncRunLogFormat::binaryMagicSize + in.device()->pos() << std::endl;
+            return 1;
+        }
+        out << SyncRunLogFormat::toText(record);
+    }
+    return 0;
+}
@@ -17,6 +17,7 @@
  */
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QString>
 #include <QFile>
@@ -221,6 +222,14 @@ sqlite3 *SqlDatabase::sqliteDb()
 
 /* =========================================================================================== */
 
+void SqlQueryStatistics::addStepTime(qint64 nsec)
+{
+    totalNsec += nsec;
+    maxStepNsec = qMax(maxStepNsec, nsec);
+}
+
+/* =========================================================================================== */
+
 SqlQuery::SqlQuery(SqlDatabase &db)
     : _sqldb(&db)
     , _db(db.sqliteDb())
@@ -297,8 +306,16 @@ bool SqlQuery::exec()
         return false;
     }
 
+    if (_statistics) {
+        ++_statistics->executions;
+    }
+
     // Don't do anything for selects, that is how we use the lib :-|
     if (!isSelect() && !isPragma()) {
+        QElapsedTimer stepTimer;
+        if (_statistics) {
+            stepTimer.start();
+        }
         int rc = 0, n = 0;
         do {
             rc = sqlite3_step(_stmt);
@@ -313,6 +330,13 @@ bool SqlQuery::exec()
         } while ((n < SQLITE_REPEAT_COUNT) && ((rc == SQLITE_BUSY) || (rc == SQLITE_LOCKED)));
         _errId = rc;
 
+        if (_statistics) {
+            _statistics->addStepTime(stepTimer.nsecsElapsed());
+            if (_errId == SQLITE_DONE) {
+                _statistics->rows += sqlite3_changes(_db);
+            }
+        }
+
         if (_errId != SQLITE_DONE && _errId != SQLITE_ROW) {
             _error = QString::fromUtf8(sqlite3_errmsg(_db));
             qCWarning(lcSql) << "Sqlite exec statement error:" << _errId << _error << "in" << _sql;
@@ -333,6 +357,10 @@ auto SqlQuery::next() -> NextResult
 {
     const bool firstStep = !sqlite3_stmt_busy(_stmt);
 
+    QElapsedTimer stepTimer;
+    if (_statistics) {
+        stepTimer.start();
+    }
     int n = 0;
     forever {
         _errId = sqlite3_step(_stmt);
@@ -348,6 +376,12 @@ auto SqlQuery::next() -> NextResult
     NextResult result;
     result.ok = _errId == SQLITE_ROW || _errId == SQLITE_DONE;
     result.hasData = _errId == SQLITE_ROW;
+    if (_statistics) {
+        _statistics->addStepTime(stepTimer.nsecsElapsed());
+        if (result.hasData) {
+            ++_statistics->rows;
+        }
+    }
     if (!result.ok) {
         _error = QString::fromUtf8(sqlite3_errmsg(_db));
         qCWarning(lcSql) << "Sqlite step statement error:" << _errId << _error << "in" << _sql;
@@ -33,6 +33,24 @@ OCSYNC_EXPORT Q_DECLARE_LOGGING_CATEGORY(lcSql)
 
 class SqlQuery;
 
+/**
+ * @brief Counters of a statement cached by PreparedSqlQueryManager
+ * @ingroup libsync
+ */
+struct OCSYNC_EXPORT SqlQueryStatistics
+{
+    quint64 prepares = 0;
+    quint64 reuses = 0;
+    quint64 executions = 0;
+    /// Rows returned by a select, rows changed otherwise
+    quint64 rows = 0;
+    /// Time spent in sqlite stepping the statement
+    qint64 totalNsec = 0;
+    qint64 maxStepNsec = 0;
+
+    void addStepTime(qint64 nsec);
+};
+
 /**
  * @brief The SqlDatabase class
  * @ingroup libsync
@@ -163,6 +181,7 @@ private:
     QString _error;
     int _errId = 0;
     QByteArray _sql;
+    SqlQueryStatistics *_statistics = nullptr;
 
     friend class SqlDatabase;
     friend class PreparedSqlQueryManager;
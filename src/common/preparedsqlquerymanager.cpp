@@ -21,6 +21,8 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
+
 using namespace OCC;
 
 PreparedSqlQuery::PreparedSqlQuery(SqlQuery *query, bool ok)
@@ -34,23 +36,62 @@ PreparedSqlQuery::~PreparedSqlQuery()
     _query->reset_and_clear_bindings();
 }
 
+PreparedSqlQueryManager::~PreparedSqlQueryManager()
+{
+    qDeleteAll(_cachedQueries);
+}
+
 const PreparedSqlQuery PreparedSqlQueryManager::get(PreparedSqlQueryManager::Key key)
 {
     auto &query = _queries[key];
     ENFORCE(query._stmt)
     Q_ASSERT(!sqlite3_stmt_busy(query._stmt));
+    ++_statistics[key].reuses;
     return { &query };
 }
 
 const PreparedSqlQuery PreparedSqlQueryManager::get(PreparedSqlQueryManager::Key key, const QByteArray &sql, SqlDatabase &db)
 {
-    auto &query = _queries[key];
+    return prepareIfNeeded(_queries[key], _statistics[key], sql, db);
+}
+
+const PreparedSqlQuery PreparedSqlQueryManager::get(const QByteArray &sql, SqlDatabase &db)
+{
+    auto &cached = _cachedQueries[sql];
+    if (!cached) {
+        cached = new CachedQuery;
+    }
+    return prepareIfNeeded(cached->query, cached->statistics, sql, db);
+}
+
+const PreparedSqlQuery PreparedSqlQueryManager::prepareIfNeeded(SqlQuery &query, SqlQueryStatistics &statistics, const QByteArray &sql, SqlDatabase &db)
+{
     Q_ASSERT(!sqlite3_stmt_busy(query._stmt));
     ENFORCE(!query._sqldb || &db == query._sqldb)
+    query._statistics = &statistics;
     if (!query._stmt) {
         query._sqldb = &db;
         query._db = db.sqliteDb();
+        ++statistics.prepares;
         return { &query, query.prepare(sql) == 0 };
     }
+    ++statistics.reuses;
     return { &query };
 }
+
+QVector<PreparedSqlQueryManager::Statistics> PreparedSqlQueryManager::statistics() const
+{
+    QVector<Statistics> result;
+    for (int key = 0; key < PreparedQueryCount; ++key) {
+        if (_statistics[key].prepares > 0) {
+            result.append({ _queries[key].lastQuery(), _statistics[key] });
+        }
+    }
+    for (auto it = _cachedQueries.cbegin(); it != _cachedQueries.cend(); ++it) {
+        result.append({ it.key(), it.value()->statistics });
+    }
+    std::sort(result.begin(), result.end(), [](const Statistics &lhs, const Statistics &rhs) {
+        return lhs.counters.totalNsec > rhs.counters.totalNsec;
+    });
+    return result;
+}
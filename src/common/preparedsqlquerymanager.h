@@ -22,6 +22,9 @@
 #include "ownsql.h"
 #include "common/asserts.h"
 
+#include <QHash>
+#include <QVector>
+
 namespace OCC {
 
 class OCSYNC_EXPORT PreparedSqlQuery
@@ -63,6 +66,7 @@ public:
         GetFileRecordQueryByMangledName,
         GetFileRecordQueryByInode,
         GetFileRecordQueryByFileId,
+        GetFileRecordQueryBySize,
         GetFilesBelowPathQuery,
         GetAllFilesQuery,
         ListFilesInPathQuery,
@@ -97,10 +101,7 @@ public:
         DeleteCaseClashConflictRecordQuery,
         GetAllCaseClashConflictPathQuery,
         DeleteConflictRecordQuery,
-        GetRawPinStateQuery,
-        GetEffectivePinStateQuery,
-        GetSubPinsQuery,
-        CountDehydratedFilesQuery,
+        GetFileRecordTypeQuery,
         SetPinStateQuery,
         WipePinStateQuery,
         SetE2EeLockedFolderQuery,
@@ -108,10 +109,14 @@ public:
         GetE2EeLockedFoldersQuery,
         DeleteE2EeLockedFolderQuery,
         ListAllTopLevelE2eeFoldersStatusLessThanQuery,
+        GetE2eMetadataCacheQuery,
+        SetE2eMetadataCacheQuery,
+        DeleteE2eMetadataCacheQuery,
 
         PreparedQueryCount
     };
     PreparedSqlQueryManager() = default;
+    ~PreparedSqlQueryManager();
     /**
      * The queries are reset in the destructor to prevent wal locks
      */
@@ -120,9 +125,34 @@ public:
      * Prepare the SqlQuery if it was not prepared yet.
      */
     const PreparedSqlQuery get(Key key, const QByteArray &sql, SqlDatabase &db);
+    /**
+     * Like get(Key, const QByteArray &, SqlDatabase &) for statements without a Key.
+     *
+     * The statement is cached by its sql text, for queries that would
+     * otherwise be prepared on every call.
+     */
+    const PreparedSqlQuery get(const QByteArray &sql, SqlDatabase &db);
+
+    struct Statistics
+    {
+        QByteArray sql;
+        SqlQueryStatistics counters;
+    };
+    /// Counters of all statements that were used, most expensive first
+    [[nodiscard]] QVector<Statistics> statistics() const;
 
 private:
+    struct CachedQuery
+    {
+        SqlQuery query;
+        SqlQueryStatistics statistics;
+    };
+
+    const PreparedSqlQuery prepareIfNeeded(SqlQuery &query, SqlQueryStatistics &statistics, const QByteArray &sql, SqlDatabase &db);
+
     SqlQuery _queries[PreparedQueryCount];
+    SqlQueryStatistics _statistics[PreparedQueryCount];
+    QHash<QByteArray, CachedQuery *> _cachedQueries;
     Q_DISABLE_COPY(PreparedSqlQueryManager)
 };
 
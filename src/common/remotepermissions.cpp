@@ -17,23 +17,41 @@
  */
 
 #include "remotepermissions.h"
-#include <cstring>
+
+#include <array>
 
 namespace OCC {
 
-static const char letters[] = " WDNVCKRSMm";
+static constexpr char letters[] = " WDNVCKRSMm";
+
+// Bit of each permission letter, 0 for the characters that are not one
+static constexpr auto letterBits = [] {
+    std::array<quint16, 128> bits{};
+    for (int i = 1; letters[i]; ++i) {
+        bits[static_cast<unsigned char>(letters[i])] = 1 << i;
+    }
+    return bits;
+}();
 
+static uint charCode(char c)
+{
+    return static_cast<unsigned char>(c);
+}
+
+static uint charCode(QChar c)
+{
+    return c.unicode();
+}
 
 template <typename Char>
-void RemotePermissions::fromArray(const Char *p)
+void RemotePermissions::fromArray(const Char *begin, const Char *end)
 {
     _value = notNullMask;
-    if (!p)
-        return;
-    while (*p) {
-        if (auto res = std::strchr(letters, static_cast<char>(*p)))
-            _value |= (1 << (res - letters));
-        ++p;
+    for (auto p = begin; p != end; ++p) {
+        const auto c = charCode(*p);
+        if (c < letterBits.size()) {
+            _value |= letterBits[c];
+        }
     }
 }
 
@@ -64,14 +82,23 @@ RemotePermissions RemotePermissions::fromDbValue(const QByteArray &value)
     if (value.isEmpty())
         return {};
     RemotePermissions perm;
-    perm.fromArray(value.constData());
+    perm.fromArray(value.cbegin(), value.cend());
+    return perm;
+}
+
+RemotePermissions RemotePermissions::fromDbIntValue(qint64 value)
+{
+    RemotePermissions perm;
+    if (value & notNullMask) {
+        perm._value = static_cast<quint16>(value & ((2 << PermissionsCount) - 1));
+    }
     return perm;
 }
 
 RemotePermissions RemotePermissions::fromServerString(const QString &value)
 {
     RemotePermissions perm;
-    perm.fromArray(value.utf16());
+    perm.fromArray(value.cbegin(), value.cend());
     return perm;
 }
 
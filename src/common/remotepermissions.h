@@ -36,8 +36,8 @@ private:
     quint16 _value = 0;
     static constexpr int notNullMask = 0x1;
 
-    template <typename Char> // can be 'char' or 'ushort' if conversion from QString
-    void fromArray(const Char *p);
+    template <typename Char> // can be 'char' or 'QChar'
+    void fromArray(const Char *begin, const Char *end);
 
 public:
     enum Permissions {
@@ -71,6 +71,12 @@ public:
     /// read value that was written with toDbValue()
     static RemotePermissions fromDbValue(const QByteArray &);
 
+    /// the permission bits as stored in the journal, 0 is null
+    [[nodiscard]] int toDbIntValue() const { return _value; }
+
+    /// read value that was written with toDbIntValue()
+    static RemotePermissions fromDbIntValue(qint64 value);
+
     /// read a permissions string received from the server, never null
     static RemotePermissions fromServerString(const QString &);
 
@@ -47,7 +47,7 @@ namespace OCC {
 Q_LOGGING_CATEGORY(lcDb, "nextcloud.sync.database", QtInfoMsg)
 
 #define GET_FILE_RECORD_QUERY \
-        "SELECT path, inode, modtime, type, md5, fileid, remotePerm, filesize," \
+        "SELECT path, inode, modtime, type, md5, fileid, remotePermissions, filesize," \
         "  ignoredChildrenRemote, contentchecksumtype.name || ':' || contentChecksum, e2eMangledName, isE2eEncrypted, " \
         "  lock, lockOwnerDisplayName, lockOwnerId, lockType, lockOwnerEditor, lockTime, lockTimeout, isShared, lastShareStateFetchedTimestmap, sharedByMe" \
         " FROM metadata" \
@@ -61,7 +61,7 @@ static void fillFileRecordFromGetQuery(SyncJournalFileRecord &rec, SqlQuery &que
     rec._type = static_cast<ItemType>(query.intValue(3));
     rec._etag = query.baValue(4);
     rec._fileId = query.baValue(5);
-    rec._remotePerm = RemotePermissions::fromDbValue(query.baValue(6));
+    rec._remotePerm = RemotePermissions::fromDbIntValue(query.int64Value(6));
     rec._fileSize = query.int64Value(7);
     rec._serverHasIgnoredFiles = (query.intValue(8) > 0);
     rec._checksumHeader = query.baValue(9);
@@ -257,6 +257,34 @@ void SyncJournalDb::walCheckpoint()
     }
 }
 
+QVector<PreparedSqlQueryManager::Statistics> SyncJournalDb::queryStatistics()
+{
+    QMutexLocker locker(&_mutex);
+    return _queryManager.statistics();
+}
+
+QString SyncJournalDb::queryStatisticsSummary(int maxStatements)
+{
+    const auto statistics = queryStatistics();
+    QStringList lines;
+    for (const auto &statement : statistics.mid(0, maxStatements)) {
+        const auto &counters = statement.counters;
+        auto sql = QString::fromUtf8(statement.sql).simplified();
+        if (sql.size() > 120) {
+            sql = sql.left(117) + QStringLiteral("...");
+        }
+        lines.append(QStringLiteral("%1 ms (max step %2 ms), %3 executions, %4 rows, %5 prepares, %6 reuses: %7")
+                         .arg(counters.totalNsec / 1000000)
+                         .arg(counters.maxStepNsec / 1000000)
+                         .arg(counters.executions)
+                         .arg(counters.rows)
+                         .arg(counters.prepares)
+                         .arg(counters.reuses)
+                         .arg(sql));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
 void SyncJournalDb::startTransaction()
 {
     if (_transaction == 0) {
@@ -288,6 +316,10 @@ bool SyncJournalDb::sqlFail(const QString &log, const SqlQuery &query)
     commitTransaction();
     qCWarning(lcDb) << "SQL Error" << log << query.error();
     _db.close();
+    dropErrorBlacklist();
+    dropHydrationSummaries();
+    _pinStates.clear();
+    _pinStatesLoaded = false;
     ASSERT(false);
     return false;
 }
@@ -412,6 +444,7 @@ bool SyncJournalDb::checkConnect()
                         // updateDatabaseStructure() will add
                         // fileid
                         // remotePerm
+                        // remotePermissions
                         // filesize
                         // ignoredChildrenRemote
                         // contentChecksum
@@ -576,6 +609,17 @@ bool SyncJournalDb::checkConnect()
         return sqlFail(QStringLiteral("Create table e2EeLockedFolders"), createQuery);
     }
 
+    // create the e2eMetadataCache table.
+    createQuery.prepare(
+        "CREATE TABLE IF NOT EXISTS e2eMetadataCache("
+        "folderId VARCHAR(128) PRIMARY KEY,"
+        "etag VARCHAR(128),"
+        "data BLOB"
+        ");");
+    if (!createQuery.exec()) {
+        return sqlFail(QStringLiteral("Create table e2eMetadataCache"), createQuery);
+    }
+
     bool forceRemoteDiscovery = false;
 
     SqlQuery versionQuery("SELECT major, minor, patch FROM version;", _db);
@@ -693,6 +737,10 @@ void SyncJournalDb::close()
     _db.close();
     clearEtagStorageFilter();
     _metadataTableIsEmpty = false;
+    dropErrorBlacklist();
+    dropHydrationSummaries();
+    _pinStates.clear();
+    _pinStatesLoaded = false;
 }
 
 
@@ -816,6 +864,16 @@ bool SyncJournalDb::updateMetadataTableStructure()
         commitInternal(QStringLiteral("update database structure: add e2eMangledName index"));
     }
 
+    if (true) {
+        SqlQuery query(_db);
+        query.prepare("CREATE INDEX IF NOT EXISTS metadata_filesize ON metadata(filesize);");
+        if (!query.exec()) {
+            sqlFail(QStringLiteral("updateMetadataTableStructure: create index filesize"), query);
+            re = false;
+        }
+        commitInternal(QStringLiteral("update database structure: add filesize index"));
+    }
+
     addColumn(QStringLiteral("lock"), QStringLiteral("INTEGER"));
     addColumn(QStringLiteral("lockType"), QStringLiteral("INTEGER"));
     addColumn(QStringLiteral("lockOwnerDisplayName"), QStringLiteral("TEXT"));
@@ -824,6 +882,23 @@ bool SyncJournalDb::updateMetadataTableStructure()
     addColumn(QStringLiteral("lockTime"), QStringLiteral("INTEGER"));
     addColumn(QStringLiteral("lockTimeout"), QStringLiteral("INTEGER"));
 
+    // The permissions used to be stored as letters in remotePerm, see RemotePermissions::toDbValue()
+    addColumn(QStringLiteral("remotePermissions"), QStringLiteral("INTEGER"));
+    {
+        // Also converts the rows an older client wrote after a downgrade, it leaves remotePermissions NULL
+        SqlQuery query(_db);
+        query.prepare("UPDATE metadata SET remotePermissions = CASE WHEN remotePerm IS NULL OR remotePerm == '' THEN 0 ELSE 1"
+                      " | ((instr(remotePerm, 'W') > 0) << 1) | ((instr(remotePerm, 'D') > 0) << 2) | ((instr(remotePerm, 'N') > 0) << 3)"
+                      " | ((instr(remotePerm, 'V') > 0) << 4) | ((instr(remotePerm, 'C') > 0) << 5) | ((instr(remotePerm, 'K') > 0) << 6)"
+                      " | ((instr(remotePerm, 'R') > 0) << 7) | ((instr(remotePerm, 'S') > 0) << 8) | ((instr(remotePerm, 'M') > 0) << 9)"
+                      " | ((instr(remotePerm, 'm') > 0) << 10) END WHERE remotePermissions IS NULL;");
+        if (!query.exec()) {
+            sqlFail(QStringLiteral("updateMetadataTableStructure: convert remotePerm"), query);
+            re = false;
+        }
+        commitInternal(QStringLiteral("update database structure: convert remotePerm"));
+    }
+
     SqlQuery query(_db);
     query.prepare("CREATE INDEX IF NOT EXISTS caseconflicts_basePath ON caseconflicts(basePath);");
     if (!query.exec()) {
@@ -976,21 +1051,28 @@ Result<void, QString> SyncJournalDb::setFileRecord(const SyncJournalFileRecord &
     if (fileId.isEmpty()) {
         fileId = "";
     }
-    QByteArray remotePerm = record._remotePerm.toDbValue();
     QByteArray checksumType, checksum;
     parseChecksumHeader(record._checksumHeader, &checksumType, &checksum);
     int contentChecksumTypeId = mapChecksumType(checksumType);
 
     const auto query = _queryManager.get(PreparedSqlQueryManager::SetFileRecordQuery, QByteArrayLiteral("INSERT OR REPLACE INTO metadata "
-                                                                                                        "(phash, pathlen, path, inode, uid, gid, mode, modtime, type, md5, fileid, remotePerm, filesize, ignoredChildrenRemote, "
+                                                                                                        "(phash, pathlen, path, inode, uid, gid, mode, modtime, type, md5, fileid, remotePermissions, filesize, ignoredChildrenRemote, "
                                                                                                         "contentChecksum, contentChecksumTypeId, e2eMangledName, isE2eEncrypted, lock, lockType, lockOwnerDisplayName, lockOwnerId, "
-                                                                                                        "lockOwnerEditor, lockTime, lockTimeout, isShared, lastShareStateFetchedTimestmap, sharedByMe) "
-                                                                                                        "VALUES (?1 , ?2, ?3 , ?4 , ?5 , ?6 , ?7,  ?8 , ?9 , ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22, ?23, ?24, ?25, ?26, ?27, ?28);"),
+                                                                                                        "lockOwnerEditor, lockTime, lockTimeout, isShared, lastShareStateFetchedTimestmap, sharedByMe, remotePerm) "
+                                                                                                        "VALUES (?1 , ?2, ?3 , ?4 , ?5 , ?6 , ?7,  ?8 , ?9 , ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22, ?23, ?24, ?25, ?26, ?27, ?28, ?29);"),
         _db);
     if (!query) {
         return query->error();
     }
 
+    Optional<ItemType> previousType;
+    if (_hydrationSummariesLoaded) {
+        previousType = previousRecordType(record._path);
+        if (!previousType) {
+            dropHydrationSummaries();
+        }
+    }
+
     query->bindValue(1, phash);
     query->bindValue(2, plen);
     query->bindValue(3, record._path);
@@ -1002,7 +1084,7 @@ Result<void, QString> SyncJournalDb::setFileRecord(const SyncJournalFileRecord &
     query->bindValue(9, record._type);
     query->bindValue(10, etag);
     query->bindValue(11, fileId);
-    query->bindValue(12, remotePerm);
+    query->bindValue(12, record._remotePerm.toDbIntValue());
     query->bindValue(13, record._fileSize);
     query->bindValue(14, record._serverHasIgnoredFiles ? 1 : 0);
     query->bindValue(15, checksum);
@@ -1019,11 +1101,19 @@ Result<void, QString> SyncJournalDb::setFileRecord(const SyncJournalFileRecord &
     query->bindValue(26, record._isShared);
     query->bindValue(27, record._lastShareStateFetchedTimestamp);
     query->bindValue(28, record._sharedByMe);
+    // Still written for the clients that only know the letters
+    query->bindValue(29, record._remotePerm.toDbValue());
 
     if (!query->exec()) {
         return query->error();
     }
 
+    if (_hydrationSummariesLoaded) {
+        updateHydrationSummaries(record._path, *previousType, -1);
+        updateHydrationSummaries(record._path, record._type, 1);
+        rememberRecordType(record._path, record._type);
+    }
+
     // Can't be true anymore.
     _metadataTableIsEmpty = false;
 
@@ -1194,6 +1284,7 @@ bool SyncJournalDb::deleteFileRecord(const QString &filename, bool recursively)
     if (checkConnect()) {
         // if (!recursively) {
         // always delete the actual file.
+        const auto path = filename.toUtf8();
 
         {
             const auto query = _queryManager.get(PreparedSqlQueryManager::DeleteFileRecordPhash, QByteArrayLiteral("DELETE FROM metadata WHERE phash=?1"), _db);
@@ -1201,12 +1292,26 @@ bool SyncJournalDb::deleteFileRecord(const QString &filename, bool recursively)
                 return false;
             }
 
-            const qint64 phash = getPHash(filename.toUtf8());
+            Optional<ItemType> type;
+            if (_hydrationSummariesLoaded) {
+                type = previousRecordType(path);
+                if (!type) {
+                    dropHydrationSummaries();
+                }
+            }
+
+            const qint64 phash = getPHash(path);
             query->bindValue(1, phash);
 
             if (!query->exec()) {
+                dropHydrationSummaries();
                 return false;
             }
+
+            if (_hydrationSummariesLoaded) {
+                updateHydrationSummaries(path, *type, -1);
+                rememberRecordType(path, ItemTypeSkip);
+            }
         }
 
         if (recursively) {
@@ -1215,8 +1320,26 @@ bool SyncJournalDb::deleteFileRecord(const QString &filename, bool recursively)
                 return false;
             query->bindValue(1, filename);
             if (!query->exec()) {
+                dropHydrationSummaries();
                 return false;
             }
+
+            if (_hydrationSummariesLoaded && path.isEmpty()) {
+                dropHydrationSummaries();
+            } else if (_hydrationSummariesLoaded) {
+                _lastRecordTypeKnown = _lastRecordTypeKnown && !_lastRecordPath.startsWith(path + '/');
+                // Everything below path is gone: take its counts off the parents
+                const auto below = _hydrationSummaries.take(path);
+                updateHydrationSummaries(path, -below.hydrated, -below.dehydrated);
+                const auto prefix = path + '/';
+                for (auto it = _hydrationSummaries.begin(); it != _hydrationSummaries.end();) {
+                    if (it.key().startsWith(prefix)) {
+                        it = _hydrationSummaries.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
         }
         return true;
     } else {
@@ -1264,6 +1387,9 @@ bool SyncJournalDb::getFileRecord(const QByteArray &filename, SyncJournalFileRec
         if (next.hasData) {
             fillFileRecordFromGetQuery(*rec, *query);
         }
+        if (_hydrationSummariesLoaded) {
+            rememberRecordType(filename, next.hasData ? rec->_type : ItemTypeSkip);
+        }
     }
     return true;
 }
@@ -1379,6 +1505,44 @@ bool SyncJournalDb::getFileRecordsByFileId(const QByteArray &fileId, const std::
     return true;
 }
 
+bool SyncJournalDb::getFileRecordsBySize(qint64 size, int maxCount, const std::function<void(const SyncJournalFileRecord &)> &rowCallback)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (size <= 0 || maxCount <= 0 || _metadataTableIsEmpty)
+        return true; // no error, yet nothing found
+
+    if (!checkConnect())
+        return false;
+
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetFileRecordQueryBySize,
+        QByteArrayLiteral(GET_FILE_RECORD_QUERY " WHERE filesize=?1 AND type=?2 AND contentChecksum IS NOT NULL LIMIT ?3"), _db);
+    if (!query) {
+        return false;
+    }
+
+    query->bindValue(1, size);
+    query->bindValue(2, ItemTypeFile);
+    query->bindValue(3, maxCount);
+
+    if (!query->exec())
+        return false;
+
+    forever {
+        auto next = query->next();
+        if (!next.ok)
+            return false;
+        if (!next.hasData)
+            break;
+
+        SyncJournalFileRecord rec;
+        fillFileRecordFromGetQuery(rec, *query);
+        rowCallback(rec);
+    }
+
+    return true;
+}
+
 bool SyncJournalDb::getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback)
 {
     QMutexLocker locker(&_mutex);
@@ -1478,6 +1642,48 @@ bool SyncJournalDb::listFilesInPath(const QByteArray& path,
     return true;
 }
 
+bool SyncJournalDb::getSubtreeRecordCounts(const QByteArray &path, QMap<QByteArray, SubtreeRecordCount> *counts)
+{
+    QMutexLocker locker(&_mutex);
+
+    counts->clear();
+    if (_metadataTableIsEmpty)
+        return true;
+
+    if (!checkConnect())
+        return false;
+
+    // Only the paths are read, the records of a whole subtree can be many
+    const auto preparedQuery = path.isEmpty()
+        ? _queryManager.get(QByteArrayLiteral("SELECT path, type FROM metadata"), _db)
+        : _queryManager.get(QByteArrayLiteral("SELECT path, type FROM metadata WHERE " IS_PREFIX_PATH_OF("?1", "path")), _db);
+    if (!preparedQuery)
+        return false;
+    auto &query = *preparedQuery;
+    if (!path.isEmpty())
+        query.bindValue(1, path);
+    if (!query.exec())
+        return false;
+
+    const auto childStart = path.isEmpty() ? 0 : path.size() + 1;
+    forever {
+        auto next = query.next();
+        if (!next.ok)
+            return false;
+        if (!next.hasData)
+            break;
+
+        const auto recordPath = query.baValue(0);
+        const auto childEnd = recordPath.indexOf('/', childStart);
+        auto &count = (*counts)[childEnd < 0 ? recordPath : recordPath.left(childEnd)];
+        ++count._records;
+        if (childEnd >= 0 || static_cast<ItemType>(query.intValue(1)) == ItemTypeDirectory) {
+            count._isDirectory = true;
+        }
+    }
+    return true;
+}
+
 int SyncJournalDb::getFileRecordCount()
 {
     QMutexLocker locker(&_mutex);
@@ -1570,32 +1776,121 @@ Optional<SyncJournalDb::HasHydratedDehydrated> SyncJournalDb::hasHydratedOrDehyd
     if (!checkConnect())
         return {};
 
-    const auto query = _queryManager.get(PreparedSqlQueryManager::CountDehydratedFilesQuery, QByteArrayLiteral("SELECT DISTINCT type FROM metadata"
-                                                                                                               " WHERE (" IS_PREFIX_PATH_OR_EQUAL("?1", "path") " OR ?1 == '');"),
-        _db);
-    if (!query) {
+    if (!_hydrationSummariesLoaded && !loadHydrationSummaries())
         return {};
+
+    HasHydratedDehydrated result;
+    const auto summary = _hydrationSummaries.constFind(filename);
+    if (summary != _hydrationSummaries.cend()) {
+        result.hasHydrated = summary->hydrated > 0;
+        result.hasDehydrated = summary->dehydrated > 0;
+        return result;
     }
 
-    query->bindValue(1, filename);
-    if (!query->exec())
+    // A file, a folder without files below it or no item at all
+    const auto type = fileRecordType(filename);
+    if (!type)
         return {};
+    if (*type == ItemTypeFile || *type == ItemTypeVirtualFileDehydration)
+        result.hasHydrated = true;
+    if (*type == ItemTypeVirtualFile || *type == ItemTypeVirtualFileDownload)
+        result.hasDehydrated = true;
+    return result;
+}
 
-    HasHydratedDehydrated result;
+bool SyncJournalDb::loadHydrationSummaries()
+{
+    static_assert(ItemTypeFile == 0 && ItemTypeVirtualFile == 4 && ItemTypeVirtualFileDownload == 5 && ItemTypeVirtualFileDehydration == 6, "");
+    SqlQuery query(_db);
+    query.prepare("SELECT path, type FROM metadata WHERE type IN (0, 4, 5, 6);");
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Could not load the hydration summaries" << query.error();
+        return false;
+    }
+
+    _hydrationSummaries.clear();
     forever {
-        auto next = query->next();
-        if (!next.ok)
-            return {};
+        auto next = query.next();
+        if (!next.ok) {
+            _hydrationSummaries.clear();
+            return false;
+        }
         if (!next.hasData)
             break;
-        auto type = static_cast<ItemType>(query->intValue(0));
-        if (type == ItemTypeFile || type == ItemTypeVirtualFileDehydration)
-            result.hasHydrated = true;
-        if (type == ItemTypeVirtualFile || type == ItemTypeVirtualFileDownload)
-            result.hasDehydrated = true;
+        updateHydrationSummaries(query.baValue(0), static_cast<ItemType>(query.intValue(1)), 1);
     }
+    _hydrationSummariesLoaded = true;
+    qCDebug(lcDb) << "Loaded the hydration summaries of" << _hydrationSummaries.size() << "folders";
+    return true;
+}
 
-    return result;
+void SyncJournalDb::dropHydrationSummaries()
+{
+    _hydrationSummaries.clear();
+    _hydrationSummariesLoaded = false;
+    _lastRecordTypeKnown = false;
+}
+
+void SyncJournalDb::updateHydrationSummaries(const QByteArray &path, qint64 hydratedDelta, qint64 dehydratedDelta)
+{
+    if (hydratedDelta == 0 && dehydratedDelta == 0)
+        return;
+
+    auto parent = path;
+    while (!parent.isEmpty()) {
+        const auto slashPosition = parent.lastIndexOf('/');
+        parent = slashPosition < 0 ? QByteArray("") : parent.left(slashPosition);
+
+        auto &summary = _hydrationSummaries[parent];
+        summary.hydrated += hydratedDelta;
+        summary.dehydrated += dehydratedDelta;
+        if (summary.hydrated <= 0 && summary.dehydrated <= 0) {
+            _hydrationSummaries.remove(parent);
+        }
+    }
+}
+
+void SyncJournalDb::updateHydrationSummaries(const QByteArray &path, ItemType type, qint64 delta)
+{
+    if (type == ItemTypeFile || type == ItemTypeVirtualFileDehydration) {
+        updateHydrationSummaries(path, delta, 0);
+    } else if (type == ItemTypeVirtualFile || type == ItemTypeVirtualFileDownload) {
+        updateHydrationSummaries(path, 0, delta);
+    }
+}
+
+Optional<ItemType> SyncJournalDb::fileRecordType(const QByteArray &path)
+{
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetFileRecordTypeQuery, QByteArrayLiteral("SELECT type FROM metadata WHERE phash=?1;"), _db);
+    if (!query) {
+        return {};
+    }
+
+    query->bindValue(1, getPHash(path));
+    if (!query->exec())
+        return {};
+
+    auto next = query->next();
+    if (!next.ok)
+        return {};
+    if (!next.hasData)
+        return ItemTypeSkip;
+    return static_cast<ItemType>(query->intValue(0));
+}
+
+Optional<ItemType> SyncJournalDb::previousRecordType(const QByteArray &path)
+{
+    if (_lastRecordTypeKnown && _lastRecordPath == path) {
+        return _lastRecordType;
+    }
+    return fileRecordType(path);
+}
+
+void SyncJournalDb::rememberRecordType(const QByteArray &path, ItemType type)
+{
+    _lastRecordPath = path;
+    _lastRecordType = type;
+    _lastRecordTypeKnown = true;
 }
 
 static void toDownloadInfo(SqlQuery &query, SyncJournalDb::DownloadInfo *res)
@@ -1848,6 +2143,14 @@ SyncJournalErrorBlacklistRecord SyncJournalDb::errorBlacklistEntry(const QString
         return entry;
 
     if (checkConnect()) {
+        if (_errorBlacklistLoaded || loadErrorBlacklist()) {
+            if (const auto cached = cachedErrorBlacklistEntry(file)) {
+                entry = *cached;
+                entry._file = file;
+            }
+            return entry;
+        }
+
         const auto query = _queryManager.get(PreparedSqlQueryManager::GetErrorBlacklistQuery);
         query->bindValue(1, file);
         if (query->exec()) {
@@ -1878,6 +2181,38 @@ bool SyncJournalDb::deleteStaleErrorBlacklistEntries(const QSet<QString> &keep)
         return false;
     }
 
+    if (_errorBlacklistLoaded || loadErrorBlacklist()) {
+        QStringList superfluousPaths;
+        for (const auto &entry : qAsConst(_errorBlacklist)) {
+            if (!keep.contains(entry._file)) {
+                superfluousPaths.append(entry._file);
+            }
+        }
+        if (superfluousPaths.isEmpty()) {
+            return true;
+        }
+
+        qCDebug(lcDb) << "Removing" << superfluousPaths.size() << "stale blacklist entries";
+        auto ok = true;
+        if (superfluousPaths.size() == _errorBlacklist.size()) {
+            SqlQuery delQuery("DELETE FROM blacklist", _db);
+            ok = delQuery.exec();
+        } else {
+            SqlQuery delQuery(_db);
+            delQuery.prepare("DELETE FROM blacklist WHERE path = ?");
+            ok = deleteBatch(delQuery, superfluousPaths, QStringLiteral("blacklist"));
+        }
+        if (ok) {
+            for (const auto &path : qAsConst(superfluousPaths)) {
+                uncacheErrorBlacklistEntry(path);
+            }
+        } else {
+            // Reloaded from the database by the next lookup
+            dropErrorBlacklist();
+        }
+        return ok;
+    }
+
     SqlQuery query(_db);
     query.prepare("SELECT path FROM blacklist");
 
@@ -1909,6 +2244,8 @@ void SyncJournalDb::deleteStaleFlagsEntries()
     if (!delQuery.exec()) {
         sqlFail(QStringLiteral("deleteStaleFlagsEntries"), delQuery);
     }
+    _pinStates.clear();
+    _pinStatesLoaded = false;
 }
 
 int SyncJournalDb::errorBlackListEntryCount()
@@ -1941,6 +2278,8 @@ int SyncJournalDb::wipeErrorBlacklist()
             sqlFail(QStringLiteral("Deletion of whole blacklist failed"), query);
             return -1;
         }
+        _errorBlacklist.clear();
+        _errorBlacklistPaths.clear();
         return query.numRowsAffected();
     }
     return -1;
@@ -1954,13 +2293,16 @@ void SyncJournalDb::wipeErrorBlacklistEntry(const QString &file)
 
     QMutexLocker locker(&_mutex);
     if (checkConnect()) {
-        SqlQuery query(_db);
-
-        query.prepare("DELETE FROM blacklist WHERE path=?1");
-        query.bindValue(1, file);
-        if (!query.exec()) {
-            sqlFail(QStringLiteral("Deletion of blacklist item failed."), query);
+        const auto query = _queryManager.get(QByteArrayLiteral("DELETE FROM blacklist WHERE path=?1"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, file);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("Deletion of blacklist item failed."), *query);
+            return;
         }
+        uncacheErrorBlacklistEntry(file);
     }
 }
 
@@ -1968,12 +2310,22 @@ void SyncJournalDb::wipeErrorBlacklistCategory(SyncJournalErrorBlacklistRecord::
 {
     QMutexLocker locker(&_mutex);
     if (checkConnect()) {
-        SqlQuery query(_db);
-
-        query.prepare("DELETE FROM blacklist WHERE errorCategory=?1");
-        query.bindValue(1, category);
-        if (!query.exec()) {
-            sqlFail(QStringLiteral("Deletion of blacklist category failed."), query);
+        const auto query = _queryManager.get(QByteArrayLiteral("DELETE FROM blacklist WHERE errorCategory=?1"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, category);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("Deletion of blacklist category failed."), *query);
+            return;
+        }
+        for (auto it = _errorBlacklist.begin(); it != _errorBlacklist.end();) {
+            if (it->_errorCategory == category) {
+                _errorBlacklistPaths.remove(errorBlacklistKey(it.key()), it.key());
+                it = _errorBlacklist.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 }
@@ -2009,7 +2361,97 @@ void SyncJournalDb::setErrorBlacklistEntry(const SyncJournalErrorBlacklistRecord
     query->bindValue(8, item._renameTarget);
     query->bindValue(9, item._errorCategory);
     query->bindValue(10, item._requestId);
-    query->exec();
+    if (query->exec() && _errorBlacklistLoaded) {
+        cacheErrorBlacklistEntry(item);
+    }
+}
+
+bool SyncJournalDb::loadErrorBlacklist()
+{
+    SqlQuery query(_db);
+    query.prepare("SELECT path, lastTryEtag, lastTryModtime, retrycount, errorstring, lastTryTime, ignoreDuration, renameTarget, errorCategory, requestId "
+                  "FROM blacklist");
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Could not load the error blacklist" << query.error();
+        return false;
+    }
+
+    _errorBlacklist.clear();
+    _errorBlacklistPaths.clear();
+    while (query.next().hasData) {
+        SyncJournalErrorBlacklistRecord entry;
+        entry._file = query.stringValue(0);
+        entry._lastTryEtag = query.baValue(1);
+        entry._lastTryModtime = query.int64Value(2);
+        entry._retryCount = query.intValue(3);
+        entry._errorString = query.stringValue(4);
+        entry._lastTryTime = query.int64Value(5);
+        entry._ignoreDuration = query.int64Value(6);
+        entry._renameTarget = query.stringValue(7);
+        entry._errorCategory = static_cast<SyncJournalErrorBlacklistRecord::Category>(query.intValue(8));
+        entry._requestId = query.baValue(9);
+        cacheErrorBlacklistEntry(entry);
+    }
+    _errorBlacklistLoaded = true;
+    qCDebug(lcDb) << "Loaded" << _errorBlacklist.size() << "error blacklist entries";
+    return true;
+}
+
+QString SyncJournalDb::errorBlacklistKey(const QString &file) const
+{
+    if (!Utility::fsCasePreserving()) {
+        return file;
+    }
+    // Same folding as the COLLATE NOCASE of GetErrorBlacklistQuery: ASCII letters only
+    auto key = file;
+    for (auto &c : key) {
+        const auto unicode = c.unicode();
+        if (unicode >= 'A' && unicode <= 'Z') {
+            c = QChar(unicode + ('a' - 'A'));
+        }
+    }
+    return key;
+}
+
+const SyncJournalErrorBlacklistRecord *SyncJournalDb::cachedErrorBlacklistEntry(const QString &file) const
+{
+    auto it = _errorBlacklist.constFind(file);
+    if (it == _errorBlacklist.constEnd()) {
+        const auto pathIt = _errorBlacklistPaths.constFind(errorBlacklistKey(file));
+        if (pathIt == _errorBlacklistPaths.constEnd()) {
+            return nullptr;
+        }
+        it = _errorBlacklist.constFind(pathIt.value());
+    }
+    return it != _errorBlacklist.constEnd() ? &it.value() : nullptr;
+}
+
+void SyncJournalDb::cacheErrorBlacklistEntry(const SyncJournalErrorBlacklistRecord &entry)
+{
+    if (!_errorBlacklist.contains(entry._file)) {
+        _errorBlacklistPaths.insert(errorBlacklistKey(entry._file), entry._file);
+    }
+    _errorBlacklist.insert(entry._file, entry);
+}
+
+void SyncJournalDb::uncacheErrorBlacklistEntry(const QString &file)
+{
+    if (_errorBlacklist.remove(file)) {
+        _errorBlacklistPaths.remove(errorBlacklistKey(file), file);
+    }
+}
+
+void SyncJournalDb::reloadErrorBlacklistOnNextUse()
+{
+    QMutexLocker locker(&_mutex);
+    dropErrorBlacklist();
+}
+
+void SyncJournalDb::dropErrorBlacklist()
+{
+    _errorBlacklist.clear();
+    _errorBlacklistPaths.clear();
+    _errorBlacklistLoaded = false;
 }
 
 QVector<SyncJournalDb::PollInfo> SyncJournalDb::getPollInfos()
@@ -2047,19 +2489,25 @@ void SyncJournalDb::setPollInfo(const SyncJournalDb::PollInfo &info)
 
     if (info._url.isEmpty()) {
         qCDebug(lcDb) << "Deleting Poll job" << info._file;
-        SqlQuery query("DELETE FROM async_poll WHERE path=?", _db);
-        query.bindValue(1, info._file);
-        if (!query.exec()) {
-            sqlFail(QStringLiteral("setPollInfo DELETE FROM async_poll"), query);
+        const auto query = _queryManager.get(QByteArrayLiteral("DELETE FROM async_poll WHERE path=?"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, info._file);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("setPollInfo DELETE FROM async_poll"), *query);
         }
     } else {
-        SqlQuery query("INSERT OR REPLACE INTO async_poll (path, modtime, filesize, pollpath) VALUES( ? , ? , ? , ? )", _db);
-        query.bindValue(1, info._file);
-        query.bindValue(2, info._modtime);
-        query.bindValue(3, info._fileSize);
-        query.bindValue(4, info._url);
-        if (!query.exec()) {
-            sqlFail(QStringLiteral("setPollInfo INSERT OR REPLACE INTO async_poll"), query);
+        const auto query = _queryManager.get(QByteArrayLiteral("INSERT OR REPLACE INTO async_poll (path, modtime, filesize, pollpath) VALUES( ? , ? , ? , ? )"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, info._file);
+        query->bindValue(2, info._modtime);
+        query->bindValue(3, info._fileSize);
+        query->bindValue(4, info._url);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("setPollInfo INSERT OR REPLACE INTO async_poll"), *query);
         }
     }
 }
@@ -2140,12 +2588,16 @@ void SyncJournalDb::avoidRenamesOnNextSync(const QByteArray &path)
         return;
     }
 
-    SqlQuery query(_db);
-    query.prepare("UPDATE metadata SET fileid = '', inode = '0' WHERE " IS_PREFIX_PATH_OR_EQUAL("?1", "path"));
-    query.bindValue(1, path);
+    {
+        const auto query = _queryManager.get(QByteArrayLiteral("UPDATE metadata SET fileid = '', inode = '0' WHERE " IS_PREFIX_PATH_OR_EQUAL("?1", "path")), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, path);
 
-    if (!query.exec()) {
-        sqlFail(QStringLiteral("avoidRenamesOnNextSync path: %1").arg(QString::fromUtf8(path)), query);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("avoidRenamesOnNextSync path: %1").arg(QString::fromUtf8(path)), *query);
+        }
     }
 
     // We also need to remove the ETags so the update phase refreshes the directory paths
@@ -2166,14 +2618,18 @@ void SyncJournalDb::schedulePathForRemoteDiscovery(const QByteArray &fileName)
     if (argument.endsWith('/'))
         argument.chop(1);
 
-    SqlQuery query(_db);
-    // This query will match entries for which the path is a prefix of fileName
-    // Note: CSYNC_FTW_TYPE_DIR == 2
-    query.prepare("UPDATE metadata SET md5='_invalid_' WHERE " IS_PREFIX_PATH_OR_EQUAL("path", "?1") " AND type == 2;");
-    query.bindValue(1, argument);
+    {
+        // This query will match entries for which the path is a prefix of fileName
+        // Note: CSYNC_FTW_TYPE_DIR == 2
+        const auto query = _queryManager.get(QByteArrayLiteral("UPDATE metadata SET md5='_invalid_' WHERE " IS_PREFIX_PATH_OR_EQUAL("path", "?1") " AND type == 2;"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, argument);
 
-    if (!query.exec()) {
-        sqlFail(QStringLiteral("schedulePathForRemoteDiscovery path: %1").arg(QString::fromUtf8(fileName)), query);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("schedulePathForRemoteDiscovery path: %1").arg(QString::fromUtf8(fileName)), *query);
+        }
     }
 
     // Prevent future overwrite of the etags of this folder and all
@@ -2201,11 +2657,13 @@ void SyncJournalDb::forceRemoteDiscoveryNextSync()
 void SyncJournalDb::forceRemoteDiscoveryNextSyncLocked()
 {
     qCInfo(lcDb) << "Forcing remote re-discovery by deleting folder Etags";
-    SqlQuery deleteRemoteFolderEtagsQuery(_db);
-    deleteRemoteFolderEtagsQuery.prepare("UPDATE metadata SET md5='_invalid_' WHERE type=2;");
+    const auto deleteRemoteFolderEtagsQuery = _queryManager.get(QByteArrayLiteral("UPDATE metadata SET md5='_invalid_' WHERE type=2;"), _db);
+    if (!deleteRemoteFolderEtagsQuery) {
+        return;
+    }
 
-    if (!deleteRemoteFolderEtagsQuery.exec()) {
-        sqlFail(QStringLiteral("forceRemoteDiscoveryNextSyncLocked"), deleteRemoteFolderEtagsQuery);
+    if (!deleteRemoteFolderEtagsQuery->exec()) {
+        sqlFail(QStringLiteral("forceRemoteDiscoveryNextSyncLocked"), *deleteRemoteFolderEtagsQuery);
     }
 }
 
@@ -2455,6 +2913,31 @@ QByteArrayList SyncJournalDb::caseClashConflictRecordPaths()
     return paths;
 }
 
+QVector<ConflictRecord> SyncJournalDb::caseClashConflictRecords()
+{
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return {};
+    }
+
+    const auto query = _queryManager.get(QByteArrayLiteral("SELECT path, baseFileId, baseModtime, baseEtag, basePath FROM caseconflicts;"), _db);
+    ASSERT(query)
+    ASSERT(query->exec())
+
+    QVector<ConflictRecord> records;
+    while (query->next().hasData) {
+        ConflictRecord entry;
+        entry.path = query->baValue(0);
+        entry.baseFileId = query->baValue(1);
+        entry.baseModtime = query->int64Value(2);
+        entry.baseEtag = query->baValue(3);
+        entry.initialBasePath = query->baValue(4);
+        records.append(entry);
+    }
+
+    return records;
+}
+
 void SyncJournalDb::deleteConflictRecord(const QByteArray &path)
 {
     QMutexLocker locker(&_mutex);
@@ -2512,6 +2995,7 @@ void SyncJournalDb::clearFileTable()
     if (!query.exec()) {
         sqlFail(QStringLiteral("clearFileTable"), query);
     }
+    dropHydrationSummaries();
 }
 
 void SyncJournalDb::markVirtualFileForDownloadRecursively(const QByteArray &path)
@@ -2521,24 +3005,34 @@ void SyncJournalDb::markVirtualFileForDownloadRecursively(const QByteArray &path
         return;
 
     static_assert(ItemTypeVirtualFile == 4 && ItemTypeVirtualFileDownload == 5, "");
-    SqlQuery query("UPDATE metadata SET type=5 WHERE "
-                   "(" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '') "
-                   "AND type=4;", _db);
-    query.bindValue(1, path);
+    _lastRecordTypeKnown = false;
+    {
+        const auto query = _queryManager.get(QByteArrayLiteral("UPDATE metadata SET type=5 WHERE "
+                                                               "(" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '') "
+                                                               "AND type=4;"), _db);
+        if (!query) {
+            return;
+        }
+        query->bindValue(1, path);
 
-    if (!query.exec()) {
-        sqlFail(QStringLiteral("markVirtualFileForDownloadRecursively UPDATE metadata SET type=5 path: %1").arg(QString::fromUtf8(path)), query);
+        if (!query->exec()) {
+            sqlFail(QStringLiteral("markVirtualFileForDownloadRecursively UPDATE metadata SET type=5 path: %1").arg(QString::fromUtf8(path)), *query);
+            return;
+        }
     }
 
     // We also must make sure we do not read the files from the database (same logic as in schedulePathForRemoteDiscovery)
     // This includes all the parents up to the root, but also all the directory within the selected dir.
     static_assert(ItemTypeDirectory == 2, "");
-    query.prepare("UPDATE metadata SET md5='_invalid_' WHERE "
-                  "(" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '' OR " IS_PREFIX_PATH_OR_EQUAL("path", "?1") ") AND type == 2;");
-    query.bindValue(1, path);
+    const auto query = _queryManager.get(QByteArrayLiteral("UPDATE metadata SET md5='_invalid_' WHERE "
+                                                           "(" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '' OR " IS_PREFIX_PATH_OR_EQUAL("path", "?1") ") AND type == 2;"), _db);
+    if (!query) {
+        return;
+    }
+    query->bindValue(1, path);
 
-    if (!query.exec()) {
-        sqlFail(QStringLiteral("markVirtualFileForDownloadRecursively UPDATE metadata SET md5='_invalid_' path: %1").arg(QString::fromUtf8(path)), query);
+    if (!query->exec()) {
+        sqlFail(QStringLiteral("markVirtualFileForDownloadRecursively UPDATE metadata SET md5='_invalid_' path: %1").arg(QString::fromUtf8(path)), *query);
     }
 }
 
@@ -2615,88 +3109,162 @@ void SyncJournalDb::deleteE2EeLockedFolder(const QByteArray &folderId)
     ASSERT(query->exec())
 }
 
-Optional<PinState> SyncJournalDb::PinStateInterface::rawForPath(const QByteArray &path)
+QByteArray SyncJournalDb::e2eMetadataCache(const QByteArray &folderId, const QByteArray &etag)
 {
-    QMutexLocker lock(&_db->_mutex);
-    if (!_db->checkConnect())
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return {};
+    }
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetE2eMetadataCacheQuery,
+                                         QByteArrayLiteral("SELECT data FROM e2eMetadataCache WHERE folderId=?1 AND etag=?2;"),
+                                         _db);
+    ASSERT(query)
+    query->bindValue(1, folderId);
+    query->bindValue(2, etag);
+    ASSERT(query->exec())
+    if (!query->next().hasData) {
         return {};
+    }
 
-    const auto query = _db->_queryManager.get(PreparedSqlQueryManager::GetRawPinStateQuery, QByteArrayLiteral("SELECT pinState FROM flags WHERE path == ?1;"), _db->_db);
+    return query->baValue(0);
+}
+
+void SyncJournalDb::setE2eMetadataCache(const QByteArray &folderId, const QByteArray &etag, const QByteArray &data)
+{
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return;
+    }
+
+    const auto query = _queryManager.get(PreparedSqlQueryManager::SetE2eMetadataCacheQuery,
+                                         QByteArrayLiteral("INSERT OR REPLACE INTO e2eMetadataCache "
+                                                           "(folderId, etag, data) "
+                                                           "VALUES (?1, ?2, ?3);"),
+                                         _db);
     ASSERT(query)
-    query->bindValue(1, path);
-    query->exec();
+    query->bindValue(1, folderId);
+    query->bindValue(2, etag);
+    query->bindValue(3, data);
+    ASSERT(query->exec())
+}
 
-    auto next = query->next();
-    if (!next.ok)
-        return {};
-    // no-entry means Inherited
-    if (!next.hasData)
-        return PinState::Inherited;
+void SyncJournalDb::deleteE2eMetadataCache(const QByteArray &folderId)
+{
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return;
+    }
 
-    return static_cast<PinState>(query->intValue(0));
+    const auto query = _queryManager.get(PreparedSqlQueryManager::DeleteE2eMetadataCacheQuery, QByteArrayLiteral("DELETE FROM e2eMetadataCache WHERE folderId=?1;"), _db);
+    ASSERT(query)
+    query->bindValue(1, folderId);
+    ASSERT(query->exec())
 }
 
-Optional<PinState> SyncJournalDb::PinStateInterface::effectiveForPath(const QByteArray &path)
+bool SyncJournalDb::loadPinStates()
+{
+    SqlQuery query("SELECT path, pinState FROM flags;", _db);
+    if (!query.exec()) {
+        qCWarning(lcDb) << "Could not load the pin states" << query.error();
+        return false;
+    }
+
+    _pinStates.clear();
+    forever {
+        auto next = query.next();
+        if (!next.ok) {
+            _pinStates.clear();
+            return false;
+        }
+        if (!next.hasData)
+            break;
+        // a null pinState reads as 0, which is Inherited
+        _pinStates.insert(query.baValue(0), static_cast<PinState>(query.intValue(1)));
+    }
+    _pinStatesLoaded = true;
+    return true;
+}
+
+static PinState effectivePinState(const QMap<QByteArray, PinState> &pinStates, const QByteArray &path)
+{
+    auto current = path;
+    forever {
+        const auto pin = pinStates.value(current, PinState::Inherited);
+        if (pin != PinState::Inherited)
+            return pin;
+        if (current.isEmpty())
+            break;
+        const auto slashPosition = current.lastIndexOf('/');
+        current = slashPosition < 0 ? QByteArray("") : current.left(slashPosition);
+    }
+    // If the root path has no setting, assume AlwaysLocal
+    return PinState::AlwaysLocal;
+}
+
+static PinState effectivePinStateRecursive(const QMap<QByteArray, PinState> &pinStates, const QByteArray &path)
+{
+    // Get the item's effective pin state. We'll compare subitem's pin states
+    // against this.
+    const auto basePin = effectivePinState(pinStates, path);
+
+    // Check that all the non-inherited pin states below the item are identical
+    const auto prefix = path.isEmpty() ? QByteArray() : path + '/';
+    for (auto it = pinStates.lowerBound(prefix); it != pinStates.cend() && it.key().startsWith(prefix); ++it) {
+        if (it.value() != PinState::Inherited && it.value() != basePin)
+            return PinState::Inherited;
+    }
+
+    return basePin;
+}
+
+Optional<PinState> SyncJournalDb::PinStateInterface::rawForPath(const QByteArray &path)
 {
     QMutexLocker lock(&_db->_mutex);
     if (!_db->checkConnect())
         return {};
+    if (!_db->_pinStatesLoaded && !_db->loadPinStates())
+        return {};
 
-    const auto query = _db->_queryManager.get(PreparedSqlQueryManager::GetEffectivePinStateQuery, QByteArrayLiteral("SELECT pinState FROM flags WHERE"
-                                                                                                                    // explicitly allow "" to represent the root path
-                                                                                                                    // (it'd be great if paths started with a / and "/" could be the root)
-                                                                                                                    " (" IS_PREFIX_PATH_OR_EQUAL("path", "?1") " OR path == '')"
-                                                                                                                                                               " AND pinState is not null AND pinState != 0"
-                                                                                                                                                               " ORDER BY length(path) DESC LIMIT 1;"),
-        _db->_db);
-    ASSERT(query)
-    query->bindValue(1, path);
-    query->exec();
+    // no-entry means Inherited
+    return _db->_pinStates.value(path, PinState::Inherited);
+}
 
-    auto next = query->next();
-    if (!next.ok)
+Optional<PinState> SyncJournalDb::PinStateInterface::effectiveForPath(const QByteArray &path)
+{
+    QMutexLocker lock(&_db->_mutex);
+    if (!_db->checkConnect())
+        return {};
+    if (!_db->_pinStatesLoaded && !_db->loadPinStates())
         return {};
-    // If the root path has no setting, assume AlwaysLocal
-    if (!next.hasData)
-        return PinState::AlwaysLocal;
 
-    return static_cast<PinState>(query->intValue(0));
+    return effectivePinState(_db->_pinStates, path);
 }
 
 Optional<PinState> SyncJournalDb::PinStateInterface::effectiveForPathRecursive(const QByteArray &path)
 {
-    // Get the item's effective pin state. We'll compare subitem's pin states
-    // against this.
-    const auto basePin = effectiveForPath(path);
-    if (!basePin)
+    QMutexLocker lock(&_db->_mutex);
+    if (!_db->checkConnect())
+        return {};
+    if (!_db->_pinStatesLoaded && !_db->loadPinStates())
         return {};
 
+    return effectivePinStateRecursive(_db->_pinStates, path);
+}
+
+Optional<QHash<QByteArray, PinState>> SyncJournalDb::PinStateInterface::effectiveForPathsRecursive(const QVector<QByteArray> &paths)
+{
     QMutexLocker lock(&_db->_mutex);
     if (!_db->checkConnect())
         return {};
+    if (!_db->_pinStatesLoaded && !_db->loadPinStates())
+        return {};
 
-    // Find all the non-inherited pin states below the item
-    const auto query = _db->_queryManager.get(PreparedSqlQueryManager::GetSubPinsQuery, QByteArrayLiteral("SELECT DISTINCT pinState FROM flags WHERE"
-                                                                                                          " (" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '')"
-                                                                                                                                               " AND pinState is not null and pinState != 0;"),
-        _db->_db);
-    ASSERT(query)
-    query->bindValue(1, path);
-    query->exec();
-
-    // Check if they are all identical
-    forever {
-        auto next = query->next();
-        if (!next.ok)
-            return {};
-        if (!next.hasData)
-            break;
-        const auto subPin = static_cast<PinState>(query->intValue(0));
-        if (subPin != *basePin)
-            return PinState::Inherited;
+    QHash<QByteArray, PinState> result;
+    result.reserve(paths.size());
+    for (const auto &path : paths) {
+        result.insert(path, effectivePinStateRecursive(_db->_pinStates, path));
     }
-
-    return *basePin;
+    return result;
 }
 
 void SyncJournalDb::PinStateInterface::setForPath(const QByteArray &path, PinState state)
@@ -2716,7 +3284,14 @@ void SyncJournalDb::PinStateInterface::setForPath(const QByteArray &path, PinSta
     ASSERT(query)
     query->bindValue(1, path);
     query->bindValue(2, state);
-    query->exec();
+    if (!query->exec()) {
+        _db->_pinStatesLoaded = false;
+        return;
+    }
+
+    if (_db->_pinStatesLoaded) {
+        _db->_pinStates.insert(path, state);
+    }
 }
 
 void SyncJournalDb::PinStateInterface::wipeForPathAndBelow(const QByteArray &path)
@@ -2731,7 +3306,22 @@ void SyncJournalDb::PinStateInterface::wipeForPathAndBelow(const QByteArray &pat
         _db->_db);
     ASSERT(query)
     query->bindValue(1, path);
-    query->exec();
+    if (!query->exec()) {
+        _db->_pinStatesLoaded = false;
+        return;
+    }
+
+    if (path.isEmpty()) {
+        _db->_pinStates.clear();
+    } else if (_db->_pinStatesLoaded) {
+        auto &pinStates = _db->_pinStates;
+        pinStates.remove(path);
+        const auto prefix = path + '/';
+        auto it = pinStates.lowerBound(prefix);
+        while (it != pinStates.end() && it.key().startsWith(prefix)) {
+            it = pinStates.erase(it);
+        }
+    }
 }
 
 Optional<QVector<QPair<QByteArray, PinState>>>
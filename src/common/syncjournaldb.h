@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QDateTime>
 #include <QHash>
+#include <QMap>
 #include <QMutex>
 #include <QVariant>
 #include <functional>
@@ -67,8 +68,18 @@ public:
     [[nodiscard]] bool getFileRecordByE2eMangledName(const QString &mangledName, SyncJournalFileRecord *rec);
     [[nodiscard]] bool getFileRecordByInode(quint64 inode, SyncJournalFileRecord *rec);
     [[nodiscard]] bool getFileRecordsByFileId(const QByteArray &fileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
+    /// Up to maxCount plain files of the given size that have a content checksum
+    [[nodiscard]] bool getFileRecordsBySize(qint64 size, int maxCount, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
     [[nodiscard]] bool getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
     [[nodiscard]] bool listFilesInPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
+
+    struct SubtreeRecordCount
+    {
+        qint64 _records = 0; ///< the entry itself and everything below it
+        bool _isDirectory = false;
+    };
+    /// Record counts of the direct children of path ("" for the root), keyed by their path
+    [[nodiscard]] bool getSubtreeRecordCounts(const QByteArray &path, QMap<QByteArray, SubtreeRecordCount> *counts);
     [[nodiscard]] Result<void, QString> setFileRecord(const SyncJournalFileRecord &record);
     [[nodiscard]] bool getRootE2eFolderRecord(const QString &remoteFolderPath, SyncJournalFileRecord *rec);
     [[nodiscard]] bool listAllE2eeFoldersWithEncryptionStatusLessThan(const int status, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
@@ -93,12 +104,25 @@ public:
         bool hasDehydrated = false;
     };
 
-    /** Returns whether the item or any subitems are dehydrated */
+    /** Returns whether the item or any subitems are dehydrated
+     *
+     * Answered from per-folder counts kept in memory, see _hydrationSummaries.
+     */
     Optional<HasHydratedDehydrated> hasHydratedOrDehydratedFiles(const QByteArray &filename);
 
     bool exists();
     void walCheckpoint();
 
+    /** Counters of the prepared statements since the journal was created
+     *
+     * How often each statement was prepared and reused, how long sqlite
+     * spent in it and how many rows it produced, most expensive first.
+     */
+    [[nodiscard]] QVector<PreparedSqlQueryManager::Statistics> queryStatistics();
+
+    /// The most expensive statements of queryStatistics(), one per line
+    [[nodiscard]] QString queryStatisticsSummary(int maxStatements = 10);
+
     [[nodiscard]] QString databaseFilePath() const;
 
     static qint64 getPHash(const QByteArray &);
@@ -151,8 +175,14 @@ public:
     // Return the list of transfer ids that were removed.
     QVector<uint> deleteStaleUploadInfos(const QSet<QString> &keep);
 
+    /// The first call after opening the database or reloadErrorBlacklistOnNextUse() loads the whole blacklist into memory
     SyncJournalErrorBlacklistRecord errorBlacklistEntry(const QString &);
     [[nodiscard]] bool deleteStaleErrorBlacklistEntries(const QSet<QString> &keep);
+    /**
+     * Forget the loaded blacklist, the next errorBlacklistEntry() reads it again.
+     * Done at the start of each sync run to pick up the entries other processes wrote.
+     */
+    void reloadErrorBlacklistOnNextUse();
 
     /// Delete flags table entries that have no metadata correspondent
     void deleteStaleFlagsEntries();
@@ -264,6 +294,9 @@ public:
     /// Return all paths of files with a conflict tag in the name and records in the db
     QByteArrayList caseClashConflictRecordPaths();
 
+    /// Return all case clash conflict records, for lookups without a query per file
+    QVector<ConflictRecord> caseClashConflictRecords();
+
     /// Delete a conflict record by path of the file with the conflict tag
     void deleteConflictRecord(const QByteArray &path);
 
@@ -298,6 +331,15 @@ public:
     QList<QPair<QByteArray, QByteArray>> e2EeLockedFolders();
     void deleteE2EeLockedFolder(const QByteArray &folderId);
 
+    /**
+     * What the discovery learned from the metadata of an end-to-end encrypted
+     * folder, stored encrypted. Only valid as long as the etag of the folder
+     * did not change: returns an empty array for any other etag.
+     */
+    [[nodiscard]] QByteArray e2eMetadataCache(const QByteArray &folderId, const QByteArray &etag);
+    void setE2eMetadataCache(const QByteArray &folderId, const QByteArray &etag, const QByteArray &data);
+    void deleteE2eMetadataCache(const QByteArray &folderId);
+
     /** Grouping for all functions relating to pin states,
      *
      * Use internalPinStates() to get at them.
@@ -350,6 +392,16 @@ public:
          */
         Optional<PinState> effectiveForPathRecursive(const QByteArray &path);
 
+        /**
+         * Like effectiveForPathRecursive() for many paths at once.
+         *
+         * Reads the flags table at most once, so this is what callers
+         * asking about a whole selection of files should use.
+         *
+         * Returns none on db error.
+         */
+        Optional<QHash<QByteArray, PinState>> effectiveForPathsRecursive(const QVector<QByteArray> &paths);
+
         /**
          * Sets a path's pin state.
          *
@@ -405,6 +457,12 @@ private:
     [[nodiscard]] bool updateDatabaseStructure();
     [[nodiscard]] bool updateMetadataTableStructure();
     [[nodiscard]] bool updateErrorBlacklistTableStructure();
+    [[nodiscard]] bool loadErrorBlacklist();
+    [[nodiscard]] QString errorBlacklistKey(const QString &file) const;
+    [[nodiscard]] const SyncJournalErrorBlacklistRecord *cachedErrorBlacklistEntry(const QString &file) const;
+    void cacheErrorBlacklistEntry(const SyncJournalErrorBlacklistRecord &entry);
+    void uncacheErrorBlacklistEntry(const QString &file);
+    void dropErrorBlacklist();
     bool sqlFail(const QString &log, const SqlQuery &query);
     void commitInternal(const QString &context, bool startTrans = true);
     void startTransaction();
@@ -412,6 +470,24 @@ private:
     QVector<QByteArray> tableColumns(const QByteArray &table);
     bool checkConnect();
 
+    /// Counts of the hydrated and dehydrated files below a folder
+    struct HydrationSummary
+    {
+        qint64 hydrated = 0;
+        qint64 dehydrated = 0;
+    };
+    [[nodiscard]] bool loadHydrationSummaries();
+    void dropHydrationSummaries();
+    // Adds the deltas to the summaries of all parent folders of path
+    void updateHydrationSummaries(const QByteArray &path, qint64 hydratedDelta, qint64 dehydratedDelta);
+    void updateHydrationSummaries(const QByteArray &path, ItemType type, qint64 delta);
+    // Returns ItemTypeSkip if there is no record for path, none on db error
+    Optional<ItemType> fileRecordType(const QByteArray &path);
+    // Like fileRecordType(), but answered without a query if path was the last record read or written
+    Optional<ItemType> previousRecordType(const QByteArray &path);
+    void rememberRecordType(const QByteArray &path, ItemType type);
+    [[nodiscard]] bool loadPinStates();
+
     // Same as forceRemoteDiscoveryNextSync but without acquiring the lock
     void forceRemoteDiscoveryNextSyncLocked();
 
@@ -442,6 +518,47 @@ private:
      */
     QList<QByteArray> _etagStorageFilter;
 
+    /* The error blacklist is consulted for every discovered item, and a sync with
+     * many failing files would otherwise pay one query per item.
+     *
+     * Loaded by the first errorBlacklistEntry() call, kept up to date by the
+     * functions writing the blacklist and dropped on close() and by
+     * reloadErrorBlacklistOnNextUse() at the start of each sync run. Entries
+     * another process writes during a run are only seen by the next one. The keys are
+     * the exact paths, like the rows. Lookups go through _errorBlacklistPaths,
+     * which maps errorBlacklistKey() to the paths that fold to it.
+     */
+    QHash<QString, SyncJournalErrorBlacklistRecord> _errorBlacklist;
+    QMultiHash<QString, QString> _errorBlacklistPaths;
+    bool _errorBlacklistLoaded = false;
+
+    /* The availability of a folder depends on whether any file below it is
+     * hydrated or dehydrated, and the file manager asks for it on every
+     * context menu. Answering that from the metadata table is a prefix scan.
+     *
+     * Built by the first hasHydratedOrDehydratedFiles() call with one scan of
+     * the metadata table, updated by setFileRecord() and deleteFileRecord()
+     * and dropped on close() and clearFileTable(). Only folders with files
+     * below them have an entry, the root folder is "".
+     */
+    QHash<QByteArray, HydrationSummary> _hydrationSummaries;
+    bool _hydrationSummariesLoaded = false;
+    // The type of the record last read or written while the summaries are loaded,
+    // ItemTypeSkip if there is none. Spares the writes a lookup of the previous type.
+    QByteArray _lastRecordPath;
+    ItemType _lastRecordType = ItemTypeSkip;
+    bool _lastRecordTypeKnown = false;
+
+    /* Copy of the flags table for the PinStateInterface lookups.
+     *
+     * Loaded by the first lookup, kept up to date by setForPath() and
+     * wipeForPathAndBelow() and dropped on close() and
+     * deleteStaleFlagsEntries(). Sorted so that the pin states below a path
+     * are a contiguous range.
+     */
+    QMap<QByteArray, PinState> _pinStates;
+    bool _pinStatesLoaded = false;
+
     /** The journal mode to use for the db.
      *
      * Typically WAL initially, but may be set to other modes via environment
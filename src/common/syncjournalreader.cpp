@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "syncjournalreader.h"
+
+#include <QLoggingCategory>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcJournalReader, "nextcloud.sync.database.reader", QtInfoMsg)
+
+SyncJournalReader::SyncJournalReader(SyncJournalDb *journal)
+    : _journal(journal)
+{
+    // One thread: lookups run in order and don't compete for the journal's lock
+    _pool.setMaxThreadCount(1);
+    _pool.setExpiryTimeout(30 * 1000);
+}
+
+SyncJournalReader::~SyncJournalReader()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+QFuture<SyncJournalFileRecord> SyncJournalReader::fileRecord(const QByteArray &path)
+{
+    return run([path](SyncJournalDb &journal) {
+        SyncJournalFileRecord record;
+        if (!journal.getFileRecord(path, &record)) {
+            qCWarning(lcJournalReader) << "could not get file from local DB" << path;
+        }
+        return record;
+    });
+}
+
+QFuture<QByteArray> SyncJournalReader::conflictFileBaseName(const QByteArray &conflictName)
+{
+    return run([conflictName](SyncJournalDb &journal) {
+        return journal.conflictFileBaseName(conflictName);
+    });
+}
+
+QFuture<QHash<QByteArray, QByteArray>> SyncJournalReader::conflictFileBaseNames(const QVector<QByteArray> &conflictNames)
+{
+    return run([conflictNames](SyncJournalDb &journal) {
+        QHash<QByteArray, QByteArray> baseNames;
+        baseNames.reserve(conflictNames.size());
+        for (const auto &conflictName : conflictNames) {
+            baseNames.insert(conflictName, journal.conflictFileBaseName(conflictName));
+        }
+        return baseNames;
+    });
+}
+
+QFuture<ConflictRecord> SyncJournalReader::caseConflictRecordByBasePath(const QString &baseNamePath)
+{
+    return run([baseNamePath](SyncJournalDb &journal) {
+        return journal.caseConflictRecordByBasePath(baseNamePath);
+    });
+}
+
+}
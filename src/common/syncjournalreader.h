@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "ocsynclib.h"
+#include "common/syncjournaldb.h"
+#include "common/syncjournalfilerecord.h"
+
+#include <QFuture>
+#include <QThreadPool>
+#include <qtconcurrentrun.h>
+
+#include <type_traits>
+
+namespace OCC {
+
+/**
+ * @brief Runs journal lookups of the GUI off the GUI thread
+ *
+ * The sync engine holds the journal's lock while it executes its statements
+ * and commits, so a lookup from the GUI thread can stall the interface until
+ * the engine is done. The lookups started here run on a thread of their own,
+ * in the order they were started, and hand the result back as a QFuture;
+ * connect a QFutureWatcher to get it on the GUI thread.
+ *
+ * A separate read connection isn't possible: the journal is opened with an
+ * exclusive locking mode by default, see SyncJournalDb::checkConnect().
+ *
+ * @ingroup libsync
+ */
+class OCSYNC_EXPORT SyncJournalReader
+{
+public:
+    explicit SyncJournalReader(SyncJournalDb *journal);
+    /// Drops the lookups that didn't start yet and waits for the running one
+    ~SyncJournalReader();
+
+    /// Runs function(journal) on the reader's thread
+    template <typename Function>
+    auto run(Function function) -> QFuture<std::invoke_result_t<Function, SyncJournalDb &>>
+    {
+        return QtConcurrent::run(&_pool, [journal = _journal, function] {
+            return function(*journal);
+        });
+    }
+
+    /// An invalid record if there is none or on error
+    QFuture<SyncJournalFileRecord> fileRecord(const QByteArray &path);
+    QFuture<QByteArray> conflictFileBaseName(const QByteArray &conflictName);
+    /// conflictFileBaseName() of each of the paths, keyed by the path
+    QFuture<QHash<QByteArray, QByteArray>> conflictFileBaseNames(const QVector<QByteArray> &conflictNames);
+    QFuture<ConflictRecord> caseConflictRecordByBasePath(const QString &baseNamePath);
+
+private:
+    Q_DISABLE_COPY(SyncJournalReader)
+
+    SyncJournalDb *_journal;
+    QThreadPool _pool;
+};
+
+}
@@ -48,6 +48,7 @@
 #include <cmath>
 #include <cstdarg>
 #include <cstring>
+#include <vector>
 
 namespace {
 constexpr auto bytes = 1024;
@@ -525,7 +526,21 @@ void Utility::sortFilenames(QStringList &fileNames)
     QCollator collator;
     collator.setNumericMode(true);
     collator.setCaseSensitivity(Qt::CaseInsensitive);
-    std::sort(fileNames.begin(), fileNames.end(), collator);
+
+    // Collating both names on every comparison is expensive, compute the
+    // collation key of every name once instead
+    std::vector<std::pair<QCollatorSortKey, QString>> keyedNames;
+    keyedNames.reserve(fileNames.size());
+    for (const auto &fileName : qAsConst(fileNames)) {
+        keyedNames.emplace_back(collator.sortKey(fileName), fileName);
+    }
+    std::stable_sort(keyedNames.begin(), keyedNames.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first.compare(rhs.first) < 0;
+    });
+
+    for (int i = 0; i < fileNames.size(); ++i) {
+        fileNames[i] = std::move(keyedNames[i].second);
+    }
 }
 
 QUrl Utility::concatUrlPath(const QUrl &url, const QString &concatPath,
@@ -103,14 +103,10 @@ Optional<PinState> Vfs::pinStateInDb(const QString &folderPath)
     return pin;
 }
 
-Vfs::AvailabilityResult Vfs::availabilityInDb(const QString &folderPath)
+static Vfs::AvailabilityResult availabilityFromDb(const Optional<PinState> &pin, const Optional<SyncJournalDb::HasHydratedDehydrated> &hydrationStatus)
 {
-    auto path = folderPath.toUtf8();
-    auto pin = _setupParams.journal->internalPinStates().effectiveForPathRecursive(path);
-    // not being able to retrieve the pin state isn't too bad
-    auto hydrationStatus = _setupParams.journal->hasHydratedOrDehydratedFiles(path);
     if (!hydrationStatus)
-        return AvailabilityError::DbError;
+        return Vfs::AvailabilityError::DbError;
 
     if (hydrationStatus->hasDehydrated) {
         if (hydrationStatus->hasHydrated)
@@ -125,7 +121,71 @@ Vfs::AvailabilityResult Vfs::availabilityInDb(const QString &folderPath)
         else
             return VfsItemAvailability::AllHydrated;
     }
-    return AvailabilityError::NoSuchItem;
+    return Vfs::AvailabilityError::NoSuchItem;
+}
+
+static void mergeAvailability(Optional<VfsItemAvailability> &combined, Vfs::AvailabilityResult availability)
+{
+    if (!availability) {
+        if (availability.error() == Vfs::AvailabilityError::NoSuchItem)
+            return;
+        availability = VfsItemAvailability::Mixed;
+    }
+    if (!combined) {
+        combined = *availability;
+        return;
+    }
+
+    auto lhs = *combined;
+    auto rhs = *availability;
+    if (lhs == rhs)
+        return;
+    if (int(lhs) > int(rhs))
+        std::swap(lhs, rhs); // reduce cases ensuring lhs < rhs
+    if (lhs == VfsItemAvailability::AlwaysLocal && rhs == VfsItemAvailability::AllHydrated)
+        combined = VfsItemAvailability::AllHydrated;
+    else if (lhs == VfsItemAvailability::AllDehydrated && rhs == VfsItemAvailability::OnlineOnly)
+        combined = VfsItemAvailability::AllDehydrated;
+    else
+        combined = VfsItemAvailability::Mixed;
+}
+
+Vfs::AvailabilityResult Vfs::availabilityInDb(const QString &folderPath)
+{
+    auto path = folderPath.toUtf8();
+    auto pin = _setupParams.journal->internalPinStates().effectiveForPathRecursive(path);
+    // not being able to retrieve the pin state isn't too bad
+    return availabilityFromDb(pin, _setupParams.journal->hasHydratedOrDehydratedFiles(path));
+}
+
+Optional<VfsItemAvailability> Vfs::combinedAvailability(const QStringList &folderPaths)
+{
+    Optional<VfsItemAvailability> combined;
+    for (const auto &folderPath : folderPaths) {
+        mergeAvailability(combined, availability(folderPath));
+    }
+    return combined;
+}
+
+Optional<VfsItemAvailability> Vfs::combinedAvailabilityInDb(const QStringList &folderPaths)
+{
+    QVector<QByteArray> paths;
+    paths.reserve(folderPaths.size());
+    for (const auto &folderPath : folderPaths) {
+        paths.append(folderPath.toUtf8());
+    }
+    // not being able to retrieve the pin states isn't too bad
+    const auto pins = _setupParams.journal->internalPinStates().effectiveForPathsRecursive(paths);
+
+    Optional<VfsItemAvailability> combined;
+    for (const auto &path : qAsConst(paths)) {
+        Optional<PinState> pin;
+        if (pins) {
+            pin = pins->value(path);
+        }
+        mergeAvailability(combined, availabilityFromDb(pin, _setupParams.journal->hasHydratedOrDehydratedFiles(path)));
+    }
+    return combined;
 }
 
 VfsOff::VfsOff(QObject *parent)
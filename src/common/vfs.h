@@ -260,6 +260,13 @@ public:
      */
     Q_REQUIRED_RESULT virtual AvailabilityResult availability(const QString &folderPath) = 0;
 
+    /** Returns the availability of a selection of items as a whole.
+     *
+     * Merges the availability() of each path, paths without an item are
+     * skipped. Returns none if none of the items exists.
+     */
+    Q_REQUIRED_RESULT virtual Optional<VfsItemAvailability> combinedAvailability(const QStringList &folderPaths);
+
 public slots:
     /** Update in-sync state based on SyncFileStatusTracker signal.
      *
@@ -293,6 +300,8 @@ protected:
     bool setPinStateInDb(const QString &folderPath, PinState state);
     Optional<PinState> pinStateInDb(const QString &folderPath);
     AvailabilityResult availabilityInDb(const QString &folderPath);
+    // Like combinedAvailability() with availabilityInDb(), but looks up the pin states at once
+    Optional<VfsItemAvailability> combinedAvailabilityInDb(const QStringList &folderPaths);
 
     // the parameters passed to start()
     VfsSetupParams _setupParams;
@@ -335,6 +335,8 @@ void AccountSettings::slotEncryptFolderFinished(int status)
     const auto folder = job->property(propertyFolder).value<Folder *>();
     Q_ASSERT(folder);
     const auto path = job->property(propertyPath).toString();
+    // The listings still have the folder unencrypted
+    _accountState->account()->remoteTreeIndex()->invalidate(folder->remotePathTrailingSlash() + path);
     const auto index = _model->indexForPath(folder, path);
     Q_ASSERT(index.isValid());
     _model->resetAndFetch(index.parent());
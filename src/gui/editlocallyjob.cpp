@@ -16,6 +16,7 @@
 
 #include <QMessageBox>
 #include <QDesktopServices>
+#include <QFutureWatcher>
 #include <QtConcurrent>
 
 #include "editlocallymanager.h"
@@ -50,6 +51,8 @@ void EditLocallyJob::startSetup()
         return;
     }
 
+    _timeSinceRequest.start();
+
     // Show the loading dialog but don't show the filename until we have
     // verified the token
     Systray::instance()->createEditFileLocallyLoadingDialog({});
@@ -222,7 +225,7 @@ void EditLocallyJob::fetchRemoteFileParentInfo()
     job->start();
 }
 
-bool EditLocallyJob::checkIfFileParentSyncIsNeeded()
+bool EditLocallyJob::checkIfFileParentSyncIsNeeded(const SyncJournalFileRecord &parentRecord, const SyncJournalFileRecord &fileRecord)
 {
     if (_relPathParent == QLatin1String("/")) {
         return true;
@@ -234,20 +237,18 @@ bool EditLocallyJob::checkIfFileParentSyncIsNeeded()
         return true;
     }
 
-    SyncJournalFileRecord rec;
-    if (!_folderForFile->journalDb()->getFileRecord(_fileParentItem->_file, &rec) || !rec.isValid()) {
+    if (!parentRecord.isValid()) {
         // we don't have this folder locally, so let's sync it
         _fileParentItem->_direction = SyncFileItem::Down;
         _fileParentItem->_instruction = CSYNC_INSTRUCTION_NEW;
-    } else if (rec._etag != _fileParentItem->_etag && rec._modtime != _fileParentItem->_modtime) {
+    } else if (parentRecord._etag != _fileParentItem->_etag && parentRecord._modtime != _fileParentItem->_modtime) {
         // we just need to update metadata as the folder is already present locally
-        _fileParentItem->_direction = rec._modtime < _fileParentItem->_modtime ? SyncFileItem::Down : SyncFileItem::Up;
+        _fileParentItem->_direction = parentRecord._modtime < _fileParentItem->_modtime ? SyncFileItem::Down : SyncFileItem::Up;
         _fileParentItem->_instruction = CSYNC_INSTRUCTION_UPDATE_METADATA;
     } else {
         _fileParentItem->_direction = SyncFileItem::Down;
         _fileParentItem->_instruction = CSYNC_INSTRUCTION_UPDATE_METADATA;
-        SyncJournalFileRecord recFile;
-        if (_folderForFile->journalDb()->getFileRecord(_relativePathToRemoteRoot, &recFile) && recFile.isValid()) {
+        if (fileRecord.isValid()) {
             return false;
         }
     }
@@ -262,15 +263,33 @@ void EditLocallyJob::startSyncBeforeOpening()
         return;
     }
 
-    if (!checkIfFileParentSyncIsNeeded()) {
-        processLocalItem();
-        return;
-    }
+    // The sync engine may hold the journal, look the folder and the file up off the GUI thread
+    const auto parentPath = _fileParentItem ? _fileParentItem->_file.toUtf8() : QByteArray{};
+    const auto filePath = _relativePathToRemoteRoot.toUtf8();
+    const auto watcher = new QFutureWatcher<QPair<SyncJournalFileRecord, SyncJournalFileRecord>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        const auto records = watcher->result();
+        if (!checkIfFileParentSyncIsNeeded(records.first, records.second)) {
+            processLocalRecord(records.second);
+            return;
+        }
 
-    // connect to a SyncEngine::itemDiscovered so we can complete the job as soon as the file in question is discovered
-    QObject::connect(&_folderForFile->syncEngine(), &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
-    _folderForFile->syncEngine().setSingleItemDiscoveryOptions({_relPathParent, _relativePathToRemoteRoot, _fileParentItem});
-    FolderMan::instance()->forceSyncForFolder(_folderForFile);
+        // connect to a SyncEngine::itemDiscovered so we can complete the job as soon as the file in question is discovered
+        _singleItemSyncEngine = _folderForFile->startSingleItemSync(_relPathParent, _relativePathToRemoteRoot, _fileParentItem);
+        QObject::connect(_singleItemSyncEngine, &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
+    });
+    watcher->setFuture(_folderForFile->journalReader()->run([parentPath, filePath](SyncJournalDb &journal) {
+        SyncJournalFileRecord parentRecord;
+        if (!parentPath.isEmpty() && !journal.getFileRecord(parentPath, &parentRecord)) {
+            parentRecord = {};
+        }
+        SyncJournalFileRecord fileRecord;
+        if (!journal.getFileRecord(filePath, &fileRecord)) {
+            fileRecord = {};
+        }
+        return qMakePair(parentRecord, fileRecord);
+    }));
 }
 
 bool EditLocallyJob::eraseBlacklistRecordForItem()
@@ -290,15 +309,12 @@ bool EditLocallyJob::eraseBlacklistRecordForItem()
         return false;
     }
 
-    Q_ASSERT(!_folderForFile->isSyncRunning());
-    if (_folderForFile->isSyncRunning()) {
-        qCWarning(lcEditLocallyJob) << "_folderForFile is syncing";
-        return false;
-    }
-
-    if (_folderForFile->journalDb()->errorBlacklistEntry(_fileParentItem->_file).isValid()) {
-        _folderForFile->journalDb()->wipeErrorBlacklistEntry(_fileParentItem->_file);
-    }
+    // runs before the lookups of startSyncBeforeOpening(), the reader keeps the order
+    _folderForFile->journalReader()->run([file = _fileParentItem->_file](SyncJournalDb &journal) {
+        if (journal.errorBlacklistEntry(file).isValid()) {
+            journal.wipeErrorBlacklistEntry(file);
+        }
+    });
 
     return true;
 }
@@ -469,19 +485,7 @@ void EditLocallyJob::startEditLocally()
 
     Systray::instance()->createEditFileLocallyLoadingDialog(_fileName);
 
-    if (_folderForFile->isSyncRunning()) {
-        // in case sync is already running - terminate it and start a new one
-        _syncTerminatedConnection = connect(_folderForFile, &Folder::syncFinished, this, [this]() {
-            disconnect(_syncTerminatedConnection);
-            _syncTerminatedConnection = {};
-            startSyncBeforeOpening();
-        });
-        _folderForFile->setSilenceErrorsUntilNextSync(true);
-        _folderForFile->slotTerminateSync();
-        _shouldScheduleFolderSyncAfterFileIsOpened = true;
-
-        return;
-    }
+    // The file is synced on an engine of its own, a running sync of the folder does not need to be stopped
     startSyncBeforeOpening();
 }
 
@@ -492,8 +496,10 @@ void EditLocallyJob::slotItemCompleted(const OCC::SyncFileItemPtr &item)
         qCWarning(lcEditLocallyJob) << "invalid item";
     }
     if (item->_file == _relativePathToRemoteRoot) {
-        disconnect(&_folderForFile->syncEngine(), &SyncEngine::itemCompleted, this, &EditLocallyJob::slotItemCompleted);
-        disconnect(&_folderForFile->syncEngine(), &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
+        if (_singleItemSyncEngine) {
+            disconnect(_singleItemSyncEngine, &SyncEngine::itemCompleted, this, &EditLocallyJob::slotItemCompleted);
+            disconnect(_singleItemSyncEngine, &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
+        }
         processLocalItem();
     }
 }
@@ -557,14 +563,14 @@ void EditLocallyJob::slotItemDiscovered(const OCC::SyncFileItemPtr &item)
         showError(tr("Could not start editing locally."),
                   tr("An error occurred trying to synchronise the file to edit locally."));
     } else if (item->_file == _relativePathToRemoteRoot) {
-        disconnect(&_folderForFile->syncEngine(), &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
+        disconnect(_singleItemSyncEngine, &SyncEngine::itemDiscovered, this, &EditLocallyJob::slotItemDiscovered);
         if (item->_instruction == CSYNC_INSTRUCTION_NONE) {
             // return early if the file is already in sync
             slotItemCompleted(item);
             return;
         }
         // or connect to the SyncEngine::itemCompleted and wait till the file gets sycned
-        QObject::connect(&_folderForFile->syncEngine(), &SyncEngine::itemCompleted, this, &EditLocallyJob::slotItemCompleted);
+        QObject::connect(_singleItemSyncEngine, &SyncEngine::itemCompleted, this, &EditLocallyJob::slotItemCompleted);
     }
 }
 
@@ -579,6 +585,8 @@ void EditLocallyJob::openFile()
         return;
     }
 
+    qCInfo(lcEditLocallyJob) << "Opening" << _relPath << _timeSinceRequest.elapsed() << "ms after the request";
+
     const auto localFilePathUrl = QUrl::fromLocalFile(_localFilePath);
     // In case the VFS mode is enabled and a file is not yet hydrated, we must call QDesktopServices::openUrl
     // from a separate thread, or, there will be a freeze. To avoid searching for a specific folder and checking
@@ -590,10 +598,6 @@ void EditLocallyJob::openFile()
 
         Systray::instance()->destroyEditFileLocallyLoadingDialog();
 
-        if (_shouldScheduleFolderSyncAfterFileIsOpened) {
-            _folderForFile->startSync();
-        }
-
         emit finished();
     });
 }
@@ -602,26 +606,35 @@ void EditLocallyJob::processLocalItem()
 {
     Q_ASSERT(_folderForFile);
 
-    SyncJournalFileRecord rec;
-    const auto ok = _folderForFile->journalDb()->getFileRecord(_relativePathToRemoteRoot, &rec);
-    Q_ASSERT(ok);
+    // The sync engine may hold the journal, don't wait for it on the GUI thread
+    const auto watcher = new QFutureWatcher<SyncJournalFileRecord>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        processLocalRecord(watcher->result());
+    });
+    watcher->setFuture(_folderForFile->journalReader()->fileRecord(_relativePathToRemoteRoot.toUtf8()));
+}
+
+void EditLocallyJob::processLocalRecord(const SyncJournalFileRecord &rec)
+{
+    Q_ASSERT(rec.isValid());
 
     // Do not lock if it is a directory or lock is not available on the server
     if (rec.isDirectory() || !_accountState->account()->capabilities().filesLockAvailable()) {
         openFile();
     } else {
-        lockFile();
+        lockFile(rec);
     }
 }
 
-void EditLocallyJob::lockFile()
+void EditLocallyJob::lockFile(const SyncJournalFileRecord &rec)
 {
     Q_ASSERT(_accountState);
     Q_ASSERT(_accountState->account());
     Q_ASSERT(_folderForFile);
 
-    if (_accountState->account()->fileLockStatus(_folderForFile->journalDb(), _relativePathToRemoteRoot) == SyncFileItem::LockStatus::LockedItem) {
-        fileAlreadyLocked();
+    if (rec._lockstate._locked) {
+        fileAlreadyLocked(rec);
         return;
     }
 
@@ -631,16 +644,14 @@ void EditLocallyJob::lockFile()
         }
     };
 
-    const auto runSingleFileDiscovery = [this] {
-        const SyncEngine::SingleItemDiscoveryOptions singleItemDiscoveryOptions = {_relPathParent, _relativePathToRemoteRoot, _fileParentItem};
-        _folderForFile->syncEngine().setSingleItemDiscoveryOptions(singleItemDiscoveryOptions);
-        FolderMan::instance()->forceSyncForFolder(_folderForFile);
+    const auto runSingleFileDiscovery = [this, syncEngineFileSlot] {
+        const auto engine = _folderForFile->startSingleItemSync(_relPathParent, _relativePathToRemoteRoot, _fileParentItem);
+        _folderConnections.append(connect(engine, &SyncEngine::itemCompleted,
+                                          this, syncEngineFileSlot));
+        _folderConnections.append(connect(engine, &SyncEngine::itemDiscovered,
+                                          this, syncEngineFileSlot));
     };
 
-    _folderConnections.append(connect(&_folderForFile->syncEngine(), &SyncEngine::itemCompleted,
-                                      this, syncEngineFileSlot));
-    _folderConnections.append(connect(&_folderForFile->syncEngine(), &SyncEngine::itemDiscovered,
-                                      this, syncEngineFileSlot));
     _folderConnections.append(connect(_accountState->account().data(), &Account::lockFileSuccess,
                                       this, runSingleFileDiscovery));
     _folderConnections.append(connect(_accountState->account().data(), &Account::lockFileError,
@@ -661,10 +672,8 @@ void EditLocallyJob::disconnectFolderSignals()
     }
 }
 
-void EditLocallyJob::fileAlreadyLocked()
+void EditLocallyJob::fileAlreadyLocked(const SyncJournalFileRecord &rec)
 {
-    SyncJournalFileRecord rec;
-    Q_ASSERT(_folderForFile->journalDb()->getFileRecord(_relativePathToRemoteRoot, &rec));
     Q_ASSERT(rec.isValid());
     Q_ASSERT(rec._lockstate._locked);
 
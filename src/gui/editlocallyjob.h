@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QPointer>
 
 #include "accountstate.h"
 #include "syncfileitem.h"
+#include "common/syncjournalfilerecord.h"
 
 namespace OCC {
 
@@ -25,6 +28,7 @@ class EditLocallyJob;
 using EditLocallyJobPtr = QSharedPointer<EditLocallyJob>;
 
 class Folder;
+class SyncEngine;
 class SyncResult;
 
 class EditLocallyJob : public QObject
@@ -71,10 +75,11 @@ private slots:
     void slotDirectoryListingIterated(const QString &name, const QMap<QString, QString> &properties);
 
     void processLocalItem();
+    void processLocalRecord(const OCC::SyncJournalFileRecord &rec);
     void openFile();
-    void lockFile();
+    void lockFile(const OCC::SyncJournalFileRecord &rec);
 
-    void fileAlreadyLocked();
+    void fileAlreadyLocked(const OCC::SyncJournalFileRecord &rec);
     void fileLockSuccess(const OCC::SyncFileItemPtr &item);
     void fileLockError(const QString &errorMessage);
     void fileLockProcedureComplete(const QString &notificationTitle,
@@ -83,7 +88,8 @@ private slots:
     void disconnectFolderSignals();
 
 private:
-    [[nodiscard]] bool checkIfFileParentSyncIsNeeded(); // returns true if sync will be needed, false otherwise
+    // returns true if sync will be needed, false otherwise
+    [[nodiscard]] bool checkIfFileParentSyncIsNeeded(const SyncJournalFileRecord &parentRecord, const SyncJournalFileRecord &fileRecord);
     [[nodiscard]] bool eraseBlacklistRecordForItem();
     [[nodiscard]] const QString getRelativePathToRemoteRootForFile() const; // returns either '/' or a (relative path - Folder::remotePath()) for folders pointing to a non-root remote path e.g. '/subfolder' instead of '/'
     [[nodiscard]] const QString getRelativePathParent() const;
@@ -94,8 +100,6 @@ private:
 
     bool _tokenVerified = false;
 
-    bool _shouldScheduleFolderSyncAfterFileIsOpened = false;
-
     AccountStatePtr _accountState;
     QString _userId;
     QString _relPath; // full remote path for a file (as on the server)
@@ -108,7 +112,8 @@ private:
     QString _localFilePath;
     QString _folderRelativePath;
     Folder *_folderForFile = nullptr;
-    QMetaObject::Connection _syncTerminatedConnection = {};
+    QPointer<SyncEngine> _singleItemSyncEngine;
+    QElapsedTimer _timeSinceRequest;
     QVector<QMetaObject::Connection> _folderConnections;
 };
 
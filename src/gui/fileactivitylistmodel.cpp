@@ -78,8 +78,11 @@ void FileActivityListModel::startFetchJob()
 
     const QString url(QStringLiteral("ocs/v2.php/apps/activity/api/v2/activity/filter"));
     auto job = new JsonApiJob(accountState()->account(), url, this);
-    QObject::connect(job, &JsonApiJob::jsonReceived,
-        this, &FileActivityListModel::activitiesReceived);
+    job->setDecoder([account = Activity::AccountDetails::fromAccount(accountState()->account())](const QJsonDocument &json) {
+        return QVariant::fromValue(activitiesFromJson(json, account));
+    });
+    QObject::connect(job, &JsonApiJob::jsonDecoded,
+        this, &FileActivityListModel::activitiesDecoded);
 
     QUrlQuery params;
     params.addQueryItem(QStringLiteral("sort"), QStringLiteral("asc"));
@@ -157,6 +157,7 @@ Folder::~Folder()
         _vfs->stop();
 
     // Reset then engine first as it will abort and try to access members of the Folder
+    qDeleteAll(findChildren<SyncEngine *>(QString(), Qt::FindDirectChildrenOnly));
     _engine.reset();
 }
 
@@ -1021,11 +1022,6 @@ void Folder::startSync(const QStringList &pathList)
 {
     Q_UNUSED(pathList);
     setSilenceErrorsUntilNextSync(false);
-    const auto singleItemDiscoveryOptions = _engine->singleItemDiscoveryOptions();
-    Q_ASSERT(!singleItemDiscoveryOptions.discoveryDirItem || singleItemDiscoveryOptions.discoveryDirItem->isDirectory());
-    if (singleItemDiscoveryOptions.discoveryDirItem && !singleItemDiscoveryOptions.discoveryDirItem->isDirectory()) {
-        qCCritical(lcFolder) << "startSync only accepts directory SyncFileItem, not a file.";
-    }
     if (isBusy()) {
         qCCritical(lcFolder) << "ERROR csync is still running and new sync requested.";
         return;
@@ -1057,15 +1053,32 @@ void Folder::startSync(const QStringList &pathList)
         }
         return interval;
     }();
+    // Periodic full local discoveries of folders with more records than this are
+    // spread over several sync runs, a non-positive value disables that
+    static qint64 fullLocalDiscoverySliceSize = []() {
+        qint64 sliceSize = 100000;
+        QByteArray env = qgetenv("OWNCLOUD_FULL_LOCAL_DISCOVERY_SLICE_SIZE");
+        if (!env.isEmpty()) {
+            sliceSize = env.toLongLong();
+        }
+        return sliceSize;
+    }();
     bool hasDoneFullLocalDiscovery = _timeSinceLastFullLocalDiscovery.isValid();
     bool periodicFullLocalDiscoveryNow =
         fullLocalDiscoveryInterval.count() >= 0 // negative means we don't require periodic full runs
         && _timeSinceLastFullLocalDiscovery.hasExpired(fullLocalDiscoveryInterval.count());
 
-    if (singleItemDiscoveryOptions.isValid() && singleItemDiscoveryOptions.discoveryPath != QStringLiteral("/")) {
-        qCInfo(lcFolder) << "Going to sync just one file";
-        _engine->setLocalDiscoveryOptions(LocalDiscoveryStyle::DatabaseAndFilesystem, {singleItemDiscoveryOptions.discoveryPath});
-        _localDiscoveryTracker->startSyncPartialDiscovery();
+    if (_folderWatcher && _folderWatcher->isReliable()
+        && hasDoneFullLocalDiscovery
+        && periodicFullLocalDiscoveryNow
+        && fullLocalDiscoverySliceSize > 0
+        && (_localDiscoveryTracker->hasFullDiscoverySlices()
+            || _localDiscoveryTracker->planFullDiscoverySlices(_journal, fullLocalDiscoverySliceSize))) {
+        qCInfo(lcFolder) << "Rediscovering the next slice of the local files";
+        _engine->setLocalDiscoveryOptions(
+            LocalDiscoveryStyle::DatabaseAndFilesystem,
+            _localDiscoveryTracker->fullDiscoverySlicePaths());
+        _localDiscoveryTracker->startSyncFullDiscoverySlice();
     } else if (_folderWatcher && _folderWatcher->isReliable()
         && hasDoneFullLocalDiscovery
         && !periodicFullLocalDiscoveryNow) {
@@ -1089,6 +1102,40 @@ void Folder::startSync(const QStringList &pathList)
     emit syncStarted();
 }
 
+SyncEngine *Folder::startSingleItemSync(const QString &discoveryPath, const QString &filePathRelative, const SyncFileItemPtr &discoveryDirItem)
+{
+    const auto options = initializeSyncOptions();
+
+    const auto engine = new SyncEngine(_accountState->account(), path(), options, remotePath(), &_journal);
+    engine->setParent(this);
+    engine->setIgnoreHiddenFiles(_definition.ignoreHiddenFiles);
+    ConfigFile::setupDefaultExcludeFilePaths(engine->excludedFiles());
+    if (!engine->excludedFiles().reloadExcludeFiles()) {
+        qCWarning(lcFolder, "Could not read system exclude file");
+    }
+
+    engine->setSingleItemDiscoveryOptions({discoveryPath, filePathRelative, discoveryDirItem});
+    if (discoveryPath != QStringLiteral("/")) {
+        engine->setLocalDiscoveryOptions(LocalDiscoveryStyle::DatabaseAndFilesystem, {discoveryPath});
+    } else {
+        engine->setLocalDiscoveryOptions(LocalDiscoveryStyle::FilesystemOnly);
+    }
+
+    connect(&engine->syncFileStatusTracker(), &SyncFileStatusTracker::fileStatusChanged,
+            _vfs.data(), &Vfs::fileStatusChanged);
+    connect(engine, &SyncEngine::itemCompleted, this, [this](const SyncFileItemPtr &item, ErrorCategory errorCategory) {
+        if (item->_instruction != CSYNC_INSTRUCTION_NONE && item->_instruction != CSYNC_INSTRUCTION_UPDATE_METADATA) {
+            emit ProgressDispatcher::instance()->itemCompleted(alias(), CompletedSyncItem::create(*item, errorCategory));
+        }
+    });
+    connect(engine, &SyncEngine::addErrorToGui, this, &Folder::slotAddErrorToGui);
+    connect(engine, &SyncEngine::finished, engine, &QObject::deleteLater);
+
+    qCInfo(lcFolder) << "Going to sync just" << filePathRelative << "next to the sync of the folder";
+    QMetaObject::invokeMethod(engine, "startSync", Qt::QueuedConnection);
+    return engine;
+}
+
 void Folder::correctPlaceholderFiles()
 {
     if (_definition.virtualFilesMode == Vfs::Off) {
@@ -1213,8 +1260,12 @@ void Folder::slotSyncFinished(bool success)
     if ((_syncResult.status() == SyncResult::Success
             || _syncResult.status() == SyncResult::Problem)
         && success) {
-        if (_engine->lastLocalDiscoveryStyle() == LocalDiscoveryStyle::FilesystemOnly) {
+        if (_engine->lastLocalDiscoveryStyle() == LocalDiscoveryStyle::FilesystemOnly
+            || _localDiscoveryTracker->lastSyncCompletedFullDiscovery()) {
             _timeSinceLastFullLocalDiscovery.start();
+        } else if (_localDiscoveryTracker->hasFullDiscoverySlices()) {
+            // Go on with the next slice of the full local discovery
+            scheduleThisFolderSoon();
         }
     }
 
@@ -1290,8 +1341,9 @@ void Folder::slotItemCompleted(const SyncFileItemPtr &item, ErrorCategory errorC
 
     _syncResult.processCompletedItem(item);
 
-    _fileLog->logItem(*item);
-    emit ProgressDispatcher::instance()->itemCompleted(alias(), item, errorCategory);
+    const auto completedItem = CompletedSyncItem::create(*item, errorCategory);
+    _fileLog->logItem(completedItem);
+    emit ProgressDispatcher::instance()->itemCompleted(alias(), completedItem);
 }
 
 void Folder::slotNewBigFolderDiscovered(const QString &newF, bool isExternal)
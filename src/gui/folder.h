@@ -20,6 +20,7 @@
 #include "syncresult.h"
 #include "progressdispatcher.h"
 #include "common/syncjournaldb.h"
+#include "common/syncjournalreader.h"
 #include "networkjobs.h"
 #include "syncoptions.h"
 
@@ -222,7 +223,18 @@ public:
 
     // Used by the Socket API
     SyncJournalDb *journalDb() { return &_journal; }
+    /// For journal lookups of the GUI that shouldn't wait for the sync engine
+    SyncJournalReader *journalReader() { return &_journalReader; }
     SyncEngine &syncEngine() { return *_engine; }
+
+    /**
+     * Syncs just one item, and the folders leading to it, on a sync engine
+     * of its own sharing the journal: unlike startSync() it does not have to
+     * wait for a running sync of the folder.
+     *
+     * The engine is started soon after and deletes itself once finished.
+     */
+    SyncEngine *startSingleItemSync(const QString &discoveryPath, const QString &filePathRelative, const SyncFileItemPtr &discoveryDirItem);
     Vfs &vfs() { return *_vfs; }
 
     RequestEtagJob *etagJob() { return _requestEtagJob; }
@@ -518,6 +530,7 @@ private:
     int _consecutiveFollowUpSyncs = 0;
 
     mutable SyncJournalDb _journal;
+    SyncJournalReader _journalReader{&_journal};
 
     QScopedPointer<SyncRunFileLog> _fileLog;
 
@@ -22,6 +22,7 @@
 #include <theme.h>
 
 #include <QFileIconProvider>
+#include <QFutureWatcher>
 #include <QVarLengthArray>
 #include <set>
 
@@ -614,6 +615,7 @@ void FolderStatusModel::fetchMore(const QModelIndex &parent)
     const auto job = new LsColJob(_accountState->account(), path);
     info->_fetchingJob = job;
     auto props = QList<QByteArray>() << "resourcetype"
+                                     << "getetag"
                                      << "http://owncloud.org/ns:size"
                                      << "http://owncloud.org/ns:permissions"
                                      << "http://owncloud.org/ns:fileid";
@@ -621,6 +623,8 @@ void FolderStatusModel::fetchMore(const QModelIndex &parent)
         props << "http://nextcloud.org/ns:is-encrypted";
     }
     job->setProperties(props);
+    // Only subfolders are shown, the listings of the last sync do
+    job->setCachedListingAllowed(true);
 
     job->setTimeout(60 * 1000);
     connect(job, &LsColJob::directoryListingSubfolders,
@@ -679,6 +683,21 @@ void FolderStatusModel::slotGatherEncryptionStatus(const QString &href, const QM
     job->setProperty(propertyEncryptionMap, encryptionMap);
 }
 
+struct FolderStatusModel::DirectoryListing
+{
+    QStringList subfolders; // sorted, without the parent item
+    QVariantMap permissionMap;
+    QVariantMap encryptionMap;
+    QHash<QString, ExtraFolderInfo> folderInfos;
+    bool needsBlackList = false;
+
+    // looked up in the journal
+    bool journalOk = true;
+    QStringList selectiveSyncBlackList;
+    QStringList selectiveSyncUndecidedList;
+    QHash<QString, SyncJournalFileRecord> recordsByMangledName;
+};
+
 void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
 {
     const auto job = qobject_cast<LsColJob *>(sender());
@@ -691,6 +710,69 @@ void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
     ASSERT(parentInfo->_fetchingJob == job);
     ASSERT(parentInfo->_subs.isEmpty());
 
+    parentInfo->_lastErrorString.clear();
+    parentInfo->_fetchingJob = nullptr;
+    parentInfo->_fetched = true;
+
+    DirectoryListing listing;
+    listing.subfolders = list;
+    if (!listing.subfolders.isEmpty()) {
+        listing.subfolders.removeFirst(); // skip the parent item (first in the list)
+    }
+    Utility::sortFilenames(listing.subfolders);
+    listing.permissionMap = job->property(propertyPermissionMap).toMap();
+    listing.encryptionMap = job->property(propertyEncryptionMap).toMap();
+    listing.folderInfos = job->_folderInfos;
+    listing.needsBlackList = parentInfo->_checked == Qt::PartiallyChecked;
+
+    const auto pathToRemove = Utility::trailingSlashPath(parentInfo->_folder->remoteUrl().path());
+
+    // The sync engine may hold the journal, don't wait for it on the GUI thread
+    const auto watcher = new QFutureWatcher<DirectoryListing>(this);
+    parentInfo->_journalLookup = watcher;
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, parentIdx] {
+        watcher->deleteLater();
+        const auto parentInfo = infoForIndex(parentIdx);
+        if (!parentInfo || parentInfo->_journalLookup != watcher) {
+            // reset while the journal was busy
+            return;
+        }
+        parentInfo->_journalLookup.clear();
+        applyDirectoryListing(parentIdx, watcher->result());
+    });
+    watcher->setFuture(parentInfo->_folder->journalReader()->run([listing, pathToRemove](SyncJournalDb &journal) {
+        auto result = listing;
+        auto ok1 = true;
+        auto ok2 = true;
+        if (result.needsBlackList) {
+            result.selectiveSyncBlackList = journal.getSelectiveSyncList(SyncJournalDb::SelectiveSyncBlackList, &ok1);
+        }
+        result.selectiveSyncUndecidedList = journal.getSelectiveSyncList(SyncJournalDb::SelectiveSyncUndecidedList, &ok2);
+        result.journalOk = ok1 && ok2;
+        if (!result.journalOk) {
+            return result;
+        }
+
+        for (const auto &path : qAsConst(result.subfolders)) {
+            const auto mangledName = removeTrailingSlash(path.mid(pathToRemove.size()));
+            SyncJournalFileRecord rec;
+            if (!journal.getFileRecordByE2eMangledName(mangledName, &rec)) {
+                qCWarning(lcFolderStatus) << "Could not get file record by E2E Mangled Name from local DB" << mangledName;
+            }
+            if (rec.isValid()) {
+                result.recordsByMangledName.insert(mangledName, rec);
+            }
+        }
+        return result;
+    }));
+}
+
+void FolderStatusModel::applyDirectoryListing(const QPersistentModelIndex &parentIdx, const DirectoryListing &listing)
+{
+    const auto parentInfo = infoForIndex(parentIdx);
+    ASSERT(parentInfo);
+    ASSERT(parentInfo->_subs.isEmpty());
+
     if (parentInfo->hasLabel()) {
         beginRemoveRows(parentIdx, 0, 0);
         parentInfo->_hasError = false;
@@ -698,25 +780,16 @@ void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
         endRemoveRows();
     }
 
-    parentInfo->_lastErrorString.clear();
-    parentInfo->_fetchingJob = nullptr;
-    parentInfo->_fetched = true;
+    if (!listing.journalOk) {
+        qCWarning(lcFolderStatus) << "Could not retrieve selective sync info from journal";
+        return;
+    }
 
     const auto url = parentInfo->_folder->remoteUrl();
     const auto pathToRemove = Utility::trailingSlashPath(url.path());
 
-    QStringList selectiveSyncBlackList;
-    auto ok1 = true;
-    auto ok2 = true;
-    if (parentInfo->_checked == Qt::PartiallyChecked) {
-        selectiveSyncBlackList = parentInfo->_folder->journalDb()->getSelectiveSyncList(SyncJournalDb::SelectiveSyncBlackList, &ok1);
-    }
-    auto selectiveSyncUndecidedList = parentInfo->_folder->journalDb()->getSelectiveSyncList(SyncJournalDb::SelectiveSyncUndecidedList, &ok2);
-
-    if (!(ok1 && ok2)) {
-        qCWarning(lcFolderStatus) << "Could not retrieve selective sync info from journal";
-        return;
-    }
+    const auto &selectiveSyncBlackList = listing.selectiveSyncBlackList;
+    auto selectiveSyncUndecidedList = listing.selectiveSyncUndecidedList;
 
     std::set<QString> selectiveSyncUndecidedSet; // not QSet because it's not sorted
     for (const auto &str : selectiveSyncUndecidedList) {
@@ -724,20 +797,14 @@ void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
             selectiveSyncUndecidedSet.insert(str);
         }
     }
-    const auto permissionMap = job->property(propertyPermissionMap).toMap();
-    const auto encryptionMap = job->property(propertyEncryptionMap).toMap();
-
-    auto sortedSubfolders = list;
-    if (!sortedSubfolders.isEmpty()) {
-        sortedSubfolders.removeFirst(); // skip the parent item (first in the list)
-    }
-    Utility::sortFilenames(sortedSubfolders);
+    const auto &permissionMap = listing.permissionMap;
+    const auto &encryptionMap = listing.encryptionMap;
 
     QVarLengthArray<int, 10> undecidedIndexes;
 
     QVector<SubFolderInfo> newSubs;
-    newSubs.reserve(sortedSubfolders.size());
-    for (const auto &path : sortedSubfolders) {
+    newSubs.reserve(listing.subfolders.size());
+    for (const auto &path : listing.subfolders) {
         auto relativePath = path.mid(pathToRemove.size());
         if (parentInfo->_folder->isFileExcludedRelative(relativePath)) {
             continue;
@@ -756,10 +823,7 @@ void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
             && !_accountState->account()->e2e()->_publicKey.isNull()
             && _accountState->account()->e2e()->_privateKey.isNull();
 
-        SyncJournalFileRecord rec;
-        if (!parentInfo->_folder->journalDb()->getFileRecordByE2eMangledName(removeTrailingSlash(relativePath), &rec)) {
-            qCWarning(lcFolderStatus) << "Could not get file record by E2E Mangled Name from local DB" << removeTrailingSlash(relativePath);
-        }
+        const auto rec = listing.recordsByMangledName.value(removeTrailingSlash(relativePath));
         if (rec.isValid()) {
             newInfo._name = removeTrailingSlash(rec._path).split('/').last();
             if (rec.isE2eEncrypted() && !rec._e2eMangledName.isEmpty()) {
@@ -775,7 +839,7 @@ void FolderStatusModel::slotUpdateDirectories(const QStringList &list)
             newInfo._name = removeTrailingSlash(relativePath).split('/').last();
         }
 
-        const auto &folderInfo = job->_folderInfos.value(path);
+        const auto &folderInfo = listing.folderInfos.value(path);
         newInfo._size = folderInfo.size;
         newInfo._fileId = folderInfo.fileId;
         if (relativePath.isEmpty()) {
@@ -1348,6 +1412,10 @@ void FolderStatusModel::SubFolderInfo::resetSubs(FolderStatusModel *model, QMode
         _fetchingJob->deleteLater();
         _fetchingJob.clear();
     }
+    if (_journalLookup) {
+        _journalLookup->deleteLater();
+        _journalLookup.clear();
+    }
     if (hasLabel()) {
         model->beginRemoveRows(index, 0, 0);
         _fetchingLabel = false;
@@ -71,6 +71,7 @@ public:
 
         bool _fetched = false; // If we did the LSCOL for this folder already
         QPointer<LsColJob> _fetchingJob; // Currently running LsColJob
+        QPointer<QObject> _journalLookup; // Running journal lookup of the fetched subfolders
         bool _hasError = false; // If the last fetching job ended in an error
         QString _lastErrorString;
         bool _fetchingLabel = false; // Whether a 'fetching in progress' label is shown.
@@ -147,6 +148,9 @@ private slots:
     void slotShowFetchProgress();
 
 private:
+    struct DirectoryListing;
+    void applyDirectoryListing(const QPersistentModelIndex &parentIdx, const DirectoryListing &listing);
+
     [[nodiscard]] QStringList createBlackList(const OCC::FolderStatusModel::SubFolderInfo &root,
         const QStringList &oldBlackList) const;
     const AccountState *_accountState = nullptr;
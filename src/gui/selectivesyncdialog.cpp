@@ -109,6 +109,7 @@ void SelectiveSyncWidget::refreshFolders()
 
     auto *job = new LsColJob(_account, _folderPath);
     auto props = QList<QByteArray>() << "resourcetype"
+                                     << "getetag"
                                      << "http://owncloud.org/ns:size";
     if (_account->capabilities().clientSideEncryptionAvailable()) {
         props << "http://nextcloud.org/ns:is-encrypted";
@@ -338,7 +339,9 @@ void SelectiveSyncWidget::slotItemExpanded(QTreeWidgetItem *item)
     }
     auto *job = new LsColJob(_account, prefix + dir);
     job->setProperties(QList<QByteArray>() << "resourcetype"
+                                           << "getetag"
                                            << "http://owncloud.org/ns:size");
+    job->setCachedListingAllowed(true);
     connect(job, &LsColJob::directoryListingSubfolders,
         this, &SelectiveSyncWidget::slotUpdateDirectories);
     job->start();
@@ -59,6 +59,7 @@
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QFileDialog>
+#include <QFutureWatcher>
 
 
 #include <QAction>
@@ -1020,24 +1021,32 @@ void SocketApi::command_RESOLVE_CONFLICT(const QString &localFile, SocketListene
     if (!fileData.folder || !Utility::isConflictFile(fileData.folderRelativePath))
         return; // should not have shown menu item
 
-    const auto conflictedRelativePath = fileData.folderRelativePath;
-    const auto baseRelativePath = fileData.folder->journalDb()->conflictFileBaseName(fileData.folderRelativePath.toUtf8());
+    // The sync engine may hold the journal, don't wait for it on the GUI thread
+    const auto watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, folder = QPointer<Folder>(fileData.folder), conflictedRelativePath = fileData.folderRelativePath] {
+        watcher->deleteLater();
+        if (!folder) {
+            return;
+        }
+        const auto baseRelativePath = watcher->result();
 
-    const auto dir = QDir(fileData.folder->path());
-    const auto conflictedPath = dir.filePath(conflictedRelativePath);
-    const auto basePath = dir.filePath(baseRelativePath);
+        const auto dir = QDir(folder->path());
+        const auto conflictedPath = dir.filePath(conflictedRelativePath);
+        const auto basePath = dir.filePath(baseRelativePath);
 
-    const auto baseName = QFileInfo(basePath).fileName();
+        const auto baseName = QFileInfo(basePath).fileName();
 
 #ifndef OWNCLOUD_TEST
-    ConflictDialog dialog;
-    dialog.setBaseFilename(baseName);
-    dialog.setLocalVersionFilename(conflictedPath);
-    dialog.setRemoteVersionFilename(basePath);
-    if (dialog.exec() == ConflictDialog::Accepted) {
-        fileData.folder->scheduleThisFolderSoon();
-    }
+        ConflictDialog dialog;
+        dialog.setBaseFilename(baseName);
+        dialog.setLocalVersionFilename(conflictedPath);
+        dialog.setRemoteVersionFilename(basePath);
+        if (dialog.exec() == ConflictDialog::Accepted) {
+            folder->scheduleThisFolderSoon();
+        }
 #endif
+    });
+    watcher->setFuture(fileData.folder->journalReader()->conflictFileBaseName(fileData.folderRelativePath.toUtf8()));
 }
 
 void SocketApi::command_DELETE_ITEM(const QString &localFile, SocketListener *)
@@ -1054,35 +1063,51 @@ void SocketApi::command_MOVE_ITEM(const QString &localFile, SocketListener *)
     if (!fileData.folder)
         return; // should not have shown menu item
 
-    QString defaultDirAndName = fileData.folderRelativePath;
+    // The sync engine may hold the journal, look up the base name and the parent off the GUI thread
+    const auto watcher = new QFutureWatcher<QPair<QString, SyncJournalFileRecord>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, folder = QPointer<Folder>(fileData.folder), localFile] {
+        watcher->deleteLater();
+        if (!folder) {
+            return;
+        }
+        auto [defaultDirAndName, parentRecord] = watcher->result();
 
-    // If it's a conflict, we want to save it under the base name by default
-    if (Utility::isConflictFile(defaultDirAndName)) {
-        defaultDirAndName = fileData.folder->journalDb()->conflictFileBaseName(fileData.folderRelativePath.toUtf8());
-    }
+        // If the parent doesn't accept new files, go to the root of the sync folder
+        QFileInfo fileInfo(localFile);
+        if ((fileInfo.isFile() && !parentRecord._remotePerm.hasPermission(RemotePermissions::CanAddFile))
+            || (fileInfo.isDir() && !parentRecord._remotePerm.hasPermission(RemotePermissions::CanAddSubDirectories))) {
+            defaultDirAndName = QFileInfo(defaultDirAndName).fileName();
+        }
 
-    // If the parent doesn't accept new files, go to the root of the sync folder
-    QFileInfo fileInfo(localFile);
-    const auto parentRecord = parentDir.journalRecord();
-    if ((fileInfo.isFile() && !parentRecord._remotePerm.hasPermission(RemotePermissions::CanAddFile))
-        || (fileInfo.isDir() && !parentRecord._remotePerm.hasPermission(RemotePermissions::CanAddSubDirectories))) {
-        defaultDirAndName = QFileInfo(defaultDirAndName).fileName();
-    }
+        // Add back the folder path
+        defaultDirAndName = QDir(folder->path()).filePath(defaultDirAndName);
 
-    // Add back the folder path
-    defaultDirAndName = QDir(fileData.folder->path()).filePath(defaultDirAndName);
+        const auto target = QFileDialog::getSaveFileName(
+            nullptr,
+            tr("Select new location …"),
+            defaultDirAndName,
+            QString(), nullptr, QFileDialog::HideNameFilterDetails);
+        if (target.isEmpty())
+            return;
 
-    const auto target = QFileDialog::getSaveFileName(
-        nullptr,
-        tr("Select new location …"),
-        defaultDirAndName,
-        QString(), nullptr, QFileDialog::HideNameFilterDetails);
-    if (target.isEmpty())
-        return;
+        ConflictSolver solver;
+        solver.setLocalVersionFilename(localFile);
+        solver.setRemoteVersionFilename(target);
+    });
+    watcher->setFuture(fileData.folder->journalReader()->run([relativePath = fileData.folderRelativePath, parentPath = parentDir.folderRelativePath](SyncJournalDb &journal) {
+        QString defaultDirAndName = relativePath;
 
-    ConflictSolver solver;
-    solver.setLocalVersionFilename(localFile);
-    solver.setRemoteVersionFilename(target);
+        // If it's a conflict, we want to save it under the base name by default
+        if (Utility::isConflictFile(defaultDirAndName)) {
+            defaultDirAndName = journal.conflictFileBaseName(relativePath.toUtf8());
+        }
+
+        SyncJournalFileRecord parentRecord;
+        if (!journal.getFileRecord(parentPath, &parentRecord)) {
+            qCWarning(lcSocketApi) << "Failed to get journal record for path" << parentPath;
+        }
+        return qMakePair(defaultDirAndName, parentRecord);
+    }));
 }
 
 void SocketApi::command_LOCK_FILE(const QString &localFile, SocketListener *listener)
@@ -1247,8 +1272,8 @@ void SocketApi::sendEncryptFolderCommandMenuEntries(const QFileInfo &fileInfo,
 
     bool anyAncestorEncrypted = false;
     auto ancestor = fileData.parentFolder();
-    while (ancestor.journalRecord().isValid()) {
-        if (ancestor.journalRecord().isE2eEncrypted()) {
+    for (auto ancestorRecord = ancestor.journalRecord(); ancestorRecord.isValid(); ancestorRecord = ancestor.journalRecord()) {
+        if (ancestorRecord.isE2eEncrypted()) {
             anyAncestorEncrypted = true;
             break;
         }
@@ -1380,8 +1405,8 @@ void SocketApi::command_GET_MENU_ITEMS(const QString &argument, OCC::SocketListe
         FileData fileData = FileData::get(argument);
         const auto record = fileData.journalRecord();
         const bool isOnTheServer = record.isValid();
-        const auto isE2eEncryptedPath = fileData.journalRecord().isE2eEncrypted() || !fileData.journalRecord()._e2eMangledName.isEmpty();
-        const auto isE2eEncryptedRootFolder = fileData.journalRecord().isE2eEncrypted() && fileData.journalRecord()._e2eMangledName.isEmpty();
+        const auto isE2eEncryptedPath = record.isE2eEncrypted() || !record._e2eMangledName.isEmpty();
+        const auto isE2eEncryptedRootFolder = record.isE2eEncrypted() && record._e2eMangledName.isEmpty();
         auto flagString = isOnTheServer && !isE2eEncryptedPath ? QLatin1String("::") : QLatin1String(":d:");
 
         const QFileInfo fileInfo(fileData.localPath);
@@ -1451,33 +1476,12 @@ void SocketApi::command_GET_MENU_ITEMS(const QString &argument, OCC::SocketListe
         ENFORCE(!files.isEmpty());
 
         // Determine the combined availability status of the files
-        auto combined = Optional<VfsItemAvailability>();
-        auto merge = [](VfsItemAvailability lhs, VfsItemAvailability rhs) {
-            if (lhs == rhs)
-                return lhs;
-            if (int(lhs) > int(rhs))
-                std::swap(lhs, rhs); // reduce cases ensuring lhs < rhs
-            if (lhs == VfsItemAvailability::AlwaysLocal && rhs == VfsItemAvailability::AllHydrated)
-                return VfsItemAvailability::AllHydrated;
-            if (lhs == VfsItemAvailability::AllDehydrated && rhs == VfsItemAvailability::OnlineOnly)
-                return VfsItemAvailability::AllDehydrated;
-            return VfsItemAvailability::Mixed;
-        };
+        QStringList folderRelativePaths;
+        folderRelativePaths.reserve(files.size());
         for (const auto &file : files) {
-            auto fileData = FileData::get(file);
-            auto availability = syncFolder->vfs().availability(fileData.folderRelativePath);
-            if (!availability) {
-                if (availability.error() == Vfs::AvailabilityError::DbError)
-                    availability = VfsItemAvailability::Mixed;
-                if (availability.error() == Vfs::AvailabilityError::NoSuchItem)
-                    continue;
-            }
-            if (!combined) {
-                combined = *availability;
-            } else {
-                combined = merge(*combined, *availability);
-            }
+            folderRelativePaths.append(FileData::get(file).folderRelativePath);
         }
+        const auto combined = syncFolder->vfs().combinedAvailability(folderRelativePaths);
 
         // TODO: Should be a submenu, should use icons
         auto makePinContextMenu = [&](bool makeAvailableLocally, bool freeSpace) {
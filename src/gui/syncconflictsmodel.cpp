@@ -16,6 +16,7 @@
 
 #include "folderman.h"
 
+#include <QFutureWatcher>
 #include <QLoggingCategory>
 
 namespace OCC {
@@ -174,18 +175,56 @@ bool SyncConflictsModel::allConflictingSelected() const
 
 void SyncConflictsModel::setConflictActivities(ActivityList conflicts)
 {
+    const auto generation = ++_conflictsGeneration;
     if (_data == conflicts) {
         return;
     }
 
-    beginResetModel();
+    QHash<QString, QVector<QByteArray>> conflictNamesPerFolder;
+    for (const auto &conflict : qAsConst(conflicts)) {
+        conflictNamesPerFolder[conflict._folder].append(conflict._file.toUtf8());
+    }
+
+    const auto baseNames = QSharedPointer<QHash<QString, QHash<QByteArray, QByteArray>>>::create();
+    const auto pendingLookups = QSharedPointer<int>::create(0);
+    const auto applyConflicts = [this, generation, conflicts, baseNames] {
+        if (generation != _conflictsGeneration) {
+            return;
+        }
+
+        beginResetModel();
 
-    _data = conflicts;
-    emit conflictActivitiesChanged();
+        _data = conflicts;
+        emit conflictActivitiesChanged();
 
-    updateConflictsData();
+        updateConflictsData(*baseNames);
 
-    endResetModel();
+        endResetModel();
+    };
+
+    // The base names come from the journals, which the sync engine may be busy with
+    for (auto it = conflictNamesPerFolder.cbegin(); it != conflictNamesPerFolder.cend(); ++it) {
+        const auto folder = FolderMan::instance()->folder(it.key());
+        if (!folder) {
+            continue;
+        }
+
+        const auto folderAlias = it.key();
+        const auto watcher = new QFutureWatcher<QHash<QByteArray, QByteArray>>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [watcher, folderAlias, baseNames, pendingLookups, applyConflicts] {
+            baseNames->insert(folderAlias, watcher->result());
+            watcher->deleteLater();
+            if (--*pendingLookups == 0) {
+                applyConflicts();
+            }
+        });
+        ++*pendingLookups;
+        watcher->setFuture(folder->journalReader()->conflictFileBaseNames(it.value()));
+    }
+
+    if (*pendingLookups == 0) {
+        applyConflicts();
+    }
 }
 
 void SyncConflictsModel::selectAllExisting(bool selected)
@@ -235,7 +274,7 @@ void SyncConflictsModel::applySolution()
     }
 }
 
-void SyncConflictsModel::updateConflictsData()
+void SyncConflictsModel::updateConflictsData(const QHash<QString, QHash<QByteArray, QByteArray>> &baseNames)
 {
     _conflictData.clear();
     _conflictData.reserve(_data.size());
@@ -249,7 +288,7 @@ void SyncConflictsModel::updateConflictsData()
         }
 
         const auto conflictedRelativePath = oneConflict._file;
-        const auto baseRelativePath = folder->journalDb() ? folder->journalDb()->conflictFileBaseName(conflictedRelativePath.toUtf8()) : QString{};
+        const auto baseRelativePath = QString::fromUtf8(baseNames.value(oneConflict._folder).value(conflictedRelativePath.toUtf8()));
 
         const auto dir = QDir(folder->path());
         const auto conflictedPath = dir.filePath(conflictedRelativePath);
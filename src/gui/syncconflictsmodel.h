@@ -107,7 +107,8 @@ signals:
     void allConflictingSelectedChanged();
 
 private:
-    void updateConflictsData();
+    /// baseNames are keyed by folder alias and conflict file
+    void updateConflictsData(const QHash<QString, QHash<QByteArray, QByteArray>> &baseNames);
 
     void setExistingSelected(bool value,
                              const QModelIndex &index,
@@ -121,6 +122,9 @@ private:
 
     QVector<ConflictInfo> _conflictData;
 
+    /// Counts setConflictActivities() calls, outdated journal lookups are dropped
+    quint64 _conflictsGeneration = 0;
+
     QLocale _locale;
 
     bool _allExistingsSelected = false;
@@ -12,141 +12,277 @@
  * for more details.
  */
 
-#include <QRegularExpression>
-
 #include "syncrunfilelog.h"
 #include "common/utility.h"
 #include "filesystem.h"
-#include <qfileinfo.h>
-
-namespace OCC {
 
-SyncRunFileLog::SyncRunFileLog() = default;
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTextStream>
 
-QString SyncRunFileLog::dateTimeStr(const QDateTime &dt)
-{
-    return dt.toString(Qt::ISODate);
+namespace {
+constexpr int itemBatchSize = 256;
+constexpr int itemFlushIntervalMsec = 1000;
 }
 
-void SyncRunFileLog::start(const QString &folderPath)
-{
-    const qint64 logfileMaxSize = 10 * 1024 * 1024; // 10MiB
+namespace OCC {
 
-    const QString logpath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    if(!QDir(logpath).exists()) {
-        QDir().mkdir(logpath);
+/**
+ * Owns the log file. Only ever used from the single thread of
+ * SyncRunFileLog::_writerThread, in the order the calls were queued.
+ */
+class SyncRunFileLogWriter
+{
+public:
+    explicit SyncRunFileLogWriter(bool binary)
+        : _binary(binary)
+    {
     }
 
-    int length = folderPath.split(QLatin1String("/")).length();
-    QString filenameSingle = folderPath.split(QLatin1String("/")).at(length - 2);
-    QString filename = logpath + QLatin1String("/") + filenameSingle + QLatin1String("_sync.log");
+    void open(const QString &folderPath)
+    {
+        const qint64 logfileMaxSize = 10 * 1024 * 1024; // 10MiB
 
-    int depthIndex = 2;
-    while(QFile::exists(filename)) {
+        const auto filename = logFileName(folderPath);
 
-        QFile file(filename);
-        file.open(QIODevice::ReadOnly| QIODevice::Text);
-        QTextStream in(&file);
-        QString line = in.readLine();
-
-        if(QString::compare(folderPath,line,Qt::CaseSensitive)!=0) {
-            depthIndex++;
-            if(depthIndex <= length) {
-                filenameSingle = folderPath.split(QLatin1String("/")).at(length - depthIndex) + QString("_") ///
-                        + filenameSingle;
-                filename = logpath+ QLatin1String("/") + filenameSingle + QLatin1String("_sync.log");
+        // When the file is too big, just rename it to an old name.
+        QFileInfo info(filename);
+        bool exists = info.exists();
+        if (exists && info.size() > logfileMaxSize) {
+            exists = false;
+            QString newFilename = filename + QLatin1String(".1");
+            QFile::remove(newFilename);
+            QFile::rename(filename, newFilename);
+        }
+
+        _file.close();
+        _file.setFileName(filename);
+        if (_binary) {
+            // records are collected here and appended compressed on flush()
+            _pending.close();
+            _pending.setData(QByteArray());
+            _data.setDevice(&_pending);
+            _data.setVersion(SyncRunLogFormat::streamVersion);
+            _pending.open(QIODevice::WriteOnly);
+        } else {
+            _file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+            _text.setDevice(&_file);
+        }
+
+        if (!exists) {
+            // We are creating a new file, add the note.
+            if (_binary) {
+                _pending.write(SyncRunLogFormat::binaryMagic, SyncRunLogFormat::binaryMagicSize);
             }
-            else {
-                filenameSingle = filenameSingle + QLatin1String("_1");
-                filename = logpath + QLatin1String("/") + filenameSingle + QLatin1String("_sync.log");
+            SyncRunLogFormat::Record header;
+            header.type = SyncRunLogFormat::RecordType::Header;
+            header.text = folderPath;
+            write(header);
+
+            FileSystem::setFileHidden(filename, true);
+        }
+    }
+
+    void write(const SyncRunLogFormat::Record &record)
+    {
+        if (_binary) {
+            SyncRunLogFormat::writeRecord(_data, record);
+        } else {
+            _text << SyncRunLogFormat::toText(record);
+        }
+        flush();
+    }
+
+    void writeItems(const QVector<CompletedSyncItemPtr> &items)
+    {
+        for (const auto &item : items) {
+            const auto record = SyncRunLogFormat::itemRecord(*item);
+            if (_binary) {
+                SyncRunLogFormat::writeRecord(_data, record);
+            } else {
+                _text << SyncRunLogFormat::toText(record);
             }
         }
-        else break;
+        flush();
     }
 
-    // When the file is too big, just rename it to an old name.
-    QFileInfo info(filename);
-    bool exists = info.exists();
-    if (exists && info.size() > logfileMaxSize) {
-        exists = false;
-        QString newFilename = filename + QLatin1String(".1");
-        QFile::remove(newFilename);
-        QFile::rename(filename, newFilename);
+    void close()
+    {
+        _file.close();
+        _pending.close();
     }
-    _file.reset(new QFile(filename));
 
-    _file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
-    _out.setDevice(_file.data());
+private:
+    void flush()
+    {
+        if (_binary) {
+            if (!_pending.data().isEmpty()) {
+                SyncRunLogFormat::appendToBinaryLog(_file.fileName(), _pending.data());
+                _pending.buffer().clear();
+                _pending.seek(0);
+            }
+            return;
+        }
+        _text.flush();
+        _file.flush();
+    }
+
+    [[nodiscard]] QString suffix() const
+    {
+        return _binary ? QStringLiteral("_sync.log.bin.gz") : QStringLiteral("_sync.log");
+    }
+
+    // The folder path a log file was created for, used to tell apart folders with the same name
+    [[nodiscard]] QString folderPathOfLog(const QString &filename) const
+    {
+        if (_binary) {
+            // the header is the first record, a folder path fits in the first few KiB
+            const auto data = SyncRunLogFormat::readBinaryLog(filename, 64 * 1024);
+            if (!data.startsWith(SyncRunLogFormat::binaryMagic)) {
+                return {};
+            }
+            QDataStream in(data.mid(SyncRunLogFormat::binaryMagicSize));
+            in.setVersion(SyncRunLogFormat::streamVersion);
+            SyncRunLogFormat::Record header;
+            if (!SyncRunLogFormat::readRecord(in, header) || header.type != SyncRunLogFormat::RecordType::Header) {
+                return {};
+            }
+            return header.text;
+        }
+
+        QFile file(filename);
+        file.open(QIODevice::ReadOnly | QIODevice::Text);
+        QTextStream in(&file);
+        return in.readLine();
+    }
 
+    [[nodiscard]] QString logFileName(const QString &folderPath) const
+    {
+        const QString logpath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        if(!QDir(logpath).exists()) {
+            QDir().mkdir(logpath);
+        }
 
-    if (!exists) {
-        _out << folderPath << endl;
-        // We are creating a new file, add the note.
-        _out << "# timestamp | duration | file | instruction | dir | modtime | etag | "
-                "size | fileId | status | errorString | http result code | "
-                "other size | other modtime | X-Request-ID"
-             << endl;
+        const auto pathParts = folderPath.split(QLatin1String("/"));
+        int length = pathParts.length();
+        QString filenameSingle = pathParts.at(length - 2);
+        QString filename = logpath + QLatin1String("/") + filenameSingle + suffix();
 
-        FileSystem::setFileHidden(filename, true);
+        int depthIndex = 2;
+        while(QFile::exists(filename)) {
+            if(QString::compare(folderPath, folderPathOfLog(filename), Qt::CaseSensitive) != 0) {
+                depthIndex++;
+                if(depthIndex <= length) {
+                    filenameSingle = pathParts.at(length - depthIndex) + QString("_") ///
+                            + filenameSingle;
+                    filename = logpath+ QLatin1String("/") + filenameSingle + suffix();
+                }
+                else {
+                    filenameSingle = filenameSingle + QLatin1String("_1");
+                    filename = logpath + QLatin1String("/") + filenameSingle + suffix();
+                }
+            }
+            else break;
+        }
+        return filename;
     }
 
+    bool _binary;
+    QFile _file; // only opened for the text log
+    QBuffer _pending; // binary records that weren't compressed yet
+    QTextStream _text;
+    QDataStream _data;
+};
+
+SyncRunFileLog::SyncRunFileLog()
+    : _writer(new SyncRunFileLogWriter(qEnvironmentVariableIntValue("OWNCLOUD_SYNC_RUN_LOG_BINARY") == 1 && SyncRunLogFormat::isBinaryLogSupported()))
+{
+    // a single thread keeps the writes in the order they were queued
+    _writerThread.setMaxThreadCount(1);
+
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(itemFlushIntervalMsec);
+    QObject::connect(&_flushTimer, &QTimer::timeout, [this] { flushPendingItems(); });
+}
+
+SyncRunFileLog::~SyncRunFileLog()
+{
+    flushPendingItems();
+    _writerThread.waitForDone();
+}
+
+void SyncRunFileLog::start(const QString &folderPath)
+{
+    _writerThread.start([writer = _writer, folderPath] { writer->open(folderPath); });
 
     _totalDuration.start();
     _lapDuration.start();
-    _out << "#=#=#=# Syncrun started " << dateTimeStr(QDateTime::currentDateTimeUtc()) << endl;
+
+    SyncRunLogFormat::Record record;
+    record.type = SyncRunLogFormat::RecordType::SyncStarted;
+    record.timestamp = QDateTime::currentDateTimeUtc();
+    writeRecord(record);
 }
-void SyncRunFileLog::logItem(const SyncFileItem &item)
+
+void SyncRunFileLog::logItem(const CompletedSyncItemPtr &item)
 {
-    // don't log the directory items that are in the list
-    if (item._direction == SyncFileItem::None
-        || item._instruction == CSYNC_INSTRUCTION_IGNORE) {
+    if (!SyncRunLogFormat::shouldLog(*item)) {
         return;
     }
-    QString ts = QString::fromLatin1(item._responseTimeStamp);
-    if (ts.length() > 6) {
-        static const QRegularExpression rx(R"((\d\d:\d\d:\d\d))");
-        const auto rxMatch = rx.match(ts);
-        if (rxMatch.hasMatch()) {
-            ts = rxMatch.captured(0);
-        }
-    }
 
-    const QChar L = QLatin1Char('|');
-    _out << ts << L;
-    _out << L;
-    if (item._instruction != CSYNC_INSTRUCTION_RENAME) {
-        _out << item.destination() << L;
-    } else {
-        _out << item._file << QLatin1String(" -> ") << item._renameTarget << L;
+    _pendingItems.append(item);
+    if (_pendingItems.size() >= itemBatchSize) {
+        flushPendingItems();
+    } else if (!_flushTimer.isActive()) {
+        _flushTimer.start();
     }
-    _out << item._instruction << L;
-    _out << item._direction << L;
-    _out << QString::number(item._modtime) << L;
-    _out << item._etag << L;
-    _out << QString::number(item._size) << L;
-    _out << item._fileId << L;
-    _out << item._status << L;
-    _out << item._errorString << L;
-    _out << QString::number(item._httpErrorCode) << L;
-    _out << QString::number(item._previousSize) << L;
-    _out << QString::number(item._previousModtime) << L;
-    _out << item._requestId << L;
-
-    _out << endl;
 }
 
 void SyncRunFileLog::logLap(const QString &name)
 {
-    _out << "#=#=#=#=# " << name << " " << dateTimeStr(QDateTime::currentDateTimeUtc())
-         << " (last step: " << _lapDuration.restart() << " msec"
-         << ", total: " << _totalDuration.elapsed() << " msec)" << endl;
+    SyncRunLogFormat::Record record;
+    record.type = SyncRunLogFormat::RecordType::Lap;
+    record.text = name;
+    record.timestamp = QDateTime::currentDateTimeUtc();
+    record.lapMsec = _lapDuration.restart();
+    record.totalMsec = _totalDuration.elapsed();
+    writeRecord(record);
 }
 
 void SyncRunFileLog::finish()
 {
-    _out << "#=#=#=# Syncrun finished " << dateTimeStr(QDateTime::currentDateTimeUtc())
-         << " (last step: " << _lapDuration.elapsed() << " msec"
-         << ", total: " << _totalDuration.elapsed() << " msec)" << endl;
-    _file->close();
+    SyncRunLogFormat::Record record;
+    record.type = SyncRunLogFormat::RecordType::SyncFinished;
+    record.timestamp = QDateTime::currentDateTimeUtc();
+    record.lapMsec = _lapDuration.elapsed();
+    record.totalMsec = _totalDuration.elapsed();
+    writeRecord(record);
+
+    _writerThread.start([writer = _writer] { writer->close(); });
+}
+
+void SyncRunFileLog::flushPendingItems()
+{
+    _flushTimer.stop();
+    if (_pendingItems.isEmpty()) {
+        return;
+    }
+
+    QVector<CompletedSyncItemPtr> batch;
+    batch.swap(_pendingItems);
+    _pendingItems.reserve(itemBatchSize);
+    _writerThread.start([writer = _writer, batch] { writer->writeItems(batch); });
+}
+
+void SyncRunFileLog::writeRecord(const SyncRunLogFormat::Record &record)
+{
+    // keep the record after all items that were logged before it
+    flushPendingItems();
+    _writerThread.start([writer = _writer, record] { writer->write(record); });
 }
 }
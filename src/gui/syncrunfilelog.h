@@ -15,37 +15,48 @@
 #ifndef SYNCRUNFILELOG_H
 #define SYNCRUNFILELOG_H
 
-#include <QFile>
-#include <QTextStream>
-#include <QScopedPointer>
 #include <QElapsedTimer>
-#include <QStandardPaths>
-#include <QDir>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
 
-#include "syncfileitem.h"
+#include "completedsyncitem.h"
+#include "syncrunlogformat.h"
 
 namespace OCC {
-class SyncFileItem;
+class SyncRunFileLogWriter;
 
 /**
  * @brief The SyncRunFileLog class
+ *
+ * Items are collected on the calling thread and handed over in batches to a
+ * single background thread which formats and writes them, so logging does not
+ * cost the GUI thread any formatting or disk I/O.
+ *
+ * Set OWNCLOUD_SYNC_RUN_LOG_BINARY=1 to write the compact binary format
+ * (see SyncRunLogFormat) instead of text. Builds without zlib always write text.
+ *
  * @ingroup gui
  */
 class SyncRunFileLog
 {
 public:
     SyncRunFileLog();
+    ~SyncRunFileLog();
     void start(const QString &folderPath);
-    void logItem(const SyncFileItem &item);
+    void logItem(const CompletedSyncItemPtr &item);
     void logLap(const QString &name);
     void finish();
 
-protected:
 private:
-    QString dateTimeStr(const QDateTime &dt);
+    void flushPendingItems();
+    void writeRecord(const SyncRunLogFormat::Record &record);
 
-    QScopedPointer<QFile> _file;
-    QTextStream _out;
+    QSharedPointer<SyncRunFileLogWriter> _writer;
+    QThreadPool _writerThread;
+    QVector<CompletedSyncItemPtr> _pendingItems;
+    QTimer _flushTimer;
     QElapsedTimer _totalDuration;
     QElapsedTimer _lapDuration;
 };
@@ -76,7 +76,17 @@ ActivityLink ActivityLink::createFomJsonObject(const QJsonObject &obj)
     return activityLink;
 }
 
+Activity::AccountDetails Activity::AccountDetails::fromAccount(const AccountPtr &account)
+{
+    return {account->displayName(), account->davUser(), account->url()};
+}
+
 OCC::Activity Activity::fromActivityJson(const QJsonObject &json, const AccountPtr account)
+{
+    return fromActivityJson(json, AccountDetails::fromAccount(account));
+}
+
+OCC::Activity Activity::fromActivityJson(const QJsonObject &json, const AccountDetails &account)
 {
     const auto activityUser = json.value(QStringLiteral("user")).toString();
 
@@ -87,14 +97,14 @@ OCC::Activity Activity::fromActivityJson(const QJsonObject &json, const AccountP
     activity._objectName = json.value(QStringLiteral("object_name")).toString();
     activity._id = json.value(QStringLiteral("activity_id")).toInt();
     activity._fileAction = json.value(QStringLiteral("type")).toString();
-    activity._accName = account->displayName();
+    activity._accName = account.displayName;
     activity._subject = json.value(QStringLiteral("subject")).toString();
     activity._message = json.value(QStringLiteral("message")).toString();
     activity._file = json.value(QStringLiteral("object_name")).toString();
-    activity._link = stringToUrl(account->url(), json.value(QStringLiteral("link")).toString());
+    activity._link = stringToUrl(account.url, json.value(QStringLiteral("link")).toString());
     activity._dateTime = QDateTime::fromString(json.value(QStringLiteral("datetime")).toString(), Qt::ISODate);
     activity._icon = json.value(QStringLiteral("icon")).toString();
-    activity._isCurrentUserFileActivity = activity._objectType == QStringLiteral("files") && activityUser == account->davUser();
+    activity._isCurrentUserFileActivity = activity._objectType == QStringLiteral("files") && activityUser == account.davUser;
     activity._isMultiObjectActivity = json.value("objects").toObject().count() > 1;
 
     auto richSubjectData = json.value(QStringLiteral("subject_rich")).toArray();
@@ -108,7 +118,7 @@ OCC::Activity Activity::fromActivityJson(const QJsonObject &json, const AccountP
         for (auto i = parameters.begin(); i != parameters.end(); ++i) {
             const auto parameterJsonObject = i.value().toObject();
 
-            const auto richParamLink = stringToUrl(account->url(), parameterJsonObject.value(QStringLiteral("link")).toString());
+            const auto richParamLink = stringToUrl(account.url, parameterJsonObject.value(QStringLiteral("link")).toString());
             activity._subjectRichParameters[i.key()] = QVariant::fromValue(Activity::RichSubjectParameter{
                 parameterJsonObject.value(QStringLiteral("type")).toString(),
                 parameterJsonObject.value(QStringLiteral("id")).toString(),
@@ -153,7 +163,7 @@ OCC::Activity Activity::fromActivityJson(const QJsonObject &json, const AccountP
         const auto mimeType = mimeDb.mimeTypeForName(data._mimeType);
 
         if(data._mimeType.contains(QStringLiteral("text/")) || data._mimeType.contains(QStringLiteral("/pdf"))) {
-            data._source = account->url().toString() + relativeServerFileTypeIconPath(mimeType);
+            data._source = account.url.toString() + relativeServerFileTypeIconPath(mimeType);
             data._isMimeTypeIcon = true;
         } else {
             data._source = jsonPreviewData.value(QStringLiteral("source")).toString();
@@ -158,7 +158,20 @@ public:
 
     Q_ENUM(Type)
 
+    /**
+     * What fromActivityJson() needs of the account, copied on the account's thread
+     * so that activities can be decoded on a worker thread.
+     */
+    struct AccountDetails {
+        QString displayName;
+        QString davUser;
+        QUrl url;
+
+        static AccountDetails fromAccount(const AccountPtr &account);
+    };
+
     static Activity fromActivityJson(const QJsonObject &json, const AccountPtr account);
+    static Activity fromActivityJson(const QJsonObject &json, const AccountDetails &account);
 
     static QString relativeServerFileTypeIconPath(const QMimeType &mimeType);
     static QString localFilePathForActivity(const Activity &activity, const AccountPtr account);
@@ -29,15 +29,21 @@
 #include <QtCore>
 #include <QAbstractListModel>
 #include <QDesktopServices>
+#include <QFutureWatcher>
 #include <QWidget>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QLoggingCategory>
 
+#include <utility>
+
 namespace OCC {
 
 Q_LOGGING_CATEGORY(lcActivity, "nextcloud.gui.activity", QtInfoMsg)
 
+constexpr auto successStatusCode = 200;
+constexpr auto notModifiedStatusCode = 304;
+
 ActivityListModel::ActivityListModel(QObject *parent)
     : QAbstractListModel(parent)
 {
@@ -127,6 +133,11 @@ bool ActivityListModel::currentlyFetching() const
     return _currentlyFetching;
 }
 
+bool ActivityListModel::doneFetching() const
+{
+    return _doneFetching;
+}
+
 void ActivityListModel::setDoneFetching(bool value)
 {
     _doneFetching = value;
@@ -423,19 +434,42 @@ void ActivityListModel::startFetchJob()
     if (!_accountState->isConnected() || currentlyFetching()) {
         return;
     }
+    const auto job = createFetchJob(50);
+
+    setAndRefreshCurrentlyFetching(true);
+    qCInfo(lcActivity) << "Start fetching activities for " << _accountState->account()->displayName();
+    job->start();
+}
+
+JsonApiJob *ActivityListModel::createFetchJob(int limit)
+{
     auto *job = new JsonApiJob(_accountState->account(), QLatin1String("ocs/v2.php/apps/activity/api/v2/activity"), this);
-    QObject::connect(job, &JsonApiJob::jsonReceived,
-        this, &ActivityListModel::activitiesReceived);
+    job->setDecoder([account = Activity::AccountDetails::fromAccount(_accountState->account())](const QJsonDocument &json) {
+        return QVariant::fromValue(activitiesFromJson(json, account));
+    });
+    QObject::connect(job, &JsonApiJob::jsonDecoded,
+        this, &ActivityListModel::activitiesDecoded);
+
+    // A refresh asks for the newest page again: the server answers 304 if nothing changed
+    const auto since = _refreshingNewestActivities ? 0 : _currentItem;
+    if (since == 0) {
+        if (!_activityLists.isEmpty() && !_firstPageEtag.isEmpty()) {
+            job->addRawHeader("If-None-Match", _firstPageEtag);
+            _sentFirstPageEtag = true;
+        }
+        QObject::connect(job, &JsonApiJob::etagResponseHeaderReceived, this, [this](const QByteArray &value, int statusCode) {
+            if (statusCode == successStatusCode) {
+                _firstPageEtag = value;
+            }
+        });
+    }
 
     QUrlQuery params;
     params.addQueryItem(QLatin1String("previews"), QLatin1String("true"));
-    params.addQueryItem(QLatin1String("since"), QString::number(_currentItem));
-    params.addQueryItem(QLatin1String("limit"), QString::number(50));
+    params.addQueryItem(QLatin1String("since"), QString::number(since));
+    params.addQueryItem(QLatin1String("limit"), QString::number(limit));
     job->addQueryParams(params);
-
-    setAndRefreshCurrentlyFetching(true);
-    qCInfo(lcActivity) << "Start fetching activities for " << _accountState->account()->displayName();
-    job->start();
+    return job;
 }
 
 int ActivityListModel::currentItem() const
@@ -443,18 +477,26 @@ int ActivityListModel::currentItem() const
     return _currentItem;
 }
 
-void ActivityListModel::ingestActivities(const QJsonArray &activities)
+ActivityList ActivityListModel::activitiesFromJson(const QJsonDocument &json, const Activity::AccountDetails &account)
+{
+    const auto activities = json.object().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toArray();
+
+    ActivityList list;
+    list.reserve(activities.size());
+    for (const auto &activity : activities) {
+        list.append(Activity::fromActivityJson(activity.toObject(), account));
+    }
+    return list;
+}
+
+void ActivityListModel::ingestActivities(const ActivityList &activities)
 {
     ActivityList list;
 
     QDateTime oldestDate = QDateTime::currentDateTime();
     oldestDate = oldestDate.addDays(static_cast<qint64>(_maxActivitiesDays) * -1);
 
-    for (const auto &activity : activities) {
-        const auto json = activity.toObject();
-
-        auto a = Activity::fromActivityJson(json, _accountState->account());
-
+    for (const auto &a : activities) {
         if(_presentedActivities.contains(a._id)) {
             continue;
         }
@@ -519,21 +561,36 @@ void ActivityListModel::insertOrRemoveDummyFetchingActivity()
     }
 }
 
-void ActivityListModel::activitiesReceived(const QJsonDocument &json, int statusCode)
+void ActivityListModel::activitiesDecoded(const QVariant &activities, int statusCode)
 {
-    const auto activities = json.object().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toArray();
-
     if (!_accountState) {
         return;
     }
 
-    if (activities.empty()) {
+    const auto refreshedNewestActivities = std::exchange(_refreshingNewestActivities, false);
+    const auto sentFirstPageEtag = std::exchange(_sentFirstPageEtag, false);
+    if (statusCode == notModifiedStatusCode && sentFirstPageEtag) {
+        // keep paging from where the list is, the newest page is already in it
+        qCDebug(lcActivity) << "Activities of" << _accountState->account()->displayName() << "didn't change";
+        setAndRefreshCurrentlyFetching(false);
+        emit activityJobStatusCode(statusCode);
+        return;
+    }
+
+    if (refreshedNewestActivities) {
+        _doneFetching = false;
+        _currentItem = 0;
+        _showMoreActivitiesAvailableEntry = false;
+    }
+
+    const auto list = activities.value<ActivityList>();
+    if (list.isEmpty()) {
         _doneFetching = true;
     }
 
     setAndRefreshCurrentlyFetching(false);
 
-    ingestActivities(activities);
+    ingestActivities(list);
 
     emit activityJobStatusCode(statusCode);
 }
@@ -760,23 +817,30 @@ void ActivityListModel::triggerCaseClashAction(Activity activity)
 
     auto folder = FolderMan::instance()->folder(activity._folder);
     const auto conflictedRelativePath = activity._file;
-    const auto conflictRecord = folder->journalDb()->caseConflictRecordByBasePath(conflictedRelativePath);
-
-    const auto dir = QDir(folder->path());
-    const auto conflictedPath = dir.filePath(conflictedRelativePath);
-    const auto conflictTaggedPath = dir.filePath(conflictRecord.path);
-
-    _currentCaseClashFilenameDialog = new CaseClashFilenameDialog(_accountState->account(),
-                                                                  folder,
-                                                                  conflictedPath,
-                                                                  conflictTaggedPath);
-    connect(_currentCaseClashFilenameDialog, &CaseClashFilenameDialog::successfulRename, folder, [folder, activity](const QString& filePath) {
-        qCInfo(lcActivity) << "successfulRename" << filePath << activity._message;
-        folder->acceptCaseClashConflictFileName(activity._message);
-        folder->scheduleThisFolderSoon();
+
+    // Don't wait for the sync engine to be done with the journal
+    const auto watcher = new QFutureWatcher<ConflictRecord>(this);
+    connect(watcher, &QFutureWatcherBase::finished, folder, [this, watcher, folder, activity, conflictedRelativePath] {
+        watcher->deleteLater();
+        const auto conflictRecord = watcher->result();
+
+        const auto dir = QDir(folder->path());
+        const auto conflictedPath = dir.filePath(conflictedRelativePath);
+        const auto conflictTaggedPath = dir.filePath(conflictRecord.path);
+
+        _currentCaseClashFilenameDialog = new CaseClashFilenameDialog(_accountState->account(),
+                                                                      folder,
+                                                                      conflictedPath,
+                                                                      conflictTaggedPath);
+        connect(_currentCaseClashFilenameDialog, &CaseClashFilenameDialog::successfulRename, folder, [folder, activity](const QString& filePath) {
+            qCInfo(lcActivity) << "successfulRename" << filePath << activity._message;
+            folder->acceptCaseClashConflictFileName(activity._message);
+            folder->scheduleThisFolderSoon();
+        });
+        _currentCaseClashFilenameDialog->open();
+        ownCloudGui::raiseDialog(_currentCaseClashFilenameDialog);
     });
-    _currentCaseClashFilenameDialog->open();
-    ownCloudGui::raiseDialog(_currentCaseClashFilenameDialog);
+    watcher->setFuture(folder->journalReader()->caseConflictRecordByBasePath(conflictedRelativePath));
 }
 
 void ActivityListModel::displaySingleConflictDialog(const Activity &activity)
@@ -788,27 +852,34 @@ void ActivityListModel::displaySingleConflictDialog(const Activity &activity)
     const auto folder = FolderMan::instance()->folder(activity._folder);
 
     const auto conflictedRelativePath = activity._file;
-    const auto baseRelativePath = folder->journalDb()->conflictFileBaseName(conflictedRelativePath.toUtf8());
 
-    const auto dir = QDir(folder->path());
-    const auto conflictedPath = dir.filePath(conflictedRelativePath);
-    const auto basePath = dir.filePath(baseRelativePath);
+    // Don't wait for the sync engine to be done with the journal
+    const auto watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, folder, [this, watcher, folder, conflictedRelativePath] {
+        watcher->deleteLater();
+        const auto baseRelativePath = QString::fromUtf8(watcher->result());
 
-    const auto baseName = QFileInfo(basePath).fileName();
+        const auto dir = QDir(folder->path());
+        const auto conflictedPath = dir.filePath(conflictedRelativePath);
+        const auto basePath = dir.filePath(baseRelativePath);
 
-    if (!_currentConflictDialog.isNull()) {
-        _currentConflictDialog->close();
-    }
-    _currentConflictDialog = new ConflictDialog;
-    _currentConflictDialog->setBaseFilename(baseName);
-    _currentConflictDialog->setLocalVersionFilename(conflictedPath);
-    _currentConflictDialog->setRemoteVersionFilename(basePath);
-    _currentConflictDialog->setAttribute(Qt::WA_DeleteOnClose);
-    connect(_currentConflictDialog, &ConflictDialog::accepted, folder, [folder]() {
-        folder->scheduleThisFolderSoon();
+        const auto baseName = QFileInfo(basePath).fileName();
+
+        if (!_currentConflictDialog.isNull()) {
+            _currentConflictDialog->close();
+        }
+        _currentConflictDialog = new ConflictDialog;
+        _currentConflictDialog->setBaseFilename(baseName);
+        _currentConflictDialog->setLocalVersionFilename(conflictedPath);
+        _currentConflictDialog->setRemoteVersionFilename(basePath);
+        _currentConflictDialog->setAttribute(Qt::WA_DeleteOnClose);
+        connect(_currentConflictDialog, &ConflictDialog::accepted, folder, [folder]() {
+            folder->scheduleThisFolderSoon();
+        });
+        _currentConflictDialog->open();
+        ownCloudGui::raiseDialog(_currentConflictDialog);
     });
-    _currentConflictDialog->open();
-    ownCloudGui::raiseDialog(_currentConflictDialog);
+    watcher->setFuture(folder->journalReader()->conflictFileBaseName(conflictedRelativePath.toUtf8()));
 }
 
 void ActivityListModel::setHasSyncConflicts(bool conflictsFound)
@@ -942,17 +1013,22 @@ void ActivityListModel::fetchMore(const QModelIndex &)
 
 void ActivityListModel::slotRefreshActivity()
 {
-    _doneFetching = false;
-    _currentItem = 0;
-    _showMoreActivitiesAvailableEntry = false;
-
     if (canFetchActivities()) {
-        startFetchJob();
+        startRefreshJob();
     } else {
+        _currentItem = 0;
+        _showMoreActivitiesAvailableEntry = false;
         _doneFetching = true;
     }
 }
 
+void ActivityListModel::startRefreshJob()
+{
+    // The paging state is only reset once the newest page did change, see activitiesDecoded()
+    _refreshingNewestActivities = true;
+    startFetchJob();
+}
+
 void ActivityListModel::slotRefreshActivityInitial()
 {
     if (_activityLists.isEmpty() && !currentlyFetching()) {
@@ -968,6 +1044,9 @@ void ActivityListModel::slotRemoveAccount()
     setAndRefreshCurrentlyFetching(false);
     _doneFetching = false;
     _currentItem = 0;
+    _refreshingNewestActivities = false;
+    _sentFirstPageEtag = false;
+    _firstPageEtag.clear();
     _showMoreActivitiesAvailableEntry = false;
 }
 
@@ -33,6 +33,7 @@ class AccountState;
 class ConflictDialog;
 class InvalidFilenameDialog;
 class CaseClashFilenameDialog;
+class JsonApiJob;
 
 /**
  * @brief The ActivityListModel
@@ -155,20 +156,30 @@ signals:
 
 protected:
     [[nodiscard]] bool currentlyFetching() const;
+    [[nodiscard]] bool doneFetching() const;
+
+    // A fetch of up to limit activities after the fetched ones, or of the newest ones on a refresh
+    [[nodiscard]] JsonApiJob *createFetchJob(int limit);
+
+    // The activities of an activity app reply, can be called off the GUI thread
+    [[nodiscard]] static ActivityList activitiesFromJson(const QJsonDocument &json, const Activity::AccountDetails &account);
 
 protected slots:
-    void activitiesReceived(const QJsonDocument &json, int statusCode);
+    // activities is an ActivityList decoded with activitiesFromJson()
+    void activitiesDecoded(const QVariant &activities, int statusCode);
     void setAndRefreshCurrentlyFetching(bool value);
     void setDoneFetching(bool value);
     void setHideOldActivities(bool value);
     void setDisplayActions(bool value);
 
     virtual void startFetchJob();
+    // Fetches the newest page again, keeping the paging state if it didn't change
+    void startRefreshJob();
 
 private slots:
     void addEntriesToActivityList(const OCC::ActivityList &activityList);
     void accountStateHasChanged();
-    void ingestActivities(const QJsonArray &activities);
+    void ingestActivities(const OCC::ActivityList &activities);
     void appendMoreActivitiesAvailableEntry();
     void insertOrRemoveDummyFetchingActivity();
     void triggerCaseClashAction(OCC::Activity activity);
@@ -198,6 +209,9 @@ private:
     bool _displayActions = true;
 
     int _currentItem = 0;
+    QByteArray _firstPageEtag; // of the newest activities, to refresh them with If-None-Match
+    bool _refreshingNewestActivities = false;
+    bool _sentFirstPageEtag = false; // with the running fetch, a 304 then means the newest page didn't change
     static constexpr int _maxActivities = 100;
     static constexpr int _maxActivitiesDays = 30;
     bool _showMoreActivitiesAvailableEntry = false;
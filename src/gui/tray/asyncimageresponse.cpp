@@ -12,11 +12,12 @@
  * for more details.
  */
 
+#include <QFutureWatcher>
 #include <QIcon>
-#include <QPainter>
-#include <QSvgRenderer>
+#include <QtConcurrent>
 
 #include "asyncimageresponse.h"
+#include "imagecache.h"
 #include "usermodel.h"
 
 AsyncImageResponse::AsyncImageResponse(const QString &id, const QSize &requestedSize)
@@ -26,6 +27,13 @@ AsyncImageResponse::AsyncImageResponse(const QString &id, const QSize &requested
         return;
     }
 
+    _cacheKey = OCC::ImageCache::imageKey(id, requestedSize);
+    QImage cachedImage;
+    if (OCC::ImageCache::instance()->findImage(_cacheKey, &cachedImage)) {
+        setImageAndEmitFinished(cachedImage);
+        return;
+    }
+
     auto actualId = id;
     const auto idSplit = id.split(QStringLiteral("/"), Qt::SkipEmptyParts);
     const auto color = QColor(idSplit.last());
@@ -48,6 +56,9 @@ AsyncImageResponse::AsyncImageResponse(const QString &id, const QSize &requested
 void AsyncImageResponse::setImageAndEmitFinished(const QImage &image)
 {
     _image = image;
+    if (!_cacheKey.isEmpty()) {
+        OCC::ImageCache::instance()->insertImage(_cacheKey, image);
+    }
     emit finished();
 }
 
@@ -86,10 +97,20 @@ void AsyncImageResponse::processNextImage()
     if (accountInRequestedServer) {
         const QUrl iconUrl(_imagePaths.at(_index));
         if (iconUrl.isValid() && !iconUrl.scheme().isEmpty()) {
-            // fetch the remote resource
-            const auto reply = accountInRequestedServer->sendRawRequest(QByteArrayLiteral("GET"), iconUrl);
-            connect(reply, &QNetworkReply::finished, this, &AsyncImageResponse::slotProcessNetworkReply);
             ++_index;
+            const auto cachedData = OCC::ImageCache::instance()->findData(iconUrl);
+            if (cachedData.fresh) {
+                processImageData(cachedData.data);
+                return;
+            }
+
+            // fetch the remote resource, or just confirm that our copy is still current
+            QNetworkRequest request;
+            if (!cachedData.etag.isEmpty()) {
+                request.setRawHeader(QByteArrayLiteral("If-None-Match"), cachedData.etag);
+            }
+            const auto reply = accountInRequestedServer->sendRawRequest(QByteArrayLiteral("GET"), iconUrl, request);
+            connect(reply, &QNetworkReply::finished, this, &AsyncImageResponse::slotProcessNetworkReply);
             return;
         }
     }
@@ -105,39 +126,41 @@ void AsyncImageResponse::slotProcessNetworkReply()
         return;
     }
 
+    const auto imageCache = OCC::ImageCache::instance();
+    const auto url = reply->request().url();
+    const auto cacheControl = reply->rawHeader(QByteArrayLiteral("Cache-Control"));
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        imageCache->updateData(url, cacheControl);
+        processImageData(imageCache->findData(url).data);
+        return;
+    }
+
     const QByteArray imageData = reply->readAll();
     // server returns "[]" for some some file previews (have no idea why), so, we use another image
     // from the list if available
+    if (reply->error() == QNetworkReply::NoError && imageData != QByteArrayLiteral("[]")) {
+        imageCache->insertData(url, imageData, reply->rawHeader(QByteArrayLiteral("ETag")), cacheControl);
+    }
+    processImageData(imageData);
+}
+
+void AsyncImageResponse::processImageData(const QByteArray &imageData)
+{
     if (imageData.isEmpty() || imageData == QByteArrayLiteral("[]")) {
         processNextImage();
-    } else {
-        if (imageData.startsWith(QByteArrayLiteral("<svg"))) {
-            // SVG image needs proper scaling, let's do it with QPainter and QSvgRenderer
-            QSvgRenderer svgRenderer;
-            if (svgRenderer.load(imageData)) {
-                QImage scaledSvg(_requestedImageSize, QImage::Format_ARGB32);
-                scaledSvg.fill("transparent");
-                QPainter painterForSvg(&scaledSvg);
-                svgRenderer.render(&painterForSvg);
-
-                if(!_svgRecolor.isValid()) {
-                    setImageAndEmitFinished(scaledSvg);
-                    return;
-                }
-
-                QImage image(_requestedImageSize, QImage::Format_ARGB32);
-                image.fill(_svgRecolor);
-                QPainter imagePainter(&image);
-                imagePainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-                imagePainter.drawImage(0, 0, scaledSvg);
-                setImageAndEmitFinished(image);
-                return;
-            } else {
-                processNextImage();
-            }
+        return;
+    }
+
+    // decoding and rasterizing SVGs is slow enough to be noticeable when scrolling long lists
+    const auto watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher] {
+        const auto image = watcher->result();
+        watcher->deleteLater();
+        if (image.isNull()) {
+            processNextImage();
         } else {
-            setImageAndEmitFinished(QImage::fromData(imageData));
+            setImageAndEmitFinished(image);
         }
-    }
+    });
+    watcher->setFuture(QtConcurrent::run(&OCC::ImageCache::renderImage, imageData, _requestedImageSize, _svgRecolor));
 }
-
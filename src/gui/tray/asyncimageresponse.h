@@ -27,11 +27,13 @@ public:
 
 private:
     void processNextImage();
+    void processImageData(const QByteArray &imageData);
 
 private slots:
     void slotProcessNetworkReply();
 
     QImage _image;
+    QString _cacheKey;
     QStringList _imagePaths;
     QSize _requestedImageSize;
     QColor _svgRecolor;
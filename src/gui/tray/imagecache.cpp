@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "imagecache.h"
+
+#include <QDateTime>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QSvgRenderer>
+
+#include <memory>
+
+namespace {
+
+constexpr auto etagHeaderC = "ETag";
+
+// Seconds the data may be used without asking the server, -1 if it must not be stored at all
+qint64 freshnessLifetime(const QByteArray &cacheControl)
+{
+    qint64 maxAge = 0;
+    bool noCache = false;
+    for (const auto &directive : cacheControl.split(',')) {
+        const auto trimmed = directive.trimmed().toLower();
+        if (trimmed == "no-store") {
+            return -1;
+        } else if (trimmed == "no-cache") {
+            noCache = true;
+        } else if (trimmed.startsWith("max-age=")) {
+            maxAge = qMax(0ll, trimmed.mid(8).toLongLong());
+        }
+    }
+    return noCache ? 0 : maxAge;
+}
+
+}
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcImageCache, "nextcloud.gui.imagecache", QtInfoMsg)
+
+ImageCache::ImageCache(const QString &diskCacheDirectory)
+    : _images(maxMemoryCost)
+{
+    _diskCache.setCacheDirectory(diskCacheDirectory);
+    _diskCache.setMaximumCacheSize(maxDiskCacheSize);
+}
+
+ImageCache *ImageCache::instance()
+{
+    static ImageCache cache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/images"));
+    return &cache;
+}
+
+QString ImageCache::imageKey(const QString &source, const QSize &size, const QColor &color)
+{
+    return source + QLatin1Char('|') + QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height())
+        + QLatin1Char('|') + (color.isValid() ? color.name(QColor::HexArgb) : QString());
+}
+
+bool ImageCache::findImage(const QString &key, QImage *image, QSize *originalSize)
+{
+    QMutexLocker locker(&_mutex);
+    const auto entry = _images.object(key);
+    if (!entry) {
+        return false;
+    }
+    *image = entry->image;
+    if (originalSize) {
+        *originalSize = entry->originalSize;
+    }
+    return true;
+}
+
+void ImageCache::insertImage(const QString &key, const QImage &image, const QSize &originalSize)
+{
+    if (image.isNull()) {
+        return;
+    }
+    const auto cost = static_cast<int>(image.sizeInBytes() / 1024) + 1;
+    QMutexLocker locker(&_mutex);
+    _images.insert(key, new Entry{image, originalSize}, cost);
+}
+
+void ImageCache::clearImages()
+{
+    QMutexLocker locker(&_mutex);
+    _images.clear();
+}
+
+ImageCache::CachedData ImageCache::findData(const QUrl &url)
+{
+    QMutexLocker locker(&_mutex);
+    const auto metaData = _diskCache.metaData(url);
+    if (!metaData.isValid()) {
+        return {};
+    }
+    const std::unique_ptr<QIODevice> device(_diskCache.data(url));
+    if (!device) {
+        return {};
+    }
+
+    CachedData result;
+    result.data = device->readAll();
+    result.fresh = metaData.expirationDate() > QDateTime::currentDateTimeUtc();
+    for (const auto &header : metaData.rawHeaders()) {
+        if (header.first == etagHeaderC) {
+            result.etag = header.second;
+        }
+    }
+    return result;
+}
+
+void ImageCache::insertData(const QUrl &url, const QByteArray &data, const QByteArray &etag, const QByteArray &cacheControl)
+{
+    const auto lifetime = freshnessLifetime(cacheControl);
+    if (data.isEmpty() || lifetime < 0 || (lifetime == 0 && etag.isEmpty())) {
+        // nothing we could ever reuse without downloading it again
+        return;
+    }
+
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(url);
+    metaData.setSaveToDisk(true);
+    metaData.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(lifetime));
+    if (!etag.isEmpty()) {
+        metaData.setRawHeaders({{etagHeaderC, etag}});
+    }
+
+    QMutexLocker locker(&_mutex);
+    const auto device = _diskCache.prepare(metaData);
+    if (!device) {
+        qCDebug(lcImageCache) << "Not caching" << url;
+        return;
+    }
+    device->write(data);
+    _diskCache.insert(device);
+}
+
+void ImageCache::updateData(const QUrl &url, const QByteArray &cacheControl)
+{
+    const auto lifetime = freshnessLifetime(cacheControl);
+    QMutexLocker locker(&_mutex);
+    if (lifetime < 0) {
+        _diskCache.remove(url);
+        return;
+    }
+    auto metaData = _diskCache.metaData(url);
+    if (metaData.isValid()) {
+        metaData.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(lifetime));
+        _diskCache.updateMetaData(metaData);
+    }
+}
+
+QImage ImageCache::renderImage(const QByteArray &data, const QSize &requestedSize, const QColor &color)
+{
+    if (!data.startsWith(QByteArrayLiteral("<svg"))) {
+        return QImage::fromData(data);
+    }
+
+    // SVG image needs proper scaling, let's do it with QPainter and QSvgRenderer
+    QSvgRenderer svgRenderer;
+    if (!svgRenderer.load(data)) {
+        return {};
+    }
+    const auto size = requestedSize.isValid() && !requestedSize.isEmpty() ? requestedSize : svgRenderer.defaultSize();
+    if (size.isEmpty()) {
+        return {};
+    }
+
+    QImage scaledSvg(size, QImage::Format_ARGB32);
+    scaledSvg.fill(Qt::transparent);
+    {
+        QPainter painterForSvg(&scaledSvg);
+        svgRenderer.render(&painterForSvg);
+    }
+
+    if (!color.isValid()) {
+        return scaledSvg;
+    }
+
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(color);
+    {
+        QPainter imagePainter(&image);
+        imagePainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+        imagePainter.drawImage(0, 0, scaledSvg);
+    }
+    return image;
+}
+
+}
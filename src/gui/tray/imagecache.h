@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QColor>
+#include <QImage>
+#include <QMutex>
+#include <QNetworkDiskCache>
+#include <QUrl>
+
+namespace OCC {
+
+/**
+ * @brief Cache for the icons and previews shown in the tray window
+ * @ingroup gui
+ *
+ * Rendered images are kept in memory, keyed by their source, size and colour,
+ * so scrolling through long activity or search result lists doesn't fetch and
+ * rasterize the same icons over and over. The least recently used images are
+ * dropped once the memory budget is used up.
+ *
+ * The raw data of remote images is also kept on disk with its ETag and expiry
+ * from Cache-Control. Fresh data is used without a request, stale data is
+ * revalidated with If-None-Match.
+ *
+ * All functions may be called from any thread.
+ */
+class ImageCache
+{
+public:
+    struct CachedData
+    {
+        QByteArray data;
+        QByteArray etag;
+        /// Whether the data may be used without revalidating it
+        bool fresh = false;
+    };
+
+    /// Memory budget for rendered images in KiB
+    static constexpr int maxMemoryCost = 32 * 1024;
+    static constexpr qint64 maxDiskCacheSize = 50 * 1024 * 1024;
+
+    explicit ImageCache(const QString &diskCacheDirectory);
+
+    static ImageCache *instance();
+
+    [[nodiscard]] static QString imageKey(const QString &source, const QSize &size, const QColor &color = {});
+
+    /// originalSize receives the size passed to insertImage(), as QQuickImageProvider wants it
+    [[nodiscard]] bool findImage(const QString &key, QImage *image, QSize *originalSize = nullptr);
+    void insertImage(const QString &key, const QImage &image, const QSize &originalSize = {});
+    void clearImages();
+
+    [[nodiscard]] CachedData findData(const QUrl &url);
+    /// Stores the data of a GET reply unless its Cache-Control forbids it or it can't be reused
+    void insertData(const QUrl &url, const QByteArray &data, const QByteArray &etag, const QByteArray &cacheControl);
+    /// Renews the expiry of stored data after the server answered 304 Not Modified
+    void updateData(const QUrl &url, const QByteArray &cacheControl);
+
+    /** Decodes image data
+     *
+     * SVGs are rasterized at the requested size and, if color is valid, take
+     * that colour. Meant to be run off the GUI thread, see AsyncImageResponse.
+     */
+    [[nodiscard]] static QImage renderImage(const QByteArray &data, const QSize &requestedSize, const QColor &color = {});
+
+private:
+    struct Entry
+    {
+        QImage image;
+        QSize originalSize;
+    };
+
+    QMutex _mutex;
+    QCache<QString, Entry> _images;
+    QNetworkDiskCache _diskCache;
+};
+
+}
@@ -18,6 +18,10 @@ const char propertyAccountStateC[] = "oc_account_state";
 const int successStatusCode = 200;
 const int notModifiedStatusCode = 304;
 
+namespace {
+DecodedNotifications decodeNotifications(const QJsonDocument &document, const Activity::AccountDetails &account);
+}
+
 ServerNotificationHandler::ServerNotificationHandler(AccountState *accountState, QObject *parent)
     : QObject(parent)
     , _accountState(accountState)
@@ -43,7 +47,10 @@ bool ServerNotificationHandler::startFetchNotifications()
 
     // if the previous notification job has finished, start next.
     _notificationJob = new JsonApiJob(_accountState->account(), notificationsPath, this);
-    QObject::connect(_notificationJob.data(), &JsonApiJob::jsonReceived,
+    _notificationJob->setDecoder([account = Activity::AccountDetails::fromAccount(_accountState->account())](const QJsonDocument &json) {
+        return QVariant::fromValue(decodeNotifications(json, account));
+    });
+    QObject::connect(_notificationJob.data(), &JsonApiJob::jsonDecoded,
         this, &ServerNotificationHandler::slotNotificationsReceived);
     QObject::connect(_notificationJob.data(), &JsonApiJob::etagResponseHeaderReceived,
         this, &ServerNotificationHandler::slotEtagResponseHeaderReceived);
@@ -62,32 +69,18 @@ void ServerNotificationHandler::slotEtagResponseHeaderReceived(const QByteArray
     }
 }
 
-void ServerNotificationHandler::slotNotificationsReceived(const QJsonDocument &json, int statusCode)
-{
-    if (statusCode != successStatusCode && statusCode != notModifiedStatusCode) {
-        qCWarning(lcServerNotification) << "Notifications failed with status code " << statusCode;
-        deleteLater();
-        emit jobFinished();
-        return;
-    }
+namespace {
 
-    if (statusCode == notModifiedStatusCode) {
-        qCInfo(lcServerNotification) << "Status code " << statusCode << " Not Modified - No new notifications.";
-        deleteLater();
-        emit jobFinished();
-        return;
-    }
-
-    auto notifies = json.object().value("ocs").toObject().value("data").toArray();
-
-    auto *ai = qvariant_cast<AccountState *>(sender()->property(propertyAccountStateC));
+DecodedNotifications decodeNotifications(const QJsonDocument &document, const Activity::AccountDetails &account)
+{
+    const auto notifies = document.object().value("ocs").toObject().value("data").toArray();
 
     ActivityList list;
     ActivityList callList;
 
-    foreach (auto element, notifies) {
+    for (const auto &element : notifies) {
         auto json = element.toObject();
-        auto a = Activity::fromActivityJson(json, ai->account());
+        auto a = Activity::fromActivityJson(json, account);
 
         a._type = Activity::NotificationType;
         a._id = json.value("notification_id").toInt();
@@ -119,7 +112,7 @@ void ServerNotificationHandler::slotNotificationsReceived(const QJsonDocument &j
             const auto objectIdData = objectId.split("/");
 
             ActivityLink al;
-            al._label = tr("Reply");
+            al._label = ServerNotificationHandler::tr("Reply");
             al._verb = "REPLY";
             al._primary = true;
 
@@ -138,7 +131,7 @@ void ServerNotificationHandler::slotNotificationsReceived(const QJsonDocument &j
                     al._primary = false;
                 }
 
-                a._talkNotificationData.userAvatar = ai->account()->url().toString() + QStringLiteral("/index.php/avatar/") + a._subjectRichParameters["user"].value<Activity::RichSubjectParameter>().id + QStringLiteral("/128");
+                a._talkNotificationData.userAvatar = account.url.toString() + QStringLiteral("/index.php/avatar/") + a._subjectRichParameters["user"].value<Activity::RichSubjectParameter>().id + QStringLiteral("/128");
             }
 
             // We want to serve incoming call dialogs to the user for calls that
@@ -152,19 +145,42 @@ void ServerNotificationHandler::slotNotificationsReceived(const QJsonDocument &j
         QUrl link(json.value("link").toString());
         if (!link.isEmpty()) {
             if (link.host().isEmpty()) {
-                link.setScheme(ai->account()->url().scheme());
-                link.setHost(ai->account()->url().host());
+                link.setScheme(account.url.scheme());
+                link.setHost(account.url.host());
             }
             if (link.port() == -1) {
-                link.setPort(ai->account()->url().port());
+                link.setPort(account.url.port());
             }
         }
         a._link = link;
 
         list.append(a);
     }
-    emit newNotificationList(list);
-    emit newIncomingCallsList(callList);
+
+    return {list, callList};
+}
+
+}
+
+void ServerNotificationHandler::slotNotificationsReceived(const QVariant &notifications, int statusCode)
+{
+    if (statusCode != successStatusCode && statusCode != notModifiedStatusCode) {
+        qCWarning(lcServerNotification) << "Notifications failed with status code " << statusCode;
+        deleteLater();
+        emit jobFinished();
+        return;
+    }
+
+    if (statusCode == notModifiedStatusCode) {
+        qCInfo(lcServerNotification) << "Status code " << statusCode << " Not Modified - No new notifications.";
+        deleteLater();
+        emit jobFinished();
+        return;
+    }
+
+    const auto decoded = notifications.value<DecodedNotifications>();
+    emit newNotificationList(decoded.notifications);
+    emit newIncomingCallsList(decoded.incomingCalls);
     emit jobFinished();
 
     deleteLater();
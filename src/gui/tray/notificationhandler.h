@@ -9,6 +9,12 @@ class QJsonDocument;
 
 namespace OCC {
 
+struct DecodedNotifications
+{
+    ActivityList notifications;
+    ActivityList incomingCalls;
+};
+
 class ServerNotificationHandler : public QObject
 {
     Q_OBJECT
@@ -24,7 +30,8 @@ public:
     bool startFetchNotifications();
 
 private slots:
-    void slotNotificationsReceived(const QJsonDocument &json, int statusCode);
+    // notifications is a DecodedNotifications, decoded on a worker thread
+    void slotNotificationsReceived(const QVariant &notifications, int statusCode);
     void slotEtagResponseHeaderReceived(const QByteArray &value, int statusCode);
 
 private:
@@ -33,4 +40,6 @@ private:
 };
 }
 
+Q_DECLARE_METATYPE(OCC::DecodedNotifications)
+
 #endif // NOTIFICATIONHANDLER_H
@@ -14,6 +14,7 @@
 
 #include "svgimageprovider.h"
 #include "iconutils.h"
+#include "imagecache.h"
 
 #include <QLoggingCategory>
 
@@ -45,7 +46,22 @@ namespace Ui {
             return {};
         }
 
-        return IconUtils::createSvgImageWithCustomColor(pixmapName, pixmapColor, size, requestedSize);
+        const auto cacheKey = ImageCache::imageKey(QStringLiteral("svgimage-custom-color:") + pixmapName, requestedSize, pixmapColor);
+        QImage image;
+        QSize originalSize;
+        if (ImageCache::instance()->findImage(cacheKey, &image, &originalSize)) {
+            if (size) {
+                *size = originalSize;
+            }
+            return image;
+        }
+
+        image = IconUtils::createSvgImageWithCustomColor(pixmapName, pixmapColor, &originalSize, requestedSize);
+        ImageCache::instance()->insertImage(cacheKey, image, originalSize);
+        if (size) {
+            *size = originalSize;
+        }
+        return image;
     }
 }
 }
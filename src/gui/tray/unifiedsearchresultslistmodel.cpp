@@ -24,6 +24,8 @@
 
 #include <QAbstractListModel>
 #include <QDesktopServices>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 namespace {
 QString imagePlaceholderUrlForProviderId(const QString &providerId, const bool darkMode)
@@ -186,6 +188,11 @@ std::pair<QString, bool> iconsFromThumbnailAndFallbackIcon(const QString &thumbn
 
 constexpr int searchTermEditingFinishedSearchStartDelay = 800;
 
+// results of providers replying within this interval are inserted into the model together
+constexpr int insertPendingResultsDelay = 100;
+
+constexpr int maxCachedSearches = 20;
+
 // server-side bug of returning the cursor > 0 and isPaginated == 'true', using '5' as it is done on Android client's end now
 constexpr int minimumEntresNumberToShowLoadMore = 5;
 }
@@ -194,8 +201,12 @@ Q_LOGGING_CATEGORY(lcUnifiedSearch, "nextcloud.gui.unifiedsearch", QtInfoMsg)
 
 UnifiedSearchResultsListModel::UnifiedSearchResultsListModel(AccountState *accountState, QObject *parent)
     : QAbstractListModel(parent)
+    , _searchCache(maxCachedSearches)
     , _accountState(accountState)
 {
+    _insertPendingResultsTimer.setSingleShot(true);
+    _insertPendingResultsTimer.setInterval(insertPendingResultsDelay);
+    connect(&_insertPendingResultsTimer, &QTimer::timeout, this, &UnifiedSearchResultsListModel::insertPendingResults);
 }
 
 QVariant UnifiedSearchResultsListModel::data(const QModelIndex &index, int role) const
@@ -321,7 +332,22 @@ void UnifiedSearchResultsListModel::setSearchTerm(const QString &term)
         emit waitingForSearchTermEditEndChanged();
     }
 
-    if (!_results.isEmpty()) {
+    _cachedResultsProviderIds.clear();
+    const auto cachedSearch = _searchTerm.isEmpty() ? nullptr : _searchCache.object(_searchTerm);
+    if (cachedSearch) {
+        // show what we found last time right away, the search started above refreshes it
+        beginResetModel();
+        _results = cachedSearch->_results;
+        endResetModel();
+        for (const auto &cachedProvider : cachedSearch->_providers) {
+            if (_providers.contains(cachedProvider._id)) {
+                _providers[cachedProvider._id] = cachedProvider;
+            }
+        }
+        for (const auto &result : qAsConst(_results)) {
+            _cachedResultsProviderIds.insert(result._providerId);
+        }
+    } else if (!_results.isEmpty()) {
         beginResetModel();
         _results.clear();
         endResetModel();
@@ -330,7 +356,7 @@ void UnifiedSearchResultsListModel::setSearchTerm(const QString &term)
 
 bool UnifiedSearchResultsListModel::isSearchInProgress() const
 {
-    return !_searchJobConnections.isEmpty();
+    return !_searchJobs.isEmpty();
 }
 
 void UnifiedSearchResultsListModel::resultClicked(const QString &providerId, const QUrl &resourceUrl) const
@@ -454,22 +480,10 @@ void UnifiedSearchResultsListModel::slotSearchForProviderFinished(const QJsonDoc
 
     const auto providerId = job->property("providerId").toString();
     
-    if (providerId.isEmpty()) {
+    if (providerId.isEmpty() || job->property("searchGeneration").toULongLong() != _searchGeneration) {
         return;
     }
 
-    if (!_searchJobConnections.isEmpty()) {
-        _searchJobConnections.remove(providerId);
-
-        if (_searchJobConnections.isEmpty()) {
-            emit isSearchInProgressChanged();
-        }
-    }
-
-    if (providerId == _currentFetchMoreInProgressProviderId) {
-        clearCurrentFetchMoreInProgressProviderId();
-    }
-
     if (statusCode != 200) {
         qCCritical(lcUnifiedSearch) << QString("%1: Search has failed for '%2'. Error: %3")
                                            .arg(statusCode)
@@ -478,13 +492,58 @@ void UnifiedSearchResultsListModel::slotSearchForProviderFinished(const QJsonDoc
         _errorString +=
             tr("Search has failed for '%1'. Error: %2").arg(_searchTerm).arg(job->errorString()) + QLatin1Char('\n');
         emit errorStringChanged();
+        finishSearchForProvider(providerId);
         return;
     }
 
     const auto data = json.object().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject();
-    if (!data.isEmpty()) {
-        parseResultsForProvider(data, providerId, job->property("appendResults").toBool());
+    if (data.isEmpty()) {
+        finishSearchForProvider(providerId);
+        return;
     }
+
+    const auto fetchedMore = job->property("appendResults").toBool();
+    const auto provider = _providers.value(providerId);
+    const auto accountUrl = _accountState && _accountState->account() ? _accountState->account()->url() : QUrl();
+    const auto searchGeneration = _searchGeneration;
+
+    // building the results resolves a couple of URLs and icons per entry, keep that off the GUI thread
+    const auto watcher = new QFutureWatcher<SearchResultsPage>(this);
+    connect(watcher, &QFutureWatcher<SearchResultsPage>::finished, this, [this, watcher, providerId, fetchedMore, searchGeneration] {
+        watcher->deleteLater();
+        if (searchGeneration != _searchGeneration) {
+            return;
+        }
+        processResultsForProvider(watcher->result(), providerId, fetchedMore);
+        finishSearchForProvider(providerId);
+    });
+    watcher->setFuture(QtConcurrent::run(&UnifiedSearchResultsListModel::parseResultsPage, data, provider, accountUrl));
+}
+
+void UnifiedSearchResultsListModel::finishSearchForProvider(const QString &providerId)
+{
+    if (!_searchJobs.remove(providerId)) {
+        return;
+    }
+
+    if (!_searchJobs.isEmpty()) {
+        if (!_pendingResults.isEmpty() && !_insertPendingResultsTimer.isActive()) {
+            _insertPendingResultsTimer.start();
+        }
+        return;
+    }
+
+    insertPendingResults();
+
+    if (providerId == _currentFetchMoreInProgressProviderId) {
+        clearCurrentFetchMoreInProgressProviderId();
+    }
+
+    if (!_searchTerm.isEmpty() && !_results.isEmpty() && _errorString.isEmpty()) {
+        _searchCache.insert(_searchTerm, new CachedSearch{_results, _providers});
+    }
+
+    emit isSearchInProgressChanged();
 }
 
 void UnifiedSearchResultsListModel::startSearch()
@@ -497,7 +556,8 @@ void UnifiedSearchResultsListModel::startSearch()
         return;
     }
 
-    if (!_results.isEmpty()) {
+    // rows restored from the search cache stay until the new results replace them
+    if (!_results.isEmpty() && _cachedResultsProviderIds.isEmpty()) {
         beginResetModel();
         _results.clear();
         endResetModel();
@@ -526,22 +586,61 @@ void UnifiedSearchResultsListModel::startSearchForProvider(const QString &provid
         job->setProperty("appendResults", true);
     }
     job->setProperty("providerId", providerId);
+    job->setProperty("searchGeneration", _searchGeneration);
     job->addQueryParams(params);
     const auto wasSearchInProgress = isSearchInProgress();
-    _searchJobConnections.insert(providerId,
-        QObject::connect(
-            job, &JsonApiJob::jsonReceived, this, &UnifiedSearchResultsListModel::slotSearchForProviderFinished));
+    _searchJobs.insert(providerId, job);
+    QObject::connect(job, &JsonApiJob::jsonReceived, this, &UnifiedSearchResultsListModel::slotSearchForProviderFinished);
     if (isSearchInProgress() && !wasSearchInProgress) {
         emit isSearchInProgressChanged();
     }
     job->start();
 }
 
-void UnifiedSearchResultsListModel::parseResultsForProvider(const QJsonObject &data, const QString &providerId, bool fetchedMore)
+UnifiedSearchResultsListModel::SearchResultsPage UnifiedSearchResultsListModel::parseResultsPage(const QJsonObject &data,
+    const UnifiedSearchProvider &provider, const QUrl &accountUrl)
 {
-    const auto cursor = data.value(QStringLiteral("cursor")).toInt();
-    const auto entries = data.value(QStringLiteral("entries")).toVariant().toList();
+    SearchResultsPage page;
+    page._cursor = data.value(QStringLiteral("cursor")).toInt();
+    page._isPaginated = data.value(QStringLiteral("isPaginated")).toBool();
+
+    const auto entries = data.value(QStringLiteral("entries")).toArray();
+    page._entriesCount = entries.size();
+    page._results.reserve(entries.size());
 
+    for (const auto &entry : entries) {
+        const auto entryMap = entry.toObject();
+        if (entryMap.isEmpty()) {
+            continue;
+        }
+        UnifiedSearchResult result;
+        result._providerId = provider._id;
+        result._order = provider._order;
+        result._providerName = provider._name;
+        result._isRounded = entryMap.value(QStringLiteral("rounded")).toBool();
+        result._title = entryMap.value(QStringLiteral("title")).toString();
+        result._subline = entryMap.value(QStringLiteral("subline")).toString();
+
+        const auto resourceUrl = QUrl(entryMap.value(QStringLiteral("resourceUrl")).toString());
+
+        result._resourceUrl = openableResourceUrl(resourceUrl, accountUrl);
+        const auto thumbnailUrl = entryMap.value(QStringLiteral("thumbnailUrl")).toString();
+        const auto icon = entryMap.value(QStringLiteral("icon")).toString();
+        const auto darkIconsData = iconsFromThumbnailAndFallbackIcon(thumbnailUrl, icon, accountUrl, true);
+        const auto lightIconsData = iconsFromThumbnailAndFallbackIcon(thumbnailUrl, icon, accountUrl, false);
+        result._darkIcons = darkIconsData.first;
+        result._lightIcons = lightIconsData.first;
+        result._darkIconsIsThumbnail = darkIconsData.second;
+        result._lightIconsIsThumbnail = lightIconsData.second;
+
+        page._results.push_back(result);
+    }
+
+    return page;
+}
+
+void UnifiedSearchResultsListModel::processResultsForProvider(const SearchResultsPage &page, const QString &providerId, bool fetchedMore)
+{
     auto &provider = _providers[providerId];
 
     if (provider._id.isEmpty() && fetchedMore) {
@@ -549,7 +648,7 @@ void UnifiedSearchResultsListModel::parseResultsForProvider(const QJsonObject &d
         return;
     }
 
-    if (entries.isEmpty()) {
+    if (page._entriesCount == 0) {
         // we may have received false pagination information from the server, such as, we expect more
         // results available via pagination, but, there are no more left, so, we need to stop paginating for
         // this provider
@@ -557,63 +656,116 @@ void UnifiedSearchResultsListModel::parseResultsForProvider(const QJsonObject &d
 
         if (fetchedMore) {
             removeFetchMoreTrigger(provider._id);
+        } else if (_cachedResultsProviderIds.contains(providerId)) {
+            // nothing found this time, drop what the cache showed
+            _pendingResults.insert(providerId, {});
         }
 
         return;
     }
 
-    provider._isPaginated = data.value(QStringLiteral("isPaginated")).toBool();
-    provider._cursor = cursor;
+    provider._isPaginated = page._isPaginated;
+    provider._cursor = page._cursor;
 
     if (provider._pageSize == -1) {
-        provider._pageSize = cursor;
+        provider._pageSize = page._cursor;
     }
 
-    if ((provider._pageSize != -1 && entries.size() < provider._pageSize)
-        || entries.size() < minimumEntresNumberToShowLoadMore) {
+    if ((provider._pageSize != -1 && page._entriesCount < provider._pageSize)
+        || page._entriesCount < minimumEntresNumberToShowLoadMore) {
         // for some providers we are still getting a non-null cursor and isPaginated true even thought
         // there are no more results to paginate
         provider._isPaginated = false;
     }
 
-    QVector<UnifiedSearchResult> newEntries;
+    if (fetchedMore) {
+        appendResultsToProvider(page._results, provider);
+        return;
+    }
 
-    for (const auto &entry : entries) {
-        const auto entryMap = entry.toMap();
-        if (entryMap.isEmpty()) {
-            continue;
-        }
-        UnifiedSearchResult result;
-        result._providerId = provider._id;
-        result._order = provider._order;
-        result._providerName = provider._name;
-        result._isRounded = entryMap.value(QStringLiteral("rounded")).toBool();
-        result._title = entryMap.value(QStringLiteral("title")).toString();
-        result._subline = entryMap.value(QStringLiteral("subline")).toString();
+    auto results = page._results;
+    if (provider._cursor > 0 && provider._isPaginated) {
+        UnifiedSearchResult fetchMoreTrigger;
+        fetchMoreTrigger._providerId = provider._id;
+        fetchMoreTrigger._providerName = provider._name;
+        fetchMoreTrigger._order = provider._order;
+        fetchMoreTrigger._type = UnifiedSearchResult::Type::FetchMoreTrigger;
+        results.push_back(fetchMoreTrigger);
+    }
+    _pendingResults.insert(providerId, results);
+}
 
-        const auto resourceUrl = entryMap.value(QStringLiteral("resourceUrl")).toUrl();
-        const auto accountUrl = (_accountState && _accountState->account()) ? _accountState->account()->url() : QUrl();
+void UnifiedSearchResultsListModel::insertPendingResults()
+{
+    _insertPendingResultsTimer.stop();
 
-        result._resourceUrl = openableResourceUrl(resourceUrl, accountUrl);
-        const auto darkIconsData = iconsFromThumbnailAndFallbackIcon(entryMap.value(QStringLiteral("thumbnailUrl")).toString(),
-                                                                     entryMap.value(QStringLiteral("icon")).toString(), accountUrl, true);
-        const auto lightIconsData = iconsFromThumbnailAndFallbackIcon(entryMap.value(QStringLiteral("thumbnailUrl")).toString(),
-                                                                      entryMap.value(QStringLiteral("icon")).toString(), accountUrl, false);
-        result._darkIcons = darkIconsData.first;
-        result._lightIcons = lightIconsData.first;
-        result._darkIconsIsThumbnail = darkIconsData.second;
-        result._lightIconsIsThumbnail = lightIconsData.second;
+    if (_pendingResults.isEmpty()) {
+        return;
+    }
+
+    auto pendingResults = std::move(_pendingResults);
+    _pendingResults.clear();
 
-        newEntries.push_back(result);
+    for (auto it = pendingResults.cbegin(); it != pendingResults.cend(); ++it) {
+        if (_cachedResultsProviderIds.remove(it.key())) {
+            removeResultsForProvider(it.key());
+        }
     }
 
-    if (fetchedMore) {
-        appendResultsToProvider(newEntries, provider);
-    } else {
-        appendResults(newEntries, provider);
+    if (_results.isEmpty()) {
+        // the common case of a new search: all rows in a single insertion
+        QVector<QVector<UnifiedSearchResult>> providerResults;
+        for (const auto &results : qAsConst(pendingResults)) {
+            if (!results.isEmpty()) {
+                providerResults.push_back(results);
+            }
+        }
+        if (providerResults.isEmpty()) {
+            return;
+        }
+        std::stable_sort(std::begin(providerResults), std::end(providerResults),
+            [](const QVector<UnifiedSearchResult> &lhs, const QVector<UnifiedSearchResult> &rhs) {
+                const auto &left = lhs.first();
+                const auto &right = rhs.first();
+                return left._order < right._order || (left._order == right._order && left._providerName < right._providerName);
+            });
+
+        QVector<UnifiedSearchResult> allResults;
+        for (const auto &results : qAsConst(providerResults)) {
+            allResults += results;
+        }
+        beginInsertRows({}, 0, allResults.size() - 1);
+        _results = allResults;
+        endInsertRows();
+        return;
+    }
+
+    for (auto it = pendingResults.cbegin(); it != pendingResults.cend(); ++it) {
+        if (!it.value().isEmpty()) {
+            appendResults(it.value(), _providers.value(it.key()));
+        }
     }
 }
 
+void UnifiedSearchResultsListModel::removeResultsForProvider(const QString &providerId)
+{
+    const auto isFromProvider = [&providerId](const UnifiedSearchResult &result) {
+        return result._providerId == providerId;
+    };
+    const auto first = std::find_if(std::begin(_results), std::end(_results), isFromProvider);
+    if (first == std::end(_results)) {
+        return;
+    }
+    // the rows of a provider are next to each other
+    const auto last = std::find_if_not(first, std::end(_results), isFromProvider);
+    const auto firstRow = static_cast<int>(std::distance(std::begin(_results), first));
+    const auto lastRow = static_cast<int>(std::distance(std::begin(_results), last)) - 1;
+
+    beginRemoveRows({}, firstRow, lastRow);
+    _results.erase(first, last);
+    endRemoveRows();
+}
+
 QUrl UnifiedSearchResultsListModel::openableResourceUrl(const QUrl &resourceUrl, const QUrl &accountUrl)
 {
     if (!resourceUrl.isRelative()) {
@@ -625,18 +777,8 @@ QUrl UnifiedSearchResultsListModel::openableResourceUrl(const QUrl &resourceUrl,
     return finalResourceUrl;
 }
 
-void UnifiedSearchResultsListModel::appendResults(QVector<UnifiedSearchResult> results, const UnifiedSearchProvider &provider)
+void UnifiedSearchResultsListModel::appendResults(const QVector<UnifiedSearchResult> &results, const UnifiedSearchProvider &provider)
 {
-    if (provider._cursor > 0 && provider._isPaginated) {
-        UnifiedSearchResult fetchMoreTrigger;
-        fetchMoreTrigger._providerId = provider._id;
-        fetchMoreTrigger._providerName = provider._name;
-        fetchMoreTrigger._order = provider._order;
-        fetchMoreTrigger._type = UnifiedSearchResult::Type::FetchMoreTrigger;
-        results.push_back(fetchMoreTrigger);
-    }
-
-
     if (_results.isEmpty()) {
         beginInsertRows({}, 0, results.size() - 1);
         _results = results;
@@ -725,14 +867,22 @@ void UnifiedSearchResultsListModel::removeFetchMoreTrigger(const QString &provid
 
 void UnifiedSearchResultsListModel::disconnectAndClearSearchJobs()
 {
-    for (const auto &connection : qAsConst(_searchJobConnections)) {
-        if (connection) {
-            QObject::disconnect(connection);
+    // replies and parse results still on their way belong to an older generation now
+    ++_searchGeneration;
+    _pendingResults.clear();
+    _insertPendingResultsTimer.stop();
+
+    for (const auto &job : qAsConst(_searchJobs)) {
+        if (job) {
+            QObject::disconnect(job, nullptr, this, nullptr);
+            if (job->reply()) {
+                job->reply()->abort();
+            }
         }
     }
 
-    if (!_searchJobConnections.isEmpty()) {
-        _searchJobConnections.clear();
+    if (!_searchJobs.isEmpty()) {
+        _searchJobs.clear();
         emit isSearchInProgressChanged();
     }
 }
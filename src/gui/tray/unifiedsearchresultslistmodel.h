@@ -22,11 +22,18 @@
 
 namespace OCC {
 class AccountState;
+class JsonApiJob;
 
 /**
  * @brief The UnifiedSearchResultsListModel
  * @ingroup gui
  * Simple list model to provide the list view with data for the Unified Search results.
+ *
+ * A new search term aborts the searches still running for the previous one.
+ * Provider replies are turned into results on a worker thread, and results
+ * arriving close together are inserted into the model in one go. The results
+ * of recent search terms are kept, so searching for one of them again shows
+ * those right away while they are refreshed.
  */
 
 class UnifiedSearchResultsListModel : public QAbstractListModel
@@ -50,6 +57,21 @@ class UnifiedSearchResultsListModel : public QAbstractListModel
         qint32 _order = std::numeric_limits<qint32>::max(); // sorting order (smaller number has bigger priority)
     };
 
+    // one page of search results, as parsed on a worker thread
+    struct SearchResultsPage
+    {
+        qint32 _cursor = 0;
+        bool _isPaginated = false;
+        int _entriesCount = 0;
+        QVector<UnifiedSearchResult> _results;
+    };
+
+    struct CachedSearch
+    {
+        QVector<UnifiedSearchResult> _results;
+        QMap<QString, UnifiedSearchProvider> _providers;
+    };
+
 public:
     enum DataRole {
         ProviderNameRole = Qt::UserRole + 1,
@@ -89,10 +111,16 @@ private:
     void startSearch();
     void startSearchForProvider(const QString &providerId, qint32 cursor = -1);
 
-    void parseResultsForProvider(const QJsonObject &data, const QString &providerId, bool fetchedMore = false);
+    static SearchResultsPage parseResultsPage(const QJsonObject &data, const UnifiedSearchProvider &provider, const QUrl &accountUrl);
+    void processResultsForProvider(const SearchResultsPage &page, const QString &providerId, bool fetchedMore = false);
+    void finishSearchForProvider(const QString &providerId);
+
+    // insert the initial results of all providers that arrived since the last call
+    void insertPendingResults();
+    void removeResultsForProvider(const QString &providerId);
 
     // append initial search results to the list
-    void appendResults(QVector<UnifiedSearchResult> results, const UnifiedSearchProvider &provider);
+    void appendResults(const QVector<UnifiedSearchResult> &results, const UnifiedSearchProvider &provider);
 
     // append pagination results to existing results from the initial search
     void appendResultsToProvider(const QVector<UnifiedSearchResult> &results, const UnifiedSearchProvider &provider);
@@ -124,13 +152,24 @@ private:
     QMap<QString, UnifiedSearchProvider> _providers;
     QVector<UnifiedSearchResult> _results;
 
+    // initial results per provider, waiting for insertPendingResults()
+    QMap<QString, QVector<UnifiedSearchResult>> _pendingResults;
+    QTimer _insertPendingResultsTimer;
+
+    // recent search terms and their results, shown while a search for them runs again
+    QCache<QString, CachedSearch> _searchCache;
+    // providers whose rows still come from _searchCache
+    QSet<QString> _cachedResultsProviderIds;
+
     QString _searchTerm;
     QString _errorString;
     bool _waitingForSearchTermEditEnd = false;
 
     QString _currentFetchMoreInProgressProviderId;
 
-    QMap<QString, QMetaObject::Connection> _searchJobConnections;
+    QMap<QString, QPointer<JsonApiJob>> _searchJobs;
+    // tells apart replies and parse results of the current searches from those of aborted ones
+    quint64 _searchGeneration = 0;
 
     QTimer _unifiedSearchTextEditingFinishedTimer;
 
@@ -33,6 +33,8 @@
 namespace {
 constexpr qint64 expiredActivitiesCheckIntervalMsecs = 1000 * 60;
 constexpr qint64 activityDefaultExpirationTimeMsecs = 1000 * 60 * 10;
+// while push notifications work, polling only catches what the websocket missed
+constexpr auto pushNotificationsRefreshIntervalFactor = 10;
 }
 
 namespace OCC {
@@ -275,10 +277,12 @@ void User::slotBuildIncomingCallDialogs(const ActivityList &list)
 
 void User::setNotificationRefreshInterval(std::chrono::milliseconds interval)
 {
-    if (!checkPushNotificationsAreReady()) {
-        qCDebug(lcActivity) << "Starting Notification refresh timer with " << interval.count() / 1000 << " sec interval";
-        _notificationCheckTimer.start(interval.count());
+    _notificationRefreshInterval = interval;
+    if (checkPushNotificationsAreReady()) {
+        interval *= pushNotificationsRefreshIntervalFactor;
     }
+    qCDebug(lcActivity) << "Starting Notification refresh timer with " << interval.count() / 1000 << " sec interval";
+    _notificationCheckTimer.start(interval.count());
 }
 
 void User::slotPushNotificationsReady()
@@ -286,8 +290,8 @@ void User::slotPushNotificationsReady()
     qCInfo(lcActivity) << "Push notifications are ready";
 
     if (_notificationCheckTimer.isActive()) {
-        // as we are now able to use push notifications - let's stop the polling timer
-        _notificationCheckTimer.stop();
+        // as we are now able to use push notifications - let's back off the polling timer
+        setNotificationRefreshInterval(_notificationRefreshInterval);
     }
 
     connectPushNotifications();
@@ -400,8 +404,12 @@ void User::slotRefresh()
     slotRefreshUserStatus();
     
     if (checkPushNotificationsAreReady()) {
-        // we are relying on WebSocket push notifications - ignore refresh attempts from UI
+        // we are relying on WebSocket push notifications - only fetch the notifications
+        // in case one was missed, which is a 304 with the ETag if nothing changed
         slotRefreshActivitiesInitial();
+        if (_account.data() && _account.data()->isConnected()) {
+            slotRefreshNotifications();
+        }
         _timeSinceLastCheck[_account.data()].invalidate();
         return;
     }
@@ -748,15 +756,15 @@ bool User::isActivityOfCurrentAccount(const Folder *folder) const
     return folder->accountState() == _account.data();
 }
 
-bool User::isUnsolvableConflict(const SyncFileItemPtr &item) const
+bool User::isUnsolvableConflict(const CompletedSyncItemPtr &item) const
 {
     // We just care about conflict issues that we are able to resolve
-    return item->_status == SyncFileItem::Conflict && !Utility::isConflictFile(item->_file);
+    return item->status() == SyncFileItem::Conflict && !Utility::isConflictFile(item->file());
 }
 
-void User::processCompletedSyncItem(const Folder *folder, const SyncFileItemPtr &item)
+void User::processCompletedSyncItem(const Folder *folder, const CompletedSyncItemPtr &item)
 {
-    if (item->_direction == SyncFileItem::Down && item->_instruction == CSYNC_INSTRUCTION_SYNC) {
+    if (item->direction() == SyncFileItem::Down && item->instruction() == CSYNC_INSTRUCTION_SYNC) {
         qCDebug(lcActivity) << "Skipping activities about changes coming from server.";
         return;
     }
@@ -788,35 +796,32 @@ void User::processCompletedSyncItem(const Folder *folder, const SyncFileItemPtr
     Activity activity;
     activity._type = Activity::SyncFileItemType; //client activity
     activity._objectType = QStringLiteral("files");
-    activity._syncFileItemStatus = item->_status;
+    activity._syncFileItemStatus = item->status();
     activity._dateTime = QDateTime::currentDateTime();
-    activity._message = item->_originalFile;
+    activity._message = item->originalFile();
     activity._link = account()->url();
     activity._accName = account()->displayName();
-    activity._file = item->_file;
+    activity._file = item->file();
     activity._folder = folder->alias();
     activity._fileAction = "";
 
-    const auto fileName = QFileInfo(item->_originalFile).fileName();
+    const auto fileName = QFileInfo(item->originalFile()).fileName();
 
-    activity._fileAction = fileActionFromInstruction(item->_instruction);
+    activity._fileAction = fileActionFromInstruction(item->instruction());
 
-    if (item->_status == SyncFileItem::NoStatus || item->_status == SyncFileItem::Success) {
-        qCWarning(lcActivity) << "Item " << item->_file << " retrieved successfully.";
+    if (item->status() == SyncFileItem::NoStatus || item->status() == SyncFileItem::Success) {
+        qCWarning(lcActivity) << "Item " << item->file() << " retrieved successfully.";
 
-        if (item->_direction != SyncFileItem::Up) {
+        if (item->direction() != SyncFileItem::Up) {
             activity._message = QObject::tr("Synced %1").arg(fileName);
         } else {
             activity._message = messageFromFileAction(activity._fileAction, fileName);
         }
 
         if(activity._fileAction != "file_deleted" && !item->isEmpty()) {
-            const auto localFiles = FolderMan::instance()->findFileInLocalFolders(folder->remotePathTrailingSlash() + item->_file, account());
+            const auto localFiles = FolderMan::instance()->findFileInLocalFolders(folder->remotePathTrailingSlash() + item->file(), account());
             if (!localFiles.isEmpty()) {
-                const auto firstFilePath = localFiles.constFirst();
-                const auto itemJournalRecord = item->toSyncJournalFileRecordWithInode(firstFilePath);
-
-                if(!itemJournalRecord.isVirtualFile()) {
+                if(!item->isVirtualFile()) {
                     const auto mimeType = _mimeDb.mimeTypeForFile(QFileInfo(localFiles.constFirst()));
 
                     // Set the preview data, though for now we can skip setting file ID, link, and view
@@ -837,18 +842,18 @@ void User::processCompletedSyncItem(const Folder *folder, const SyncFileItemPtr
 
         _activityModel->addSyncFileItemToActivityList(activity);
     } else {
-        qCWarning(lcActivity) << "Item " << item->_file << " retrieved resulted in error " << item->_errorString;
+        qCWarning(lcActivity) << "Item " << item->file() << " retrieved resulted in error " << item->errorString();
 
-        activity._subject = item->_errorString;
+        activity._subject = item->errorString();
         activity._id = -static_cast<int>(qHash(activity._subject + activity._message));
 
-        if (item->_status == SyncFileItem::Status::FileIgnored) {
+        if (item->status() == SyncFileItem::Status::FileIgnored) {
             _activityModel->addIgnoredFileToList(activity);
         } else {
             // add 'protocol error' to activity list
-            if (item->_status == SyncFileItem::Status::FileNameInvalid) {
-                showDesktopNotification(item->_file, activity._subject, activity._id);
-            } else if (item->_status == SyncFileItem::Conflict || item->_status == SyncFileItem::FileNameClash) {
+            if (item->status() == SyncFileItem::Status::FileNameInvalid) {
+                showDesktopNotification(item->file(), activity._subject, activity._id);
+            } else if (item->status() == SyncFileItem::Conflict || item->status() == SyncFileItem::FileNameClash) {
                 ActivityLink buttonActivityLink;
                 buttonActivityLink._label = tr("Resolve conflict");
                 buttonActivityLink._link = activity._link.toString();
@@ -867,7 +872,7 @@ const QVariantList &User::groupFolders() const
     return _trayFolderInfos;
 }
 
-void User::slotItemCompleted(const QString &folder, const SyncFileItemPtr &item)
+void User::slotItemCompleted(const QString &folder, const CompletedSyncItemPtr &item)
 {
     auto folderInstance = FolderMan::instance()->folder(folder);
 
@@ -875,7 +880,7 @@ void User::slotItemCompleted(const QString &folder, const SyncFileItemPtr &item)
         return;
     }
 
-    qCWarning(lcActivity) << "Item " << item->_file << " retrieved resulted in " << item->_errorString;
+    qCWarning(lcActivity) << "Item " << item->file() << " retrieved resulted in " << item->errorString();
     processCompletedSyncItem(folderInstance, item);
 }
 
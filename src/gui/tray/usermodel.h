@@ -97,7 +97,7 @@ public:
     [[nodiscard]] QString statusMessage() const;
     [[nodiscard]] QUrl statusIcon() const;
     [[nodiscard]] QString statusEmoji() const;
-    void processCompletedSyncItem(const Folder *folder, const SyncFileItemPtr &item);
+    void processCompletedSyncItem(const Folder *folder, const CompletedSyncItemPtr &item);
     [[nodiscard]] const QVariantList &groupFolders() const;
 
 signals:
@@ -115,7 +115,7 @@ signals:
     void groupFoldersChanged();
 
 public slots:
-    void slotItemCompleted(const QString &folder, const OCC::SyncFileItemPtr &item);
+    void slotItemCompleted(const QString &folder, const OCC::CompletedSyncItemPtr &item);
     void slotProgressInfo(const QString &folder, const OCC::ProgressInfo &progress);
     void slotAddError(const QString &folderAlias, const QString &message, OCC::ErrorCategory category);
     void slotAddErrorToGui(const QString &folderAlias, const OCC::SyncFileItem::Status status, const QString &errorMessage, const QString &subject, const OCC::ErrorCategory category);
@@ -161,7 +161,7 @@ private:
     [[nodiscard]] bool checkPushNotificationsAreReady() const;
 
     bool isActivityOfCurrentAccount(const Folder *folder) const;
-    [[nodiscard]] bool isUnsolvableConflict(const SyncFileItemPtr &item) const;
+    [[nodiscard]] bool isUnsolvableConflict(const CompletedSyncItemPtr &item) const;
 
     bool notificationAlreadyShown(const long notificationId);
     bool canShowNotification(const long notificationId);
@@ -178,6 +178,7 @@ private:
 
     QTimer _expiredActivitiesCheckTimer;
     QTimer _notificationCheckTimer;
+    std::chrono::milliseconds _notificationRefreshInterval{0}; // as configured, see setNotificationRefreshInterval()
     QHash<AccountState *, QElapsedTimer> _timeSinceLastCheck;
 
     QElapsedTimer _guiLogTimer;
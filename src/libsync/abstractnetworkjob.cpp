@@ -68,6 +68,10 @@ AbstractNetworkJob::AbstractNetworkJob(const AccountPtr &account, const QString
     if (_account) {
         connect(_account.data(), &Account::propagatorNetworkActivity, this, &AbstractNetworkJob::resetTimeout);
     }
+
+    if (NetworkTimings::isEnabled()) {
+        _queuedMsec = NetworkTimings::now();
+    }
 }
 
 void AbstractNetworkJob::setReply(QNetworkReply *reply)
@@ -161,9 +165,58 @@ void AbstractNetworkJob::adoptRequest(QNetworkReply *reply)
     addTimer(reply);
     setReply(reply);
     setupConnections(reply);
+    if (NetworkTimings::isEnabled()) {
+        startTiming(reply);
+    }
     newReplyHook(reply);
 }
 
+void AbstractNetworkJob::startTiming(QNetworkReply *reply)
+{
+    _timings = NetworkTimings::attachedTo(this);
+    if (!_timings) {
+        // not started by a sync engine
+        return;
+    }
+
+    const auto now = NetworkTimings::now();
+    _timing = std::make_unique<NetworkTimings::Request>();
+    _timing->verb = HttpLogger::requestVerb(*reply);
+    _timing->url = reply->request().url();
+    _timing->startedDateTime = QDateTime::currentDateTimeUtc();
+    _timing->createdMsec = _queuedMsec >= 0 ? _queuedMsec : now;
+    _timing->sentMsec = now;
+
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply] {
+        if (_timing && reply == _reply && _timing->firstByteMsec < 0) {
+            _timing->firstByteMsec = NetworkTimings::now();
+        }
+    });
+    connect(reply, &QNetworkReply::uploadProgress, this, [this, reply](qint64 bytesSent, qint64) {
+        if (_timing && reply == _reply) {
+            _timing->bytesSent = bytesSent;
+        }
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply](qint64 bytesReceived, qint64) {
+        if (_timing && reply == _reply) {
+            _timing->bytesReceived = bytesReceived;
+        }
+    });
+}
+
+void AbstractNetworkJob::recordTiming()
+{
+    if (!_timing) {
+        return;
+    }
+    _timing->finishedMsec = NetworkTimings::now();
+    _timing->httpStatus = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    _timing->requestId = requestId();
+    _timings->record(*_timing, _account->url());
+    _queuedMsec = _timing->finishedMsec;
+    _timing.reset();
+}
+
 QUrl AbstractNetworkJob::makeAccountUrl(const QString &relativePath) const
 {
     return Utility::concatUrlPath(_account->url(), relativePath);
@@ -177,6 +230,7 @@ QUrl AbstractNetworkJob::makeDavUrl(const QString &relativePath) const
 void AbstractNetworkJob::slotFinished()
 {
     _timer.stop();
+    recordTiming();
 
     if (_reply->error() == QNetworkReply::SslHandshakeFailedError) {
         qCWarning(lcNetworkJob) << "SslHandshakeFailedError: " << errorString() << " : can be caused by a webserver wanting SSL client certificates";
@@ -25,6 +25,9 @@
 #include <QTimer>
 #include "accountfwd.h"
 #include "common/asserts.h"
+#include "networktimings.h"
+
+#include <memory>
 
 class QUrl;
 
@@ -208,6 +211,8 @@ protected:
 
 private:
     QNetworkReply *addTimer(QNetworkReply *reply);
+    void startTiming(QNetworkReply *reply);
+    void recordTiming();
     bool _ignoreCredentialFailure = false;
     QPointer<QNetworkReply> _reply; // (QPointer because the NetworkManager may be destroyed before the jobs at exit)
     QString _path;
@@ -220,6 +225,12 @@ private:
     //
     // Reparented to the currently running QNetworkReply.
     QPointer<QIODevice> _requestBody;
+
+    // Only used while NetworkTimings::isEnabled(). A resent or redirected
+    // request is queued from the moment the previous one finished.
+    qint64 _queuedMsec = -1;
+    std::unique_ptr<NetworkTimings::Request> _timing;
+    QSharedPointer<NetworkTimings> _timings; // of the sync engine the job belongs to
 };
 
 /**
@@ -93,6 +93,16 @@ ClientSideEncryption* Account::e2e()
     return &_e2e;
 }
 
+UploadedContentRegistry *Account::uploadedContentRegistry()
+{
+    return &_uploadedContentRegistry;
+}
+
+RemoteTreeIndex *Account::remoteTreeIndex()
+{
+    return &_remoteTreeIndex;
+}
+
 Account::~Account() = default;
 
 QString Account::davPath() const
@@ -36,6 +36,8 @@
 #include "clientstatusreporting.h"
 #include "common/utility.h"
 #include "syncfileitem.h"
+#include "remotetreeindex.h"
+#include "uploadedcontentregistry.h"
 
 #include <memory>
 
@@ -290,6 +292,16 @@ public:
 
     ClientSideEncryption* e2e();
 
+    /// Content recently uploaded by any folder of this account, see PropagateUploadFileCommon
+    UploadedContentRegistry *uploadedContentRegistry();
+
+    /// Folders seen by the recent directory listings, see LsColJob
+    RemoteTreeIndex *remoteTreeIndex();
+
+    /// Set once the server refused or did not decode a gzip encoded upload
+    [[nodiscard]] bool compressedUploadsRejected() const { return _compressedUploadsRejected; }
+    void setCompressedUploadsRejected() { _compressedUploadsRejected = true; }
+
     /// Used in RemoteWipe
     void retrieveAppPassword();
     void writeAppPasswordOnce(QString appPassword);
@@ -435,6 +447,10 @@ private:
 
     ClientSideEncryption _e2e;
 
+    UploadedContentRegistry _uploadedContentRegistry;
+    RemoteTreeIndex _remoteTreeIndex;
+    bool _compressedUploadsRejected = false;
+
     /// Used in RemoteWipe
     bool _wroteAppPassword = false;
 
@@ -65,6 +65,7 @@ public:
     [[nodiscard]] int shareDefaultPermissions() const;
     [[nodiscard]] bool chunkingNg() const;
     [[nodiscard]] bool bulkUpload() const;
+
     [[nodiscard]] bool filesLockAvailable() const;
     [[nodiscard]] bool filesLockTypeAvailable() const;
     [[nodiscard]] bool userStatus() const;
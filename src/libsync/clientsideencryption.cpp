@@ -1220,6 +1220,48 @@ void ClientSideEncryption::getUsersPublicKeyFromServer(const AccountPtr &account
     job->start();
 }
 
+QByteArray ClientSideEncryption::decryptWithPrivateKey(const QByteArray &data)
+{
+    if (_privateKey.isEmpty()) {
+        qCWarning(lcCse) << "No private key to decrypt with";
+        return {};
+    }
+
+    if (!_parsedPrivateKey || _parsedPrivateKeyPem != _privateKey) {
+        forgetParsedPrivateKey();
+        Bio privateKeyBio;
+        BIO_write(privateKeyBio, _privateKey.constData(), _privateKey.size());
+        _parsedPrivateKey.emplace(PKey::readPrivateKey(privateKeyBio));
+        _parsedPrivateKeyPem = _privateKey;
+    }
+
+    if (const auto decrypted = _privateKeyDecryptions.object(data)) {
+        return *decrypted;
+    }
+
+    const auto decryptResult = EncryptionHelper::decryptStringAsymmetric(*_parsedPrivateKey, data);
+    if (!decryptResult.isEmpty()) {
+        _privateKeyDecryptions.insert(data, new QByteArray(decryptResult));
+    }
+    return decryptResult;
+}
+
+QByteArray ClientSideEncryption::localCacheKey() const
+{
+    if (_privateKey.isEmpty()) {
+        return {};
+    }
+    // AES-128 key, see EncryptionHelper::encryptStringSymmetric
+    return QCryptographicHash::hash(_privateKey + QByteArrayLiteral("local-cache"), QCryptographicHash::Sha256).left(16);
+}
+
+void ClientSideEncryption::forgetParsedPrivateKey()
+{
+    _parsedPrivateKey.reset();
+    _parsedPrivateKeyPem.clear();
+    _privateKeyDecryptions.clear();
+}
+
 void ClientSideEncryption::handlePrivateKeyDeleted(const QKeychain::Job* const incoming)
 {
     const auto error = incoming->error();
@@ -1230,6 +1272,7 @@ void ClientSideEncryption::handlePrivateKeyDeleted(const QKeychain::Job* const i
 
     qCDebug(lcCse) << "Private key successfully deleted from keychain. Clearing.";
     _privateKey = QByteArray();
+    forgetParsedPrivateKey();
     Q_EMIT privateKeyDeleted();
     checkAllSensitiveDataDeleted();
 }
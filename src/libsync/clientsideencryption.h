@@ -12,9 +12,12 @@
 #include <QFile>
 #include <QVector>
 #include <QMap>
+#include <QCache>
 
 #include <openssl/evp.h>
 
+#include <optional>
+
 #include "accountfwd.h"
 #include "networkjobs.h"
 
@@ -150,6 +153,17 @@ public:
     [[nodiscard]] QByteArray generateSignatureCryptographicMessageSyntax(const QByteArray &data) const;
     [[nodiscard]] bool verifySignatureCryptographicMessageSyntax(const QByteArray &cmsContent, const QByteArray &data, const QVector<QByteArray> &certificatePems) const;
 
+    /**
+     * Decrypts data with _privateKey.
+     *
+     * The parsed private key and the recent results are kept, as the same
+     * metadata keys get unwrapped for every encrypted folder on every sync.
+     */
+    [[nodiscard]] QByteArray decryptWithPrivateKey(const QByteArray &data);
+
+    /// Key to encrypt what is stored locally about encrypted folders, empty without a private key
+    [[nodiscard]] QByteArray localCacheKey() const;
+
 public slots:
     void initialize(const OCC::AccountPtr &account);
     void forgetSensitiveData(const OCC::AccountPtr &account);
@@ -185,6 +199,7 @@ private slots:
 
 private:
     void generateMnemonic();
+    void forgetParsedPrivateKey();
 
     [[nodiscard]] std::pair<QByteArray, PKey> generateCSR(const AccountPtr &account,
                                                           PKey keyPair,
@@ -227,6 +242,11 @@ private:
     void failedToInitialize(const AccountPtr &account);
 
     bool isInitialized = false;
+
+    // _privateKey as it was parsed, and the data it decrypted since
+    QByteArray _parsedPrivateKeyPem;
+    std::optional<PKey> _parsedPrivateKey;
+    QCache<QByteArray, QByteArray> _privateKeyDecryptions{1000};
 };
 } // namespace OCC
 #endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "completedsyncitem.h"
+#include "progressdispatcher.h"
+
+namespace OCC {
+
+CompletedSyncItemPtr CompletedSyncItem::create(const SyncFileItem &item, ErrorCategory category)
+{
+    // make_shared is not usable with the private constructor
+    const auto record = new CompletedSyncItem;
+
+    record->_file = item._file;
+    record->_renameTarget = item._renameTarget;
+    // Most items are not moved: share the file name storage instead of keeping two copies around
+    record->_originalFile = item._originalFile == item._file ? record->_file : item._originalFile;
+    record->_errorString = item._errorString;
+
+    record->_etag = item._etag;
+    record->_fileId = item._fileId;
+    record->_requestId = item._requestId;
+    record->_responseTimeStamp = item._responseTimeStamp;
+
+    record->_size = item._size;
+    record->_previousSize = item._previousSize;
+    record->_modtime = item._modtime;
+    record->_previousModtime = item._previousModtime;
+
+    record->_instruction = item._instruction;
+    record->_httpErrorCode = item._httpErrorCode;
+    record->_status = static_cast<quint8>(item._status);
+    record->_direction = static_cast<quint8>(item._direction);
+    record->_type = static_cast<quint8>(item._type);
+    record->_errorCategory = static_cast<quint8>(category);
+
+    return CompletedSyncItemPtr(record);
+}
+
+bool CompletedSyncItem::hasErrorStatus() const
+{
+    const auto itemStatus = status();
+    return itemStatus == SyncFileItem::SoftError
+        || itemStatus == SyncFileItem::NormalError
+        || itemStatus == SyncFileItem::FatalError
+        || !_errorString.isEmpty();
+}
+
+}
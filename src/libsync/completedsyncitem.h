@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+#include "syncfileitem.h"
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+namespace OCC {
+
+enum class ErrorCategory;
+
+class CompletedSyncItem;
+using CompletedSyncItemPtr = QSharedPointer<const CompletedSyncItem>;
+
+/**
+ * @brief Immutable snapshot of a finished SyncFileItem for observers
+ *
+ * A finished item is reported to several listeners (the sync run log, the
+ * activity list of every account, the sync result). Instead of each of them
+ * copying or re-deriving data from the mutable SyncFileItem, the folder builds
+ * one CompletedSyncItem per finished item and hands out the same shared
+ * pointer to everyone.
+ *
+ * Paths are implicitly shared with the engine's item, and the original file
+ * name reuses the storage of the file name when both are equal, so creating a
+ * record does not allocate any string data. Enumerations are stored in their
+ * narrowest form.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT CompletedSyncItem
+{
+public:
+    static CompletedSyncItemPtr create(const SyncFileItem &item, ErrorCategory category);
+
+    [[nodiscard]] const QString &file() const { return _file; }
+    [[nodiscard]] const QString &renameTarget() const { return _renameTarget; }
+    [[nodiscard]] const QString &originalFile() const { return _originalFile; }
+    [[nodiscard]] const QString &destination() const { return _renameTarget.isEmpty() ? _file : _renameTarget; }
+    [[nodiscard]] const QString &errorString() const { return _errorString; }
+
+    [[nodiscard]] const QByteArray &etag() const { return _etag; }
+    [[nodiscard]] const QByteArray &fileId() const { return _fileId; }
+    [[nodiscard]] const QByteArray &requestId() const { return _requestId; }
+    [[nodiscard]] const QByteArray &responseTimeStamp() const { return _responseTimeStamp; }
+
+    [[nodiscard]] SyncInstructions instruction() const { return _instruction; }
+    [[nodiscard]] SyncFileItem::Status status() const { return static_cast<SyncFileItem::Status>(_status); }
+    [[nodiscard]] SyncFileItem::Direction direction() const { return static_cast<SyncFileItem::Direction>(_direction); }
+    [[nodiscard]] ItemType type() const { return static_cast<ItemType>(_type); }
+    [[nodiscard]] ErrorCategory errorCategory() const { return static_cast<ErrorCategory>(_errorCategory); }
+    [[nodiscard]] quint16 httpErrorCode() const { return _httpErrorCode; }
+
+    [[nodiscard]] qint64 size() const { return _size; }
+    [[nodiscard]] qint64 previousSize() const { return _previousSize; }
+    [[nodiscard]] time_t modtime() const { return _modtime; }
+    [[nodiscard]] time_t previousModtime() const { return _previousModtime; }
+
+    [[nodiscard]] bool isEmpty() const { return _file.isEmpty(); }
+    [[nodiscard]] bool isDirectory() const { return type() == ItemTypeDirectory; }
+    [[nodiscard]] bool isVirtualFile() const { return type() == ItemTypeVirtualFile || type() == ItemTypeVirtualFileDownload; }
+    [[nodiscard]] bool hasErrorStatus() const;
+
+private:
+    CompletedSyncItem() = default;
+
+    QString _file;
+    QString _renameTarget;
+    QString _originalFile;
+    QString _errorString;
+
+    QByteArray _etag;
+    QByteArray _fileId;
+    QByteArray _requestId;
+    QByteArray _responseTimeStamp;
+
+    qint64 _size = 0;
+    qint64 _previousSize = 0;
+    time_t _modtime = 0;
+    time_t _previousModtime = 0;
+
+    SyncInstructions _instruction = CSYNC_INSTRUCTION_NONE;
+    quint16 _httpErrorCode = 0;
+    quint8 _status = SyncFileItem::NoStatus;
+    quint8 _direction = SyncFileItem::None;
+    quint8 _type = ItemTypeSkip;
+    quint8 _errorCategory = 0;
+};
+
+}
+
+Q_DECLARE_METATYPE(OCC::CompletedSyncItemPtr)
@@ -82,8 +82,6 @@ void ProcessDirectoryJob::start()
 {
     qCInfo(lcDisco) << "STARTING" << _currentFolder._server << _queryServer << _currentFolder._local << _queryLocal;
 
-    _discoveryData->_noCaseConflictRecordsInDb = _discoveryData->_statedb->caseClashConflictRecordPaths().isEmpty();
-
     if (_queryServer == NormalQuery) {
         _serverJob = startAsyncServerQuery();
     } else {
@@ -411,7 +409,7 @@ bool ProcessDirectoryJob::handleExcluded(const QString &path, const Entries &ent
 
 bool ProcessDirectoryJob::canRemoveCaseClashConflictedCopy(const QString &path, const std::map<QString, Entries> &allEntries)
 {
-    const auto conflictRecord = _discoveryData->_statedb->caseConflictRecordByPath(path.toUtf8());
+    const auto conflictRecord = _discoveryData->caseClashConflictRecordByPath(path);
     const auto originalBaseFileName = QFileInfo(QString(_discoveryData->_localDir + "/" + conflictRecord.initialBasePath)).fileName();
 
     if (allEntries.find(originalBaseFileName) == allEntries.end()) {
@@ -420,17 +418,19 @@ bool ProcessDirectoryJob::canRemoveCaseClashConflictedCopy(const QString &path,
         return true;
     }
 
-    auto numMatchingEntries = 0;
-    for (auto it = allEntries.cbegin(); it != allEntries.cend(); ++it) {
-        if (it->first.compare(originalBaseFileName, Qt::CaseInsensitive) == 0 && it->second.serverEntry.isValid()) {
-            // only case-insensitive matching entries that are present on the server
-            ++numMatchingEntries;
-        }
-        if (numMatchingEntries >= 2) {
-            break;
+    // Built once per listing: a directory with many clashes doesn't compare every name for each of them
+    if (!_serverEntriesByFoldedNameBuilt) {
+        for (auto it = allEntries.cbegin(); it != allEntries.cend(); ++it) {
+            if (it->second.serverEntry.isValid()) {
+                ++_serverEntriesByFoldedName[it->first.toCaseFolded()];
+            }
         }
+        _serverEntriesByFoldedNameBuilt = true;
     }
 
+    // only case-insensitive matching entries that are present on the server
+    const auto numMatchingEntries = _serverEntriesByFoldedName.value(originalBaseFileName.toCaseFolded());
+
     if (numMatchingEntries < 2) {
         // original entry is present on the server but there is no case-clash conflict anymore, remove conflicted copy (only 1 matching file found during case-insensitive search)
         qCDebug(lcDisco) << "original entry:" << originalBaseFileName << "is present on the server, but there is no case-clas conflict anymore, remove conflicted copy:" << path;
@@ -816,9 +816,7 @@ void ProcessDirectoryJob::processFileAnalyzeRemoteInfo(const SyncFileItemPtr &it
     item->_modtime = serverEntry.modtime;
     item->_size = serverEntry.size;
 
-    const auto conflictRecord = _discoveryData->_noCaseConflictRecordsInDb
-        ? ConflictRecord{} :
-        _discoveryData->_statedb->caseConflictRecordByBasePath(item->_file);
+    const auto conflictRecord = _discoveryData->caseClashConflictRecordByBasePath(item->_file);
     if (conflictRecord.isValid() && QString::fromUtf8(conflictRecord.path).contains(QStringLiteral("(case clash from"))) {
         qCInfo(lcDisco) << "should ignore" << item->_file << "has already a case clash conflict record" << conflictRecord.path;
 
@@ -1253,7 +1251,7 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
         item->_instruction = CSYNC_INSTRUCTION_CONFLICT;
     }
 
-    auto conflictRecord = _discoveryData->_statedb->caseConflictRecordByBasePath(item->_file);
+    auto conflictRecord = _discoveryData->caseClashConflictRecordByBasePath(item->_file);
     if (conflictRecord.isValid() && QString::fromUtf8(conflictRecord.path).contains(QStringLiteral("(case clash from"))) {
         qCInfo(lcDisco) << "should ignore" << item->_file << "has already a case clash conflict record" << conflictRecord.path;
 
@@ -1410,6 +1408,7 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
             item->_e2eEncryptionServerCapability = EncryptionStatusEnums::fromEndToEndEncryptionApiVersion(_discoveryData->_account->capabilities().clientSideEncryptionVersion());
         }
         postProcessLocalNew();
+        processFileDetectLocalCopy(item, path, localEntry);
         /*if (item->isDirectory() && item->_instruction == CSYNC_INSTRUCTION_NEW && item->_direction == SyncFileItem::Up
             && _discoveryData->_account->capabilities().clientSideEncryptionVersion() >= 2.0) {
             OCC::SyncJournalFileRecord rec;
@@ -1538,6 +1537,52 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
     finalize();
 }
 
+void ProcessDirectoryJob::processFileDetectLocalCopy(const SyncFileItemPtr &item, const PathTuple &path, const LocalInfo &localEntry)
+{
+    // Limits the candidates kept for files of a common size
+    constexpr int maxCopySourceCandidates = 8;
+    // Limits the journal lookups when many new files are found at once
+    constexpr int maxCopySourceLookupsPerSync = 1000;
+
+    const auto &options = _discoveryData->_syncOptions;
+    if (!options._deduplicateUploads
+        || item->_instruction != CSYNC_INSTRUCTION_NEW || item->_type != ItemTypeFile
+        || localEntry.size <= 0 || localEntry.size < options._deduplicateUploadsMinSize
+        || isInsideEncryptedTree()) {
+        return;
+    }
+    if (_discoveryData->_copySourceLookups >= maxCopySourceLookupsPerSync) {
+        return;
+    }
+    ++_discoveryData->_copySourceLookups;
+
+    QVector<SyncJournalFileRecord> candidates;
+    if (!_discoveryData->_statedb->getFileRecordsBySize(localEntry.size, maxCopySourceCandidates, [&candidates](const SyncJournalFileRecord &rec) {
+            candidates.append(rec);
+        })) {
+        qCWarning(lcDisco) << "Could not look for copy sources of" << path._local;
+        return;
+    }
+
+    // Copies usually keep the modification time, check those candidates first
+    std::stable_partition(candidates.begin(), candidates.end(), [&localEntry](const SyncJournalFileRecord &rec) {
+        return rec._modtime == localEntry.modtime;
+    });
+
+    // The content is not read here: the upload computes the checksum of the
+    // file anyway and only candidates with the same checksum type can match it.
+    const auto checksumType = _discoveryData->_account->capabilities().preferredUploadChecksumType();
+    for (const auto &candidate : qAsConst(candidates)) {
+        const auto candidatePath = candidate.path();
+        if (candidate.isE2eEncrypted() || candidate._etag.isEmpty()
+            || candidatePath == path._original || _discoveryData->isRenamed(candidatePath)
+            || parseChecksumHeaderType(candidate._checksumHeader) != checksumType) {
+            continue;
+        }
+        item->_copySourceCandidates.append({candidatePath, candidate._etag, candidate._checksumHeader});
+    }
+}
+
 void ProcessDirectoryJob::processFileConflict(const SyncFileItemPtr &item, ProcessDirectoryJob::PathTuple path, const LocalInfo &localEntry, const RemoteInfo &serverEntry, const SyncJournalFileRecord &dbEntry)
 {
     item->_previousSize = localEntry.size;
@@ -2033,6 +2078,7 @@ DiscoverySingleDirectoryJob *ProcessDirectoryJob::startAsyncServerQuery()
     if (!_dirItem) {
         serverJob->setIsRootPath(); // query the fingerprint on the root
     }
+    serverJob->setE2eMetadataCache(_discoveryData->_statedb);
 
     connect(serverJob, &DiscoverySingleDirectoryJob::etag, this, &ProcessDirectoryJob::etag);
     _discoveryData->_currentlyActiveJobs++;
@@ -177,6 +177,9 @@ private:
     /// processFile helper for local/remote conflicts
     void processFileConflict(const SyncFileItemPtr &item, PathTuple, const LocalInfo &, const RemoteInfo &, const SyncJournalFileRecord &);
 
+    /// processFile helper for new local files that have the content of an already synced file
+    void processFileDetectLocalCopy(const SyncFileItemPtr &item, const PathTuple &, const LocalInfo &);
+
     /// processFile helper for common final processing
     void processFileFinalize(const SyncFileItemPtr &item, PathTuple, bool recurse, QueryMode recurseQueryLocal, QueryMode recurseQueryServer);
 
@@ -294,6 +297,8 @@ private:
     DiscoveryPhase *_discoveryData;
 
     PathTuple _currentFolder;
+    QHash<QString, int> _serverEntriesByFoldedName; // number of server entries per case-folded name, see canRemoveCaseClashConflictedCopy()
+    bool _serverEntriesByFoldedNameBuilt = false;
     bool _childModified = false; // the directory contains modified item what would prevent deletion
     bool _childIgnored = false; // The directory contains ignored item that would prevent deletion
     PinState _pinState = PinState::Unspecified; // The directory's pin-state, see computePinState()
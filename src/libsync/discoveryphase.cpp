@@ -25,6 +25,7 @@
 
 #include "common/asserts.h"
 #include "common/checksums.h"
+#include "common/syncjournaldb.h"
 
 #include <csync_exclude.h>
 #include "vio/csync_vio_local.h"
@@ -74,6 +75,14 @@ void DiscoveryPhase::checkFolderSizeLimit(const QString &path, const std::functi
         return completionCallback(false);
     }
 
+    // the listing of the parent usually told us already
+    const auto cachedSize = _account->remoteTreeIndex()->folderSize(_remoteFolder + path);
+    if (cachedSize >= 0) {
+        const auto limit = _syncOptions._newBigFolderSizeLimit;
+        qCDebug(lcDiscovery) << "Folder size check from the listing for" << path << "result:" << cachedSize << "limit:" << limit;
+        return completionCallback(cachedSize >= limit);
+    }
+
     // do a PROPFIND to know the size of this folder
     const auto propfindJob = new PropfindJob(_account, _remoteFolder + path, this);
     propfindJob->setProperties(QList<QByteArray>() << "resourcetype"
@@ -249,6 +258,37 @@ void DiscoveryPhase::startJob(ProcessDirectoryJob *job)
     job->start();
 }
 
+void DiscoveryPhase::loadCaseClashConflictRecords()
+{
+    _caseClashConflictRecords.clear();
+    _caseClashConflictPathsByBasePath.clear();
+
+    const auto records = _statedb->caseClashConflictRecords();
+    for (const auto &record : records) {
+        const auto path = QString::fromUtf8(record.path);
+        _caseClashConflictRecords.insert(path, record);
+        // like the journal's query, the first record of a base path wins
+        const auto basePath = QString::fromUtf8(record.initialBasePath);
+        if (!_caseClashConflictPathsByBasePath.contains(basePath)) {
+            _caseClashConflictPathsByBasePath.insert(basePath, path);
+        }
+    }
+}
+
+ConflictRecord DiscoveryPhase::caseClashConflictRecordByPath(const QString &path) const
+{
+    return _caseClashConflictRecords.value(path);
+}
+
+ConflictRecord DiscoveryPhase::caseClashConflictRecordByBasePath(const QString &basePath) const
+{
+    const auto it = _caseClashConflictPathsByBasePath.constFind(basePath);
+    if (it == _caseClashConflictPathsByBasePath.constEnd()) {
+        return {};
+    }
+    return _caseClashConflictRecords.value(*it);
+}
+
 void DiscoveryPhase::setSelectiveSyncBlackList(const QStringList &list)
 {
     _selectiveSyncBlackList = list;
@@ -383,7 +423,7 @@ DiscoverySingleDirectoryJob::DiscoverySingleDirectoryJob(const AccountPtr &accou
 void DiscoverySingleDirectoryJob::start()
 {
     // Start the actual HTTP job
-    auto *lsColJob = new LsColJob(_account, _subPath);
+    auto *lsColJob = new LsColJob(_account, _subPath, this);
 
     QList<QByteArray> props;
     props << "resourcetype"
@@ -547,7 +587,7 @@ static void propertyMapToRemoteInfo(const QMap<QString, QString> &map, RemoteInf
     }
 
     if (result.isDirectory && map.contains("size")) {
-        result.sizeOfFolder = map.value("size").toInt();
+        result.sizeOfFolder = map.value("size").toLongLong();
     }
 }
 
@@ -653,6 +693,12 @@ void DiscoverySingleDirectoryJob::lsJobFinishedWithErrorSlot(QNetworkReply *r)
 
 void DiscoverySingleDirectoryJob::fetchE2eMetadata()
 {
+    if (applyCachedE2eMetadata()) {
+        emit finished(_results);
+        deleteLater();
+        return;
+    }
+
     const auto job = new GetMetadataApiJob(_account, _localFileId);
     connect(job, &GetMetadataApiJob::jsonReceived,
             this, &DiscoverySingleDirectoryJob::metadataReceived);
@@ -675,27 +721,12 @@ void DiscoverySingleDirectoryJob::metadataReceived(const QJsonDocument &json, in
         return;
     }
 
-    // as per E2EE V2, top level folder is the only source of encryption keys and users that have access to it
-    // hence, we need to find its path and pass to any subfolder's metadata, so it will fetch the top level metadata when needed
-    // see https://github.com/nextcloud/end_to_end_encryption_rfc/blob/v2.1/RFC.md
-    auto topLevelFolderPath = QStringLiteral("/");
-    for (const QString &topLevelPath : _topLevelE2eeFolderPaths) {
-        if (_subPath == topLevelPath) {
-            topLevelFolderPath = QStringLiteral("/");
-            break;
-        }
-        if (_subPath.startsWith(topLevelPath + QLatin1Char('/'))) {
-            const auto topLevelPathSplit = topLevelPath.split(QLatin1Char('/'));
-            topLevelFolderPath = topLevelPathSplit.join(QLatin1Char('/'));
-            break;
-        }
-    }
-
+    const auto topLevelFolderPath = topLevelE2eeFolderPath();
     const auto e2EeFolderMetadata = new FolderMetadata(_account,
                                                  statusCode == 404 ? QByteArray{} : json.toJson(QJsonDocument::Compact),
                                                  RootEncryptedFolderInfo(topLevelFolderPath),
                                                  job->signature());
-    connect(e2EeFolderMetadata, &FolderMetadata::setupComplete, this, [this, e2EeFolderMetadata] {
+    connect(e2EeFolderMetadata, &FolderMetadata::setupComplete, this, [this, e2EeFolderMetadata, statusCode, topLevelFolderPath] {
         e2EeFolderMetadata->deleteLater();
         if (!e2EeFolderMetadata->isValid()) {
             emit finished(HttpError{0, tr("Encrypted metadata setup error!")});
@@ -707,35 +738,128 @@ void DiscoverySingleDirectoryJob::metadataReceived(const QJsonDocument &json, in
         _encryptionStatusRequired = EncryptionStatusEnums::fromEndToEndEncryptionApiVersion(_account->capabilities().clientSideEncryptionVersion());
         _encryptionStatusCurrent = e2EeFolderMetadata->existingMetadataEncryptionStatus();
 
+        QHash<QString, QString> originalFilenames;
+        // Same condition as FolderMetadata::encryptedMetadataNeedUpdate(), these are not migrated
+        auto hasNestedFolders = topLevelFolderPath != QStringLiteral("/");
         const auto encryptedFiles = e2EeFolderMetadata->files();
+        for (const auto &file : encryptedFiles) {
+            originalFilenames.insert(file.encryptedFilename, file.originalFilename);
+            hasNestedFolders = hasNestedFolders || file.isDirectory();
+        }
+        applyOriginalFilenames(originalFilenames);
 
-        const auto findEncryptedFile = [=](const QString &name) {
-            const auto it = std::find_if(std::cbegin(encryptedFiles), std::cend(encryptedFiles), [=](const FolderMetadata::EncryptedFile &file) {
-                return file.encryptedFilename == name;
-            });
-            if (it == std::cend(encryptedFiles)) {
-                return Optional<FolderMetadata::EncryptedFile>();
-            } else {
-                return Optional<FolderMetadata::EncryptedFile>(*it);
-            }
-        };
-
-        std::transform(std::cbegin(_results), std::cend(_results), std::begin(_results), [=](const RemoteInfo &info) {
-            auto result = info;
-            const auto encryptedFileInfo = findEncryptedFile(result.name);
-            if (encryptedFileInfo) {
-                result._isE2eEncrypted = true;
-                result.e2eMangledName = _subPath.mid(1) + QLatin1Char('/') + result.name;
-                result.name = encryptedFileInfo->originalFilename;
-            }
-            return result;
-        });
+        // Folders whose metadata is about to be changed by this client are not worth caching
+        if (statusCode != 404 && !_isFileDropDetected && !_encryptedMetadataNeedUpdate) {
+            cacheE2eMetadata(originalFilenames, hasNestedFolders);
+        }
 
         emit finished(_results);
         deleteLater();
     });
 }
 
+QString DiscoverySingleDirectoryJob::topLevelE2eeFolderPath() const
+{
+    // as per E2EE V2, top level folder is the only source of encryption keys and users that have access to it
+    // hence, we need to find its path and pass to any subfolder's metadata, so it will fetch the top level metadata when needed
+    // see https://github.com/nextcloud/end_to_end_encryption_rfc/blob/v2.1/RFC.md
+    for (const QString &topLevelPath : _topLevelE2eeFolderPaths) {
+        if (_subPath == topLevelPath) {
+            return QStringLiteral("/");
+        }
+        if (_subPath.startsWith(topLevelPath + QLatin1Char('/'))) {
+            const auto topLevelPathSplit = topLevelPath.split(QLatin1Char('/'));
+            return topLevelPathSplit.join(QLatin1Char('/'));
+        }
+    }
+    return QStringLiteral("/");
+}
+
+bool DiscoverySingleDirectoryJob::applyCachedE2eMetadata()
+{
+    if (!_e2eMetadataCache || _firstEtag.isEmpty() || _localFileId.isEmpty()) {
+        return false;
+    }
+    const auto cacheKey = _account->e2e()->localCacheKey();
+    if (cacheKey.isEmpty()) {
+        return false;
+    }
+    const auto encryptedData = _e2eMetadataCache->e2eMetadataCache(_localFileId, _firstEtag);
+    if (encryptedData.isEmpty()) {
+        return false;
+    }
+
+    // Written by another private key or damaged, the metadata gets fetched again
+    const auto cached = QJsonDocument::fromJson(EncryptionHelper::decryptStringSymmetric(cacheKey, encryptedData)).object();
+    if (cached.isEmpty()) {
+        qCInfo(lcDiscovery) << "Could not read the cached metadata of" << _subPath;
+        _e2eMetadataCache->deleteE2eMetadataCache(_localFileId);
+        return false;
+    }
+
+    // The server may support a newer metadata version since the entry was stored.
+    // Fetch the metadata then, the migration check needs it.
+    const auto encryptionStatusRequired = EncryptionStatusEnums::fromEndToEndEncryptionApiVersion(_account->capabilities().clientSideEncryptionVersion());
+    const auto encryptionStatusCurrent = static_cast<SyncFileItem::EncryptionStatus>(cached.value(QStringLiteral("encryptionStatus")).toInt());
+    // The statuses are ordered like the metadata versions
+    if (encryptionStatusRequired > encryptionStatusCurrent && !cached.value(QStringLiteral("hasNestedFolders")).toBool()) {
+        qCInfo(lcDiscovery) << "Cached metadata of" << _subPath << "may need a migration, fetching it";
+        _e2eMetadataCache->deleteE2eMetadataCache(_localFileId);
+        return false;
+    }
+
+    qCDebug(lcDiscovery) << "Metadata of" << _subPath << "did not change, applying the cached one";
+    _encryptionStatusRequired = encryptionStatusRequired;
+    _encryptionStatusCurrent = encryptionStatusCurrent;
+    _encryptedMetadataNeedUpdate = false;
+
+    QHash<QString, QString> originalFilenames;
+    const auto files = cached.value(QStringLiteral("files")).toObject();
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        originalFilenames.insert(it.key(), it.value().toString());
+    }
+    applyOriginalFilenames(originalFilenames);
+    return true;
+}
+
+void DiscoverySingleDirectoryJob::cacheE2eMetadata(const QHash<QString, QString> &originalFilenames, bool hasNestedFolders)
+{
+    if (!_e2eMetadataCache || _firstEtag.isEmpty() || _localFileId.isEmpty()) {
+        return;
+    }
+    const auto cacheKey = _account->e2e()->localCacheKey();
+    if (cacheKey.isEmpty()) {
+        return;
+    }
+
+    QJsonObject files;
+    for (auto it = originalFilenames.constBegin(); it != originalFilenames.constEnd(); ++it) {
+        files.insert(it.key(), it.value());
+    }
+    const QJsonObject cached{
+        {QStringLiteral("encryptionStatus"), static_cast<int>(_encryptionStatusCurrent)},
+        {QStringLiteral("hasNestedFolders"), hasNestedFolders},
+        {QStringLiteral("files"), files},
+    };
+    const auto encryptedData = EncryptionHelper::encryptStringSymmetric(cacheKey, QJsonDocument(cached).toJson(QJsonDocument::Compact));
+    if (encryptedData.isEmpty()) {
+        return;
+    }
+    _e2eMetadataCache->setE2eMetadataCache(_localFileId, _firstEtag, encryptedData);
+}
+
+void DiscoverySingleDirectoryJob::applyOriginalFilenames(const QHash<QString, QString> &originalFilenames)
+{
+    for (auto &result : _results) {
+        const auto it = originalFilenames.constFind(result.name);
+        if (it != originalFilenames.constEnd()) {
+            result._isE2eEncrypted = true;
+            result.e2eMangledName = _subPath.mid(1) + QLatin1Char('/') + result.name;
+            result.name = it.value();
+        }
+    }
+}
+
 void DiscoverySingleDirectoryJob::metadataError(const QByteArray &fileId, int httpReturnCode)
 {
     qCWarning(lcDiscovery) << "E2EE Metadata job error. Trying to proceed without it." << fileId << httpReturnCode;
@@ -27,6 +27,7 @@
 #include <deque>
 #include "syncoptions.h"
 #include "syncfileitem.h"
+#include "common/syncjournalfilerecord.h"
 
 class ExcludedFiles;
 
@@ -139,7 +140,7 @@ class FolderMetadata;
  *
  * @ingroup libsync
  */
-class DiscoverySingleDirectoryJob : public QObject
+class OWNCLOUDSYNC_EXPORT DiscoverySingleDirectoryJob : public QObject
 {
     Q_OBJECT
 public:
@@ -152,6 +153,8 @@ public:
                                          QObject *parent = nullptr);
     // Specify that this is the root and we need to check the data-fingerprint
     void setIsRootPath() { _isRootPath = true; }
+    // Where what was learned from the metadata of e2ee folders is kept between syncs
+    void setE2eMetadataCache(SyncJournalDb *journal) { _e2eMetadataCache = journal; }
     void start();
     void abort();
     [[nodiscard]] bool isFileDropDetected() const;
@@ -177,6 +180,14 @@ private:
 
     [[nodiscard]] bool isE2eEncrypted() const { return _encryptionStatusCurrent != SyncFileItem::EncryptionStatus::NotEncrypted; }
 
+    // The path of the top level encrypted folder above _subPath, "/" if _subPath is one
+    [[nodiscard]] QString topLevelE2eeFolderPath() const;
+    // Applies the cached metadata if the folder did not change since it was stored
+    // and its metadata does not need a migration
+    [[nodiscard]] bool applyCachedE2eMetadata();
+    void cacheE2eMetadata(const QHash<QString, QString> &originalFilenames, bool hasNestedFolders);
+    void applyOriginalFilenames(const QHash<QString, QString> &originalFilenames);
+
     QVector<RemoteInfo> _results;
     QString _subPath;
     QByteArray _firstEtag;
@@ -199,6 +210,7 @@ private:
     int64_t _size = 0;
     QString _error;
     QPointer<LsColJob> _lsColJob;
+    SyncJournalDb *_e2eMetadataCache = nullptr;
 
     // store top level E2EE folder paths as they are used later when discovering nested folders
     QSet<QString> _topLevelE2eeFolderPaths;
@@ -334,10 +346,23 @@ public:
     bool _hasUploadErrorItems = false;
     bool _hasDownloadRemovedItems = false;
 
-    bool _noCaseConflictRecordsInDb = false;
+    /// Reads the case clash conflict records of the journal into memory, once per sync
+    void loadCaseClashConflictRecords();
+    /// The record of the conflicted copy at path, an invalid record if there is none
+    [[nodiscard]] ConflictRecord caseClashConflictRecordByPath(const QString &path) const;
+    /// A record of a conflicted copy of basePath, an invalid record if there is none
+    [[nodiscard]] ConflictRecord caseClashConflictRecordByBasePath(const QString &basePath) const;
+
+    // The journal's case clash conflict records, by path and by base path.
+    // Discovery doesn't write them, so they are read once instead of per file.
+    QHash<QString, ConflictRecord> _caseClashConflictRecords;
+    QHash<QString, QString> _caseClashConflictPathsByBasePath;
 
     QSet<QString> _topLevelE2eeFolderPaths;
 
+    // Number of new files that were looked up as local copies in this sync
+    int _copySourceLookups = 0;
+
 signals:
     void fatalError(const QString &errorString, const OCC::ErrorCategory errorCategory);
     void itemDiscovered(const OCC::SyncFileItemPtr &item);
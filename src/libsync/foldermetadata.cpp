@@ -431,11 +431,7 @@ QByteArray FolderMetadata::encryptDataWithPublicKey(const QByteArray &data, cons
 
 QByteArray FolderMetadata::decryptDataWithPrivateKey(const QByteArray &data) const
 {
-    Bio privateKeyBio;
-    BIO_write(privateKeyBio, _account->e2e()->_privateKey.constData(), _account->e2e()->_privateKey.size());
-    const auto privateKey = PKey::readPrivateKey(privateKeyBio);
-
-    const auto decryptResult = EncryptionHelper::decryptStringAsymmetric(privateKey, data);
+    const auto decryptResult = _account->e2e()->decryptWithPrivateKey(data);
     if (decryptResult.isEmpty()) {
         qCDebug(lcCseMetadata()) << "ERROR. Could not decrypt the metadata key";
         _account->reportClientStatus(OCC::ClientStatusReportingStatus::E2EeError_GeneralError);
@@ -15,6 +15,7 @@
 #include "localdiscoverytracker.h"
 
 #include "syncfileitem.h"
+#include "common/syncjournaldb.h"
 
 #include <QLoggingCategory>
 
@@ -34,6 +35,9 @@ void LocalDiscoveryTracker::startSyncFullDiscovery()
 {
     _localDiscoveryPaths.clear();
     _previousLocalDiscoveryPaths.clear();
+    _fullDiscoverySlices.clear();
+    _syncingFullDiscoverySlice = false;
+    _lastSyncCompletedFullDiscovery = false;
     qCDebug(lcLocalDiscoveryTracker) << "full discovery";
 }
 
@@ -48,6 +52,8 @@ void LocalDiscoveryTracker::startSyncPartialDiscovery()
 
     _previousLocalDiscoveryPaths = std::move(_localDiscoveryPaths);
     _localDiscoveryPaths.clear();
+    _syncingFullDiscoverySlice = false;
+    _lastSyncCompletedFullDiscovery = false;
 }
 
 const std::set<QString> &LocalDiscoveryTracker::localDiscoveryPaths() const
@@ -55,6 +61,90 @@ const std::set<QString> &LocalDiscoveryTracker::localDiscoveryPaths() const
     return _localDiscoveryPaths;
 }
 
+bool LocalDiscoveryTracker::planFullDiscoverySlices(SyncJournalDb &journal, qint64 maxRecordsPerSlice)
+{
+    _fullDiscoverySlices.clear();
+
+    // Folders small enough for a slice, in path order. Files don't need to be
+    // listed: the folder they are in is discovered along with any path below it.
+    std::vector<std::pair<QString, qint64>> subtrees;
+    qint64 totalRecords = 0;
+
+    std::function<bool(const QByteArray &)> collectSubtrees = [&](const QByteArray &path) {
+        QMap<QByteArray, SyncJournalDb::SubtreeRecordCount> counts;
+        if (!journal.getSubtreeRecordCounts(path, &counts)) {
+            return false;
+        }
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+            if (path.isEmpty()) {
+                totalRecords += it->_records;
+            }
+            if (!it->_isDirectory) {
+                continue;
+            }
+            if (it->_records > maxRecordsPerSlice) {
+                const auto subtreeCount = subtrees.size();
+                if (!collectSubtrees(it.key())) {
+                    return false;
+                }
+                if (subtrees.size() > subtreeCount) {
+                    continue;
+                }
+                // Only files inside, it can't be split
+            }
+            subtrees.emplace_back(QString::fromUtf8(it.key()), it->_records);
+        }
+        return true;
+    };
+    if (!collectSubtrees(QByteArray()) || totalRecords <= maxRecordsPerSlice) {
+        return false;
+    }
+
+    qint64 sliceRecords = 0;
+    for (const auto &[path, records] : subtrees) {
+        if (_fullDiscoverySlices.empty() || sliceRecords + records > maxRecordsPerSlice) {
+            _fullDiscoverySlices.emplace_back();
+            sliceRecords = 0;
+        }
+        _fullDiscoverySlices.back().insert(path);
+        sliceRecords += records;
+    }
+    if (_fullDiscoverySlices.size() < 2) {
+        _fullDiscoverySlices.clear();
+        return false;
+    }
+
+    qCInfo(lcLocalDiscoveryTracker) << "full discovery of" << totalRecords << "records split into"
+                                    << _fullDiscoverySlices.size() << "slices";
+    return true;
+}
+
+bool LocalDiscoveryTracker::hasFullDiscoverySlices() const
+{
+    return !_fullDiscoverySlices.empty();
+}
+
+std::set<QString> LocalDiscoveryTracker::fullDiscoverySlicePaths() const
+{
+    auto paths = _localDiscoveryPaths;
+    if (!_fullDiscoverySlices.empty()) {
+        paths.insert(_fullDiscoverySlices.front().cbegin(), _fullDiscoverySlices.front().cend());
+    }
+    return paths;
+}
+
+void LocalDiscoveryTracker::startSyncFullDiscoverySlice()
+{
+    qCDebug(lcLocalDiscoveryTracker) << "full discovery slice," << _fullDiscoverySlices.size() << "slices left";
+    startSyncPartialDiscovery();
+    _syncingFullDiscoverySlice = !_fullDiscoverySlices.empty();
+}
+
+bool LocalDiscoveryTracker::lastSyncCompletedFullDiscovery() const
+{
+    return _lastSyncCompletedFullDiscovery;
+}
+
 void LocalDiscoveryTracker::slotItemCompleted(const SyncFileItemPtr &item)
 {
     // For successes, we want to wipe the file from the list to ensure we don't
@@ -92,4 +182,11 @@ void LocalDiscoveryTracker::slotSyncFinished(bool success)
         qCDebug(lcLocalDiscoveryTracker) << "sync failed, keeping last sync's local discovery path list";
     }
     _previousLocalDiscoveryPaths.clear();
+
+    // A failed slice is retried by the next sync
+    if (_syncingFullDiscoverySlice && success) {
+        _fullDiscoverySlices.pop_front();
+        _lastSyncCompletedFullDiscovery = _fullDiscoverySlices.empty();
+    }
+    _syncingFullDiscoverySlice = false;
 }
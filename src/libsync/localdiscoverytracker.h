@@ -16,6 +16,7 @@
 #define LOCALDISCOVERYTRACKER_H
 
 #include "owncloudlib.h"
+#include <deque>
 #include <set>
 #include <QObject>
 #include <QByteArray>
@@ -24,6 +25,7 @@
 namespace OCC {
 
 class SyncFileItem;
+class SyncJournalDb;
 using SyncFileItemPtr = QSharedPointer<SyncFileItem>;
 
 /**
@@ -38,6 +40,11 @@ using SyncFileItemPtr = QSharedPointer<SyncFileItem>;
  * Then localDiscoveryPaths() can be used to determine paths to rediscover
  * and send to SyncEngine::setLocalDiscoveryOptions().
  *
+ * A full local discovery of a huge folder can also be spread over several
+ * sync runs (planFullDiscoverySlices()): every run rediscovers the next slice
+ * of subtrees together with the touched paths, so fresh local changes don't
+ * wait for a scan of the whole folder.
+ *
  * This class is primarily used from Folder and separate primarily for
  * readability and testing purposes.
  *
@@ -68,6 +75,26 @@ public:
     /** Access list of files that shall be locally rediscovered. */
     [[nodiscard]] const std::set<QString> &localDiscoveryPaths() const;
 
+    /** Splits the next full local discovery into slices of subtrees.
+     *
+     * A slice holds about maxRecordsPerSlice records of the journal, only
+     * folders that are bigger than that on their own get a slice of their
+     * own. Returns false if the folder fits into a single slice.
+     */
+    [[nodiscard]] bool planFullDiscoverySlices(SyncJournalDb &journal, qint64 maxRecordsPerSlice);
+
+    /** Whether slices of a full local discovery are still to be synced */
+    [[nodiscard]] bool hasFullDiscoverySlices() const;
+
+    /** The touched paths and the subtrees of the next slice */
+    [[nodiscard]] std::set<QString> fullDiscoverySlicePaths() const;
+
+    /** Call when a sync using fullDiscoverySlicePaths() starts */
+    void startSyncFullDiscoverySlice();
+
+    /** Whether the last sync run rediscovered the last slice successfully */
+    [[nodiscard]] bool lastSyncCompletedFullDiscovery() const;
+
 public slots:
     /**
      * Success and failure of sync items adjust what the next sync is
@@ -96,6 +123,15 @@ private:
      * again when the sync is done to make sure everything is retried.
      */
     std::set<QString> _previousLocalDiscoveryPaths;
+
+    /**
+     * The slices of the current full local discovery that were not
+     * successfully synced yet, the next one first.
+     */
+    std::deque<std::set<QString>> _fullDiscoverySlices;
+
+    bool _syncingFullDiscoverySlice = false;
+    bool _lastSyncCompletedFullDiscovery = false;
 };
 
 } // namespace OCC
@@ -31,6 +31,8 @@
 #include <QCoreApplication>
 #include <QJsonObject>
 #include <QLoggingCategory>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #ifndef TOKEN_AUTH_ONLY
 #include <QPainter>
 #include <QPainterPath>
@@ -68,6 +70,51 @@ constexpr auto propfindFileTagsContainerElementTagName = "tags";
 constexpr auto propfindSystemFileTagElementTagName = "system-tag";
 constexpr auto propfindSystemFileTagsContainerElementTagName = "system-tags";
 
+namespace {
+
+struct JsonApiReply
+{
+    QJsonDocument json;
+    QVariant decoded;
+    int statusCode = 0;
+};
+
+JsonApiReply parseJsonApiReply(const QByteArray &data, int httpStatusCode)
+{
+    JsonApiReply reply;
+
+    QString jsonStr = QString::fromUtf8(data);
+    if (jsonStr.contains("<?xml version=\"1.0\"?>")) {
+        static const QRegularExpression rex("<statuscode>(\\d+)</statuscode>");
+        const auto rexMatch = rex.match(jsonStr);
+        if (rexMatch.hasMatch()) {
+            // this is a error message coming back from ocs.
+            reply.statusCode = rexMatch.captured(1).toInt();
+        }
+    } else if(jsonStr.isEmpty() && httpStatusCode == notModifiedStatusCode){
+        qCWarning(lcJsonApiJob) << "Nothing changed so nothing to retrieve - status code: " << httpStatusCode;
+        reply.statusCode = httpStatusCode;
+    } else {
+        static const QRegularExpression rex(R"("statuscode":(\d+))");
+        // example: "{"ocs":{"meta":{"status":"ok","statuscode":100,"message":null},"data":{"version":{"major":8,"minor":"... (504)
+        const auto rxMatch = rex.match(jsonStr);
+        if (rxMatch.hasMatch()) {
+            reply.statusCode = rxMatch.captured(1).toInt();
+        }
+    }
+
+    QJsonParseError error{};
+    reply.json = QJsonDocument::fromJson(data, &error);
+    // empty or invalid response and status code is != 304 because jsonStr is expected to be empty
+    if ((error.error != QJsonParseError::NoError || reply.json.isNull()) && httpStatusCode != notModifiedStatusCode) {
+        qCWarning(lcJsonApiJob) << "invalid JSON!" << jsonStr << error.errorString();
+    }
+
+    return reply;
+}
+
+}
+
 RequestEtagJob::RequestEtagJob(AccountPtr account, const QString &path, QObject *parent)
     : AbstractNetworkJob(account, path, parent)
 {
@@ -317,8 +364,8 @@ bool LsColXMLParser::parse(const QByteArray &xml, QHash<QString, ExtraFolderInfo
 
 /*********************************************************************************************/
 
-LsColJob::LsColJob(AccountPtr account, const QString &path)
-    : AbstractNetworkJob(account, path)
+LsColJob::LsColJob(AccountPtr account, const QString &path, QObject *parent)
+    : AbstractNetworkJob(account, path, parent)
 {
 }
 
@@ -338,8 +385,24 @@ QList<QByteArray> LsColJob::properties() const
     return _properties;
 }
 
+void LsColJob::setCachedListingAllowed(bool allowed)
+{
+    _cachedListingAllowed = allowed;
+}
+
 void LsColJob::start()
 {
+    if (_cachedListingAllowed && !_url.isValid()) {
+        if (const auto cached = account()->remoteTreeIndex()->findListing(path(), _properties)) {
+            qCInfo(lcLsColJob) << "LSCOL of" << path() << "answered from the remote tree index";
+            // Callers connect to the signals after start()
+            QTimer::singleShot(0, this, [this, listing = *cached] {
+                replayListing(listing);
+            });
+            return;
+        }
+    }
+
     QList<QByteArray> properties = _properties;
 
     if (properties.isEmpty()) {
@@ -395,6 +458,21 @@ bool LsColJob::finished()
 
     if (httpCode == 207 && validContentType) {
         LsColXMLParser parser;
+
+        // Listings with etags go to the remote tree index before anyone is
+        // told about them, the discovery relies on it for the folder sizes
+        QHash<QString, QMap<QString, QString>> folderProperties;
+        if (_properties.contains("getetag") && !_url.isValid()) {
+            connect(&parser, &LsColXMLParser::directoryListingIterated, this, [&folderProperties](const QString &href, const QMap<QString, QString> &properties) {
+                if (properties.value(QStringLiteral("resourcetype")).contains(QStringLiteral("collection"))) {
+                    folderProperties.insert(href, properties);
+                }
+            });
+            connect(&parser, &LsColXMLParser::directoryListingSubfolders, this, [this, &folderProperties](const QStringList &subfolders) {
+                account()->remoteTreeIndex()->insertListing(path(), makeListing(subfolders, folderProperties));
+            });
+        }
+
         connect(&parser, &LsColXMLParser::directoryListingSubfolders,
             this, &LsColJob::directoryListingSubfolders);
         connect(&parser, &LsColXMLParser::directoryListingIterated,
@@ -418,6 +496,9 @@ bool LsColJob::finished()
         }
     } else {
         // wrong content type, wrong HTTP code or any other network error
+        if (httpCode == 404 && !_url.isValid()) {
+            account()->remoteTreeIndex()->invalidate(path());
+        }
         emit finishedWithError(reply());
     }
 
@@ -427,6 +508,45 @@ bool LsColJob::finished()
     return false;
 }
 
+RemoteTreeIndex::Listing LsColJob::makeListing(const QStringList &subfolders, const QHash<QString, QMap<QString, QString>> &properties) const
+{
+    const auto davPath = account()->davUrl().path();
+
+    RemoteTreeIndex::Listing listing;
+    listing.properties = _properties;
+    listing.folders.reserve(subfolders.size());
+    for (const auto &href : subfolders) {
+        const auto iteratedHref = href.endsWith(QLatin1Char('/')) ? href.chopped(1) : href;
+        RemoteTreeIndex::Folder folder;
+        folder.href = href;
+        folder.path = RemoteTreeIndex::normalizedPath(href.mid(davPath.size()));
+        folder.properties = properties.value(iteratedHref);
+        const auto info = _folderInfos.value(href);
+        folder.fileId = info.fileId;
+        folder.size = info.size;
+        listing.folders.append(folder);
+    }
+    if (!listing.folders.isEmpty()) {
+        // The first one is the listed folder itself
+        listing.etag = listing.folders.first().properties.value(QStringLiteral("getetag")).toUtf8();
+    }
+    return listing;
+}
+
+void LsColJob::replayListing(const RemoteTreeIndex::Listing &listing)
+{
+    QStringList subfolders;
+    subfolders.reserve(listing.folders.size());
+    for (const auto &folder : listing.folders) {
+        subfolders.append(folder.href);
+        _folderInfos[folder.href] = ExtraFolderInfo{folder.fileId, folder.size};
+        emit directoryListingIterated(folder.href.endsWith(QLatin1Char('/')) ? folder.href.chopped(1) : folder.href, folder.properties);
+    }
+    emit directoryListingSubfolders(subfolders);
+    emit finishedWithoutError();
+    deleteLater();
+}
+
 /*********************************************************************************************/
 
 namespace {
@@ -967,6 +1087,11 @@ void JsonApiJob::start()
     SimpleApiJob::start();
 }
 
+void JsonApiJob::setDecoder(const Decoder &decoder)
+{
+    _decoder = decoder;
+}
+
 bool JsonApiJob::finished()
 {
     qCInfo(lcJsonApiJob) << "JsonApiJob of" << reply()->request().url() << "FINISHED WITH STATUS"
@@ -977,45 +1102,41 @@ bool JsonApiJob::finished()
     if (reply()->error() != QNetworkReply::NoError) {
         qCWarning(lcJsonApiJob) << "Network error: " << path() << errorString() << reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute);
         statusCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        emit jsonReceived(QJsonDocument(), statusCode);
-        return true;
-    }
-
-    QString jsonStr = QString::fromUtf8(reply()->readAll());
-    if (jsonStr.contains("<?xml version=\"1.0\"?>")) {
-        static const QRegularExpression rex("<statuscode>(\\d+)</statuscode>");
-        const auto rexMatch = rex.match(jsonStr);
-        if (rexMatch.hasMatch()) {
-            // this is a error message coming back from ocs.
-            statusCode = rexMatch.captured(1).toInt();
-        }
-    } else if(jsonStr.isEmpty() && httpStatusCode == notModifiedStatusCode){
-        qCWarning(lcJsonApiJob) << "Nothing changed so nothing to retrieve - status code: " << httpStatusCode;
-        statusCode = httpStatusCode;
-    } else {
-        static const QRegularExpression rex(R"("statuscode":(\d+))");
-        // example: "{"ocs":{"meta":{"status":"ok","statuscode":100,"message":null},"data":{"version":{"major":8,"minor":"... (504)
-        const auto rxMatch = rex.match(jsonStr);
-        if (rxMatch.hasMatch()) {
-            statusCode = rxMatch.captured(1).toInt();
+        if (_decoder) {
+            emit jsonDecoded(_decoder(QJsonDocument()), statusCode);
+        } else {
+            emit jsonReceived(QJsonDocument(), statusCode);
         }
+        return true;
     }
 
     // save new ETag value
-    if(reply()->rawHeaderList().contains("ETag"))
-        emit etagResponseHeaderReceived(reply()->rawHeader("ETag"), statusCode);
-
-    QJsonParseError error{};
-    auto json = QJsonDocument::fromJson(jsonStr.toUtf8(), &error);
-    // empty or invalid response and status code is != 304 because jsonStr is expected to be empty
-    if ((error.error != QJsonParseError::NoError || json.isNull()) && httpStatusCode != notModifiedStatusCode) {
-        qCWarning(lcJsonApiJob) << "invalid JSON!" << jsonStr << error.errorString();
-        emit jsonReceived(json, statusCode);
+    const auto hasEtag = reply()->rawHeaderList().contains("ETag");
+    const auto etag = reply()->rawHeader("ETag");
+
+    if (!_decoder) {
+        const auto parsed = parseJsonApiReply(reply()->readAll(), httpStatusCode);
+        if (hasEtag)
+            emit etagResponseHeaderReceived(etag, parsed.statusCode);
+        emit jsonReceived(parsed.json, parsed.statusCode);
         return true;
     }
 
-    emit jsonReceived(json, statusCode);
-    return true;
+    // Keep the job until the worker is done, it deletes itself afterwards
+    auto watcher = new QFutureWatcher<JsonApiReply>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, hasEtag, etag] {
+        const auto parsed = watcher->result();
+        if (hasEtag)
+            emit etagResponseHeaderReceived(etag, parsed.statusCode);
+        emit jsonDecoded(parsed.decoded, parsed.statusCode);
+        deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([data = reply()->readAll(), httpStatusCode, decoder = _decoder] {
+        auto parsed = parseJsonApiReply(data, httpStatusCode);
+        parsed.decoded = decoder(parsed.json);
+        return parsed;
+    }));
+    return false;
 }
 
 
@@ -18,7 +18,10 @@
 
 #include <QBuffer>
 
+#include <functional>
+
 #include "abstractnetworkjob.h"
+#include "remotetreeindex.h"
 
 #include "common/result.h"
 
@@ -140,7 +143,7 @@ class OWNCLOUDSYNC_EXPORT LsColJob : public AbstractNetworkJob
 {
     Q_OBJECT
 public:
-    explicit LsColJob(AccountPtr account, const QString &path);
+    explicit LsColJob(AccountPtr account, const QString &path, QObject *parent = nullptr);
     explicit LsColJob(AccountPtr account, const QUrl &url);
     void start() override;
     QHash<QString, ExtraFolderInfo> _folderInfos;
@@ -156,6 +159,15 @@ public:
     void setProperties(QList<QByteArray> properties);
     [[nodiscard]] QList<QByteArray> properties() const;
 
+    /**
+     * Lets the job answer from the account's RemoteTreeIndex when it has a
+     * recent listing of the path with all the properties.
+     *
+     * The index only knows the folders: for a cached listing,
+     * directoryListingIterated and _folderInfos don't cover the files.
+     */
+    void setCachedListingAllowed(bool allowed);
+
 signals:
     void directoryListingSubfolders(const QStringList &items);
     void directoryListingIterated(const QString &name, const QMap<QString, QString> &properties);
@@ -166,8 +178,12 @@ private slots:
     bool finished() override;
 
 private:
+    void replayListing(const RemoteTreeIndex::Listing &listing);
+    [[nodiscard]] RemoteTreeIndex::Listing makeListing(const QStringList &subfolders, const QHash<QString, QMap<QString, QString>> &properties) const;
+
     QList<QByteArray> _properties;
     QUrl _url; // Used instead of path() if the url is specified in the constructor
+    bool _cachedListingAllowed = false;
 };
 
 /**
@@ -493,6 +509,18 @@ public:
 
     void setBody(const QJsonDocument &body);
 
+    using Decoder = std::function<QVariant(const QJsonDocument &json)>;
+
+    /**
+     * @brief Parse and decode the reply on a worker thread
+     *
+     * The reply is parsed off the job's thread and the document is handed to
+     * @p decoder there, to turn it into what the consumer needs, e.g. a list
+     * of its structs. jsonDecoded() is emitted with the result instead of
+     * jsonReceived(). The decoder must not touch objects of the job's thread.
+     */
+    void setDecoder(const Decoder &decoder);
+
 public slots:
     void start() override;
 
@@ -507,6 +535,13 @@ signals:
      */
     void jsonReceived(const QJsonDocument &json, int statusCode);
 
+    /**
+     * @brief jsonDecoded - signal to report the decoded json answer, see setDecoder()
+     * @param decoded - what the decoder returned, it's given a null document in case of error
+     * @param statusCode - the OCS status code: 100 (!) for success
+     */
+    void jsonDecoded(const QVariant &decoded, int statusCode);
+
     /**
      * @brief etagResponseHeaderReceived - signal to report the ETag response header value
      * from ocs api v2
@@ -514,6 +549,9 @@ signals:
      * @param statusCode - the OCS status code: 100 (!) for success
      */
     void etagResponseHeaderReceived(const QByteArray &value, int statusCode);
+
+private:
+    Decoder _decoder;
 };
 
 /**
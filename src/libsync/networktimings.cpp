@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "networktimings.h"
+#include "theme.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QUrlQuery>
+
+#include <algorithm>
+
+namespace {
+
+constexpr char timingsProperty[] = "nextcloudNetworkTimings";
+
+bool isNumber(const QString &segment)
+{
+    return !segment.isEmpty() && std::all_of(segment.cbegin(), segment.cend(), [](const QChar c) { return c.isDigit(); });
+}
+
+QJsonArray harQueryString(const QUrl &url)
+{
+    QJsonArray result;
+    const auto items = QUrlQuery(url).queryItems(QUrl::FullyDecoded);
+    for (const auto &item : items) {
+        result.append(QJsonObject{{QStringLiteral("name"), item.first}, {QStringLiteral("value"), item.second}});
+    }
+    return result;
+}
+
+}
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcNetworkTimings, "nextcloud.sync.networktimings", QtInfoMsg)
+
+bool NetworkTimings::_enabled = qEnvironmentVariableIntValue("OWNCLOUD_NETWORK_TIMINGS") != 0;
+
+qint64 NetworkTimings::Request::queueMsec() const
+{
+    return sentMsec < 0 || createdMsec < 0 ? -1 : sentMsec - createdMsec;
+}
+
+qint64 NetworkTimings::Request::timeToFirstByteMsec() const
+{
+    if (sentMsec < 0) {
+        return -1;
+    }
+    // errors before any response count as waiting until the end
+    return (firstByteMsec >= 0 ? firstByteMsec : finishedMsec) - sentMsec;
+}
+
+qint64 NetworkTimings::Request::transferMsec() const
+{
+    return firstByteMsec < 0 || finishedMsec < 0 ? 0 : finishedMsec - firstByteMsec;
+}
+
+void NetworkTimings::Histogram::add(qint64 msec)
+{
+    if (msec < 0) {
+        return;
+    }
+    ++buckets[bucketOf(msec)];
+    ++count;
+    totalMsec += msec;
+    maxMsec = qMax(maxMsec, msec);
+}
+
+qint64 NetworkTimings::Histogram::quantileMsec(double quantile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    const auto wanted = static_cast<quint32>(quantile * count);
+    quint32 seen = 0;
+    for (int bucket = 0; bucket < bucketCount - 1; ++bucket) {
+        seen += buckets[bucket];
+        if (seen > wanted) {
+            return 1ll << bucket;
+        }
+    }
+    return maxMsec;
+}
+
+qint64 NetworkTimings::now()
+{
+    static const auto clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.elapsed();
+}
+
+int NetworkTimings::bucketOf(qint64 msec)
+{
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && msec >= (1ll << bucket)) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+QString NetworkTimings::endpoint(const QUrl &url, const QUrl &accountUrl)
+{
+    auto path = url.path();
+    const auto accountPath = accountUrl.path();
+    if (!accountPath.isEmpty() && path.startsWith(accountPath)) {
+        path = path.mid(accountPath.size());
+    }
+
+    auto segments = path.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    int keep = segments.size();
+    if (segments.size() >= 2 && segments.at(1) == QLatin1String("dav")) {
+        // remote.php/dav/files/<user>/<path> and the like
+        keep = 3;
+    } else if (segments.size() >= 2 && segments.at(1) == QLatin1String("webdav")) {
+        keep = 2;
+    }
+    constexpr int maxSegments = 8;
+    segments = segments.mid(0, qMin(keep, maxSegments));
+    for (auto &segment : segments) {
+        if (isNumber(segment)) {
+            segment = QStringLiteral("{id}");
+        }
+    }
+    return segments.join(QLatin1Char('/'));
+}
+
+void NetworkTimings::attach(QObject *object, const QSharedPointer<NetworkTimings> &timings)
+{
+    object->setProperty(timingsProperty, QVariant::fromValue(timings));
+}
+
+QSharedPointer<NetworkTimings> NetworkTimings::attachedTo(const QObject *object)
+{
+    for (; object; object = object->parent()) {
+        const auto timings = object->property(timingsProperty);
+        if (timings.isValid()) {
+            return timings.value<QSharedPointer<NetworkTimings>>();
+        }
+    }
+    return {};
+}
+
+void NetworkTimings::record(const Request &request, const QUrl &accountUrl)
+{
+    const auto key = QString::fromLatin1(request.verb) + QLatin1Char(' ') + endpoint(request.url, accountUrl);
+
+    QMutexLocker locker(&_mutex);
+    auto &stats = _stats[key];
+    stats.queue.add(request.queueMsec());
+    stats.timeToFirstByte.add(request.timeToFirstByteMsec());
+    stats.transfer.add(request.transferMsec());
+    stats.bytesSent += request.bytesSent;
+    stats.bytesReceived += request.bytesReceived;
+
+    if (_runRequests.size() < maxRunRequests) {
+        _runRequests.append(request);
+    }
+}
+
+void NetworkTimings::startRun()
+{
+    QMutexLocker locker(&_mutex);
+    _runRequests.clear();
+}
+
+QVector<NetworkTimings::Request> NetworkTimings::runRequests() const
+{
+    QMutexLocker locker(&_mutex);
+    return _runRequests;
+}
+
+QMap<QString, NetworkTimings::EndpointStats> NetworkTimings::stats() const
+{
+    QMutexLocker locker(&_mutex);
+    return _stats;
+}
+
+QString NetworkTimings::statsSummary() const
+{
+    const auto allStats = stats();
+    QString summary;
+    for (auto it = allStats.cbegin(); it != allStats.cend(); ++it) {
+        const auto &stats = it.value();
+        summary += QStringLiteral("%1: %2 requests, queue p50 %3ms p95 %4ms, first byte p50 %5ms p95 %6ms max %7ms, "
+                                  "transfer p50 %8ms p95 %9ms, %10 bytes sent, %11 bytes received\n")
+                       .arg(it.key())
+                       .arg(stats.timeToFirstByte.count)
+                       .arg(stats.queue.quantileMsec(0.5))
+                       .arg(stats.queue.quantileMsec(0.95))
+                       .arg(stats.timeToFirstByte.quantileMsec(0.5))
+                       .arg(stats.timeToFirstByte.quantileMsec(0.95))
+                       .arg(stats.timeToFirstByte.maxMsec)
+                       .arg(stats.transfer.quantileMsec(0.5))
+                       .arg(stats.transfer.quantileMsec(0.95))
+                       .arg(stats.bytesSent)
+                       .arg(stats.bytesReceived);
+    }
+    return summary;
+}
+
+QJsonObject NetworkTimings::toHar() const
+{
+    const auto requests = runRequests();
+
+    QJsonArray entries;
+    for (const auto &request : requests) {
+        const auto blocked = qMax(0ll, request.queueMsec());
+        const auto wait = qMax(0ll, request.timeToFirstByteMsec());
+        const auto receive = qMax(0ll, request.transferMsec());
+
+        QJsonArray requestHeaders;
+        if (!request.requestId.isEmpty()) {
+            requestHeaders.append(QJsonObject{{QStringLiteral("name"), QStringLiteral("X-Request-ID")},
+                {QStringLiteral("value"), QString::fromLatin1(request.requestId)}});
+        }
+
+        const QJsonObject harRequest{
+            {QStringLiteral("method"), QString::fromLatin1(request.verb)},
+            {QStringLiteral("url"), request.url.toString(QUrl::RemoveUserInfo)},
+            {QStringLiteral("httpVersion"), QStringLiteral("HTTP/1.1")},
+            {QStringLiteral("cookies"), QJsonArray()},
+            {QStringLiteral("headers"), requestHeaders},
+            {QStringLiteral("queryString"), harQueryString(request.url)},
+            {QStringLiteral("headersSize"), -1},
+            {QStringLiteral("bodySize"), request.bytesSent},
+        };
+        const QJsonObject harResponse{
+            {QStringLiteral("status"), request.httpStatus},
+            {QStringLiteral("statusText"), QString()},
+            {QStringLiteral("httpVersion"), QStringLiteral("HTTP/1.1")},
+            {QStringLiteral("cookies"), QJsonArray()},
+            {QStringLiteral("headers"), QJsonArray()},
+            {QStringLiteral("content"), QJsonObject{{QStringLiteral("size"), request.bytesReceived}, {QStringLiteral("mimeType"), QString()}}},
+            {QStringLiteral("redirectURL"), QString()},
+            {QStringLiteral("headersSize"), -1},
+            {QStringLiteral("bodySize"), request.bytesReceived},
+        };
+        const QJsonObject harTimings{
+            {QStringLiteral("blocked"), blocked},
+            {QStringLiteral("dns"), -1},
+            {QStringLiteral("connect"), -1},
+            {QStringLiteral("send"), 0},
+            {QStringLiteral("wait"), wait},
+            {QStringLiteral("receive"), receive},
+        };
+
+        entries.append(QJsonObject{
+            {QStringLiteral("startedDateTime"), request.startedDateTime.toString(Qt::ISODateWithMs)},
+            {QStringLiteral("time"), blocked + wait + receive},
+            {QStringLiteral("request"), harRequest},
+            {QStringLiteral("response"), harResponse},
+            {QStringLiteral("cache"), QJsonObject()},
+            {QStringLiteral("timings"), harTimings},
+        });
+    }
+
+    const QJsonObject creator{
+        {QStringLiteral("name"), Theme::instance()->appName()},
+        {QStringLiteral("version"), Theme::instance()->version()},
+    };
+    return QJsonObject{{QStringLiteral("log"),
+        QJsonObject{
+            {QStringLiteral("version"), QStringLiteral("1.2")},
+            {QStringLiteral("creator"), creator},
+            {QStringLiteral("entries"), entries},
+        }}};
+}
+
+bool NetworkTimings::writeHar(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcNetworkTimings) << "Could not write network timings to" << fileName << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(toHar()).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+void NetworkTimings::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _runRequests.clear();
+    _stats.clear();
+}
+
+}
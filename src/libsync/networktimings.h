@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QMap>
+#include <QMetaType>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QUrl>
+#include <QVector>
+
+#include <array>
+
+namespace OCC {
+
+/**
+ * @brief Latency statistics of the requests of AbstractNetworkJob
+ *
+ * Every request records when its job was created, when the request was
+ * handed to Qt, when the first response headers arrived and when it
+ * finished, plus the bytes sent and received. That splits a slow request
+ * into client side queueing, waiting for the server and the transfer itself.
+ *
+ * Requests are aggregated into histograms per verb and endpoint. The requests
+ * of the current sync run are also kept individually and can be exported as
+ * a HAR file, which browsers' developer tools show as a waterfall.
+ *
+ * Each SyncEngine has its own instance and attaches it to the objects its
+ * jobs are created below, see attach(). Requests of other jobs, like the
+ * ones of the GUI, are not recorded.
+ *
+ * Recording is off unless OWNCLOUD_NETWORK_TIMINGS=1 is set; jobs then don't
+ * do more than check isEnabled().
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT NetworkTimings
+{
+public:
+    /// Milliseconds since the reference clock, -1 if the event didn't happen
+    struct Request
+    {
+        QByteArray verb;
+        QUrl url;
+        QByteArray requestId;
+        QDateTime startedDateTime;
+        int httpStatus = 0;
+        qint64 createdMsec = -1;
+        qint64 sentMsec = -1;
+        qint64 firstByteMsec = -1;
+        qint64 finishedMsec = -1;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+
+        [[nodiscard]] qint64 queueMsec() const;
+        [[nodiscard]] qint64 timeToFirstByteMsec() const;
+        [[nodiscard]] qint64 transferMsec() const;
+    };
+
+    /// Buckets by powers of two: [0,1), [1,2), [2,4), ... milliseconds, the last one is open
+    static constexpr int bucketCount = 20;
+
+    struct Histogram
+    {
+        std::array<quint32, bucketCount> buckets = {};
+        quint32 count = 0;
+        qint64 totalMsec = 0;
+        qint64 maxMsec = 0;
+
+        void add(qint64 msec);
+        /// Upper bound of the bucket that contains the given quantile (0..1)
+        [[nodiscard]] qint64 quantileMsec(double quantile) const;
+    };
+
+    struct EndpointStats
+    {
+        Histogram queue;
+        Histogram timeToFirstByte;
+        Histogram transfer;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+    };
+
+    /// Requests of a run beyond this are only aggregated
+    static constexpr int maxRunRequests = 100000;
+
+    [[nodiscard]] static bool isEnabled() { return _enabled; }
+    /// For tests, otherwise driven by OWNCLOUD_NETWORK_TIMINGS
+    static void setEnabled(bool enabled) { _enabled = enabled; }
+
+    /// Milliseconds on the monotonic clock all Request times refer to
+    [[nodiscard]] static qint64 now();
+
+    static int bucketOf(qint64 msec);
+
+    /** The endpoint a request is aggregated under
+     *
+     * The path relative to the account, cut after the collection for DAV
+     * requests and with numeric ids replaced, so files and shares don't all
+     * get their own histograms.
+     */
+    [[nodiscard]] static QString endpoint(const QUrl &url, const QUrl &accountUrl);
+
+    /// Records the requests of the jobs that are children of object, directly or not
+    static void attach(QObject *object, const QSharedPointer<NetworkTimings> &timings);
+    /// The instance attached to object or its closest parent, null if there is none
+    [[nodiscard]] static QSharedPointer<NetworkTimings> attachedTo(const QObject *object);
+
+    void record(const Request &request, const QUrl &accountUrl);
+
+    /// Forgets the requests of the previous run, the histograms are kept
+    void startRun();
+    [[nodiscard]] QVector<Request> runRequests() const;
+
+    /// Keyed by verb, a space and the endpoint
+    [[nodiscard]] QMap<QString, EndpointStats> stats() const;
+    [[nodiscard]] QString statsSummary() const;
+
+    /// The requests of the current run in HTTP Archive format
+    [[nodiscard]] QJsonObject toHar() const;
+    bool writeHar(const QString &fileName) const;
+
+    void clear();
+
+private:
+    static bool _enabled;
+
+    mutable QMutex _mutex;
+    QVector<Request> _runRequests;
+    QMap<QString, EndpointStats> _stats;
+};
+
+}
+
+Q_DECLARE_METATYPE(QSharedPointer<OCC::NetworkTimings>)
@@ -853,8 +853,24 @@ QString OwncloudPropagator::localPath() const
     return _localDir;
 }
 
+int OwncloudPropagator::activeJobCount() const
+{
+    return _activeJobList.count() + (_sharingJobLimits ? _sharingJobLimits->_activeJobList.count() : 0);
+}
+
+void OwncloudPropagator::shareJobLimitsWith(OwncloudPropagator *other)
+{
+    _sharingJobLimits = other;
+}
+
 void OwncloudPropagator::scheduleNextJob()
 {
+    // A job of ours finished or started, the other propagator may have room again once it's done
+    if (_sharingJobLimits && _sharingJobLimits->_waitingForJobSlot) {
+        _sharingJobLimits->_waitingForJobSlot = false;
+        _sharingJobLimits->scheduleNextJob();
+    }
+
     if (_jobScheduled) return; // don't schedule more than 1
     _jobScheduled = true;
     QTimer::singleShot(3, this, &OwncloudPropagator::scheduleNextJobImpl);
@@ -869,11 +885,15 @@ void OwncloudPropagator::scheduleNextJobImpl()
 
     _jobScheduled = false;
 
-    if (_activeJobList.count() < maximumActiveTransferJob()) {
+    const auto activeJobs = activeJobCount();
+    // Whether the jobs of the other propagator may be what keeps us from starting one
+    _waitingForJobSlot = activeJobs > _activeJobList.count();
+
+    if (activeJobs < maximumActiveTransferJob()) {
         if (_rootJob->scheduleSelfOrChild()) {
             scheduleNextJob();
         }
-    } else if (_activeJobList.count() < hardMaximumActiveJob()) {
+    } else if (activeJobs < hardMaximumActiveJob()) {
         int likelyFinishedQuicklyCount = 0;
         // NOTE: Only counts the first 3 jobs! Then for each
         // one that is likely finished quickly, we can launch another one.
@@ -884,8 +904,8 @@ void OwncloudPropagator::scheduleNextJobImpl()
                 likelyFinishedQuicklyCount++;
             }
         }
-        if (_activeJobList.count() < maximumActiveTransferJob() + likelyFinishedQuicklyCount) {
-            qCDebug(lcPropagator) << "Can pump in another request! activeJobs =" << _activeJobList.count();
+        if (activeJobs < maximumActiveTransferJob() + likelyFinishedQuicklyCount) {
+            qCDebug(lcPropagator) << "Can pump in another request! activeJobs =" << activeJobs;
             if (_rootJob->scheduleSelfOrChild()) {
                 scheduleNextJob();
             }
@@ -469,6 +469,16 @@ public:
      */
     QList<PropagateItemJob *> _activeJobList;
 
+    /** The active jobs of this propagator and of the one sharing its limits */
+    [[nodiscard]] int activeJobCount() const;
+
+    /** Makes the jobs of another propagator of the same sync count against the limits of this one
+     *
+     * Used by the SyncEngine while the uploads started during discovery are
+     * still running next to the regular propagation.
+     */
+    void shareJobLimitsWith(OwncloudPropagator *other);
+
     /** We detected that another sync is required after this one */
     bool _anotherSyncNeeded = false;
 
@@ -688,6 +698,9 @@ private:
     SyncOptions _syncOptions;
     bool _jobScheduled = false;
 
+    QPointer<OwncloudPropagator> _sharingJobLimits;
+    bool _waitingForJobSlot = false; // a job was not started because of the jobs of _sharingJobLimits
+
     const QString _localDir; // absolute path to the local directory. ends with '/'
     const QString _remoteFolder; // remote folder, ends with '/'
 
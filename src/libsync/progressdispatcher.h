@@ -24,6 +24,7 @@
 #include <QTimer>
 
 #include "syncfileitem.h"
+#include "completedsyncitem.h"
 
 namespace OCC {
 
@@ -287,8 +288,10 @@ signals:
     void progressInfo(const QString &folder, const OCC::ProgressInfo &progress);
     /**
      * @brief: the item was completed by a job
+     *
+     * The record is shared between all listeners and must not be copied per listener.
      */
-    void itemCompleted(const QString &folder, const OCC::SyncFileItemPtr &item, const OCC::ErrorCategory category);
+    void itemCompleted(const QString &folder, const OCC::CompletedSyncItemPtr &item);
 
     /**
      * @brief A new folder-wide sync error was seen.
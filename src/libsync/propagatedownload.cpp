@@ -26,6 +26,7 @@
 #include <common/constants.h>
 #include "clientsideencryptionjobs.h"
 #include "propagatedownloadencrypted.h"
+#include "transfercompression.h"
 #include "common/vfs.h"
 
 #include <QLoggingCategory>
@@ -732,6 +733,13 @@ void PropagateDownloadFile::startDownload()
     QMap<QByteArray, QByteArray> headers;
 
     if (_item->_directDownloadUrl.isEmpty()) {
+        // Qt asks for and decodes compressed bodies by itself. Don't let the server
+        // spend time compressing content that won't shrink, and keep the range of
+        // resumed downloads in plain bytes.
+        if (_resumeStart > 0 || isEncrypted() || !TransferCompression::mayCompress(_item->_file, _item->_size)) {
+            headers["Accept-Encoding"] = "identity";
+        }
+
         // Normal job, download from oC instance
         _job = new GETFileJob(propagator()->account(),
             propagator()->fullRemotePath(isEncrypted() ? _item->_encryptedFileName : _item->_file),
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "propagateremotecopy.h"
+#include "account.h"
+
+#include <QLoggingCategory>
+#include <QNetworkRequest>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcCopyJob, "nextcloud.sync.networkjob.copy", QtInfoMsg)
+
+CopyJob::CopyJob(AccountPtr account, const QString &path, const QString &destination,
+    const QMap<QByteArray, QByteArray> &extraHeaders, QObject *parent)
+    : AbstractNetworkJob(account, path, parent)
+    , _destination(destination)
+    , _extraHeaders(extraHeaders)
+{
+}
+
+QMap<QByteArray, QByteArray> CopyJob::sourceEtagHeaders(const QByteArray &sourceEtag)
+{
+    QMap<QByteArray, QByteArray> headers;
+    if (!sourceEtag.isEmpty()) {
+        // We add quotes because the server always adds quotes around the etag
+        headers[QByteArrayLiteral("If-Match")] = '"' + sourceEtag + '"';
+    }
+    return headers;
+}
+
+void CopyJob::start()
+{
+    QNetworkRequest req;
+    req.setRawHeader("Destination", QUrl::toPercentEncoding(_destination, "/"));
+    req.setRawHeader("Overwrite", "F");
+    for (auto it = _extraHeaders.constBegin(); it != _extraHeaders.constEnd(); ++it) {
+        req.setRawHeader(it.key(), it.value());
+    }
+    sendRequest("COPY", makeDavUrl(path()), req);
+
+    if (reply()->error() != QNetworkReply::NoError) {
+        qCWarning(lcCopyJob) << " Network error: " << reply()->errorString();
+    }
+    AbstractNetworkJob::start();
+}
+
+bool CopyJob::finished()
+{
+    qCInfo(lcCopyJob) << "COPY of" << reply()->request().url() << "FINISHED WITH STATUS"
+                      << replyStatusString();
+
+    emit finishedSignal();
+    return true;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "abstractnetworkjob.h"
+
+namespace OCC {
+
+/**
+ * @brief Server side copy of a file (WebDAV COPY)
+ *
+ * The copy never overwrites an existing destination. If sourceEtag is set
+ * the server only copies the source if it still has that etag.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT CopyJob : public AbstractNetworkJob
+{
+    Q_OBJECT
+    const QString _destination;
+    QMap<QByteArray, QByteArray> _extraHeaders;
+
+public:
+    explicit CopyJob(AccountPtr account, const QString &path, const QString &destination,
+        const QMap<QByteArray, QByteArray> &extraHeaders, QObject *parent = nullptr);
+
+    void start() override;
+    bool finished() override;
+
+    [[nodiscard]] static QMap<QByteArray, QByteArray> sourceEtagHeaders(const QByteArray &sourceEtag);
+
+signals:
+    void finishedSignal();
+};
+
+}
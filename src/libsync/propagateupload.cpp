@@ -30,6 +30,7 @@
 #include "networkjobs.h"
 #include "clientsideencryption.h"
 #include "clientsideencryptionjobs.h"
+#include "propagateremotecopy.h"
 
 #include <QNetworkAccessManager>
 #include <QFileInfo>
@@ -183,6 +184,7 @@ PropagateUploadFileCommon::PropagateUploadFileCommon(OwncloudPropagator *propaga
     , _finished(false)
     , _deleteExisting(false)
     , _aborting(false)
+    , _registeredUpload(false)
 {
     const auto path = _item->_file;
     const auto slashPosition = path.lastIndexOf('/');
@@ -433,6 +435,159 @@ void PropagateUploadFileCommon::slotStartUpload(const QByteArray &transmissionCh
         return slotOnErrorStartFolderUnlock(SyncFileItem::SoftError, tr("Local file changed during sync."));
     }
 
+    if (mayDeduplicateUpload()) {
+        _contentKey = UploadedContentRegistry::contentKey(_item->_checksumHeader, _fileToUpload._size);
+        for (const auto &candidate : qAsConst(_item->_copySourceCandidates)) {
+            if (candidate.checksumHeader == _item->_checksumHeader) {
+                // The discovery found a synced file with the same content
+                qCInfo(lcPropagateUpload) << "Copy detected" << candidate.path << "->" << _item->_file;
+                startCopy({propagator()->fullRemotePath(candidate.path), candidate.etag});
+                return;
+            }
+        }
+        if (!_contentKey.isEmpty()) {
+            startDeduplicatedUpload();
+            return;
+        }
+    }
+
+    doStartUpload();
+}
+
+bool PropagateUploadFileCommon::mayDeduplicateUpload() const
+{
+    const auto &options = propagator()->syncOptions();
+    // Only new files: for existing ones the upload has to be conditional on the etag of the destination.
+    // The server side copy would not carry the conflict or admin recall headers either.
+    return options._deduplicateUploads
+        && _fileToUpload._size >= options._deduplicateUploadsMinSize
+        && _item->_instruction == CSYNC_INSTRUCTION_NEW
+        && !_uploadingEncrypted
+        && !_deleteExisting
+        && !_item->_file.contains(QLatin1String(".sys.admin#recall#"))
+        && !propagator()->_journal->conflictRecord(_item->_file.toUtf8()).isValid();
+}
+
+void PropagateUploadFileCommon::startDeduplicatedUpload()
+{
+    if (propagator()->_abortRequested) {
+        // We may have been waiting for another upload that got aborted
+        disconnect(_waitForUploadConnection);
+        if (!_finished) {
+            done(SyncFileItem::NormalError, tr("Upload of identical content was aborted."));
+        }
+        return;
+    }
+
+    const auto registry = propagator()->account()->uploadedContentRegistry();
+    const auto source = registry->find(_contentKey);
+    if (source.isValid()) {
+        startCopy(source);
+        return;
+    }
+
+    if (registry->isUploading(_contentKey)) {
+        // Another upload is sending the same content right now, copy its result once it is done
+        qCInfo(lcPropagateUpload) << "Waiting for the upload of identical content before uploading" << _item->_file;
+        _waitForUploadConnection = connect(registry, &UploadedContentRegistry::uploadDone, this, [this](const QByteArray &key) {
+            if (key != _contentKey) {
+                return;
+            }
+            disconnect(_waitForUploadConnection);
+            startDeduplicatedUpload();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    registry->uploadStarted(_contentKey, this);
+    _registeredUpload = true;
+    doStartUpload();
+}
+
+void PropagateUploadFileCommon::startCopy(const UploadedContentRegistry::Source &source)
+{
+    qCInfo(lcPropagateUpload) << "Content of" << _item->_file << "is already on the server, copying it from" << source.remotePath;
+
+    _copySourcePath = source.remotePath;
+    auto headers = CopyJob::sourceEtagHeaders(source.etag);
+    headers[QByteArrayLiteral("X-OC-Mtime")] = QByteArray::number(qint64(_item->_modtime));
+
+    const auto destination = QDir::cleanPath(propagator()->account()->davUrl().path()
+        + propagator()->fullRemotePath(_fileToUpload._file));
+    auto job = new CopyJob(propagator()->account(), source.remotePath, destination, headers, this);
+    _jobs.append(job);
+    connect(job, &CopyJob::finishedSignal, this, &PropagateUploadFileCommon::slotCopyFinished);
+    connect(job, &QObject::destroyed, this, &PropagateUploadFileCommon::slotJobDestroyed);
+    propagator()->_activeJobList.append(this);
+    job->start();
+}
+
+void PropagateUploadFileCommon::slotCopyFinished()
+{
+    auto job = qobject_cast<CopyJob *>(sender());
+    ASSERT(job);
+    propagator()->_activeJobList.removeOne(this);
+
+    if (_finished) {
+        return;
+    }
+
+    const auto httpCode = job->reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (job->reply()->error() != QNetworkReply::NoError || (httpCode != 201 && httpCode != 204)) {
+        // The source changed or vanished, or the server doesn't allow the copy: just upload
+        qCInfo(lcPropagateUpload) << "Copy for" << _item->_file << "failed with" << httpCode
+                                  << job->reply()->errorString() << ", uploading instead";
+        const auto registry = propagator()->account()->uploadedContentRegistry();
+        if ((httpCode == 412 || httpCode == 404) && registry->find(_contentKey).remotePath == _copySourcePath) {
+            registry->forget(_contentKey);
+        }
+        startUploadAfterFailedCopy();
+        return;
+    }
+
+    // The COPY response does not tell about the new file, ask for it
+    auto propfindJob = new PropfindJob(propagator()->account(), propagator()->fullRemotePath(_fileToUpload._file), this);
+    propfindJob->setProperties({QByteArrayLiteral("getetag"), QByteArrayLiteral("getlastmodified"), QByteArrayLiteral("http://owncloud.org/ns:id")});
+    _jobs.append(propfindJob);
+    connect(propfindJob, &QObject::destroyed, this, &PropagateUploadFileCommon::slotJobDestroyed);
+    connect(propfindJob, &PropfindJob::result, this, [this](const QVariantMap &result) {
+        propagator()->_activeJobList.removeOne(this);
+        _item->_etag = parseEtag(result.value(QStringLiteral("getetag")).toByteArray().constData());
+        _item->_fileId = result.value(QStringLiteral("id")).toByteArray();
+        _item->_responseTimeStamp = QDateTime::currentDateTimeUtc().toString(Qt::RFC2822Date).toUtf8();
+        if (_item->_etag.isEmpty()) {
+            qCWarning(lcPropagateUpload) << "Server did not return an etag for the copy of" << _item->_file;
+            startUploadAfterFailedCopy();
+            return;
+        }
+        // Servers that ignore X-OC-Mtime on COPY keep the mtime of the source, which would make the
+        // next discovery see a remote change. Upload over the copy to get the right mtime.
+        const auto lastModified = QDateTime::fromString(result.value(QStringLiteral("getlastmodified")).toString(), Qt::RFC2822Date);
+        if (!lastModified.isValid() || lastModified.toSecsSinceEpoch() != _item->_modtime) {
+            qCInfo(lcPropagateUpload) << "Copy of" << _item->_file << "has the modification time" << lastModified
+                                      << "instead of" << _item->_modtime << ", uploading instead";
+            startUploadAfterFailedCopy();
+            return;
+        }
+        finalize();
+    });
+    connect(propfindJob, &PropfindJob::finishedWithError, this, [this] {
+        propagator()->_activeJobList.removeOne(this);
+        qCWarning(lcPropagateUpload) << "Could not read back the copy of" << _item->_file << ", uploading instead";
+        startUploadAfterFailedCopy();
+    });
+    propagator()->_activeJobList.append(this);
+    propfindJob->start();
+}
+
+void PropagateUploadFileCommon::startUploadAfterFailedCopy()
+{
+    // Become the new source of the content, unless someone else already is about to
+    const auto registry = propagator()->account()->uploadedContentRegistry();
+    if (!_contentKey.isEmpty() && !registry->isUploading(_contentKey) && !registry->find(_contentKey).isValid()) {
+        registry->uploadStarted(_contentKey, this);
+        _registeredUpload = true;
+    }
     doStartUpload();
 }
 
@@ -492,6 +647,11 @@ bool UploadDevice::open(QIODevice::OpenMode mode)
     _size = qBound(0ll, _size, fileDiskSize - _start);
     _read = 0;
 
+    _gzipEncoded = !_encodedData.isEmpty();
+    if (_gzipEncoded) {
+        _size = _encodedData.size();
+    }
+
     return QIODevice::open(mode);
 }
 
@@ -531,6 +691,12 @@ qint64 UploadDevice::readData(char *data, qint64 maxlen)
         _bandwidthQuota -= maxlen;
     }
 
+    if (_gzipEncoded) {
+        memcpy(data, _encodedData.constData() + _read, maxlen);
+        _read += maxlen;
+        return maxlen;
+    }
+
     auto c = _file.read(data, maxlen);
     if (c < 0) {
         setErrorString(_file.errorString());
@@ -578,7 +744,9 @@ bool UploadDevice::seek(qint64 pos)
         return false;
     }
     _read = pos;
-    _file.seek(_start + pos);
+    if (!_gzipEncoded) {
+        _file.seek(_start + pos);
+    }
     return true;
 }
 
@@ -642,6 +810,14 @@ void PropagateUploadFileCommon::slotPollFinished()
 void PropagateUploadFileCommon::done(const SyncFileItem::Status status, const QString &errorString, const ErrorCategory category)
 {
     _finished = true;
+    if (_registeredUpload) {
+        _registeredUpload = false;
+        UploadedContentRegistry::Source source;
+        if (status == SyncFileItem::Success) {
+            source = {propagator()->fullRemotePath(_fileToUpload._file), _item->_etag};
+        }
+        propagator()->account()->uploadedContentRegistry()->uploadFinished(_contentKey, source);
+    }
     PropagateItemJob::done(status, errorString, category);
 }
 
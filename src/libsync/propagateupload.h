@@ -15,6 +15,7 @@
 
 #include "owncloudpropagator.h"
 #include "networkjobs.h"
+#include "uploadedcontentregistry.h"
 
 #include <QBuffer>
 #include <QFile>
@@ -58,6 +59,14 @@ public:
     bool isChoked() { return _choked; }
     void giveBandwidthQuota(qint64 bwq);
 
+    /** Sends the given gzip encoded data instead of the file's
+     *
+     * Must be called before open(). The file is still opened, so that a
+     * locked or removed file makes the upload fail as usual.
+     */
+    void setGzipEncodedData(const QByteArray &data) { _encodedData = data; }
+    [[nodiscard]] bool isGzipEncoded() const { return _gzipEncoded; }
+
 signals:
 
 private:
@@ -71,6 +80,10 @@ private:
     /// Position between _start and _start+_size
     qint64 _read = 0;
 
+    /// The gzip encoded data that is sent instead of the file's, if _gzipEncoded
+    QByteArray _encodedData;
+    bool _gzipEncoded = false;
+
     // Bandwidth manager related
     QPointer<BandwidthManager> _bandwidthManager;
     qint64 _bandwidthQuota = 0;
@@ -222,6 +235,9 @@ protected:
      */
     bool _aborting BITFIELD(1);
 
+    /// Whether this job announced the upload of _contentKey to the account's UploadedContentRegistry
+    bool _registeredUpload BITFIELD(1);
+
     /* This is a minified version of the SyncFileItem,
      * that holds only the specifics about the file that's
      * being uploaded.
@@ -266,6 +282,8 @@ private slots:
     void slotFolderUnlocked(const QByteArray &folderId, int httpReturnCode);
     // invoked on internal error to unlock a folder and failed
     void slotOnErrorStartFolderUnlock(SyncFileItem::Status status, const QString &errorString);
+    // server side copy of identical content finished, see startDeduplicatedUpload()
+    void slotCopyFinished();
 
 public:
     virtual void doStartUpload() = 0;
@@ -317,9 +335,19 @@ protected:
     /** Bases headers that need to be sent on the PUT, or in the MOVE for chunking-ng */
     QMap<QByteArray, QByteArray> headers();
 private:
+  /// Whether the content may be copied from an earlier upload instead of being uploaded
+  [[nodiscard]] bool mayDeduplicateUpload() const;
+  /// Copies the content on the server if it was uploaded before, else uploads it with doStartUpload()
+  void startDeduplicatedUpload();
+  void startCopy(const UploadedContentRegistry::Source &source);
+  void startUploadAfterFailedCopy();
+
   PropagateUploadEncrypted *_uploadEncryptedHelper = nullptr;
   bool _uploadingEncrypted = false;
   UploadStatus _uploadStatus;
+  QByteArray _contentKey;
+  QString _copySourcePath;
+  QMetaObject::Connection _waitForUploadConnection;
 };
 
 /**
@@ -354,6 +382,18 @@ private:
         return propagator()->syncOptions()._initialChunkSize;
     }
 
+    /// Whether an upload in a single request may be sent gzip encoded, see TransferCompression
+    [[nodiscard]] bool mayCompressUpload() const;
+    /// Compresses the file on a worker thread, then starts the upload
+    void startCompressedUpload();
+    /// Checks that the server stored the decoded file after a gzip encoded upload
+    void verifyCompressedUpload();
+    /// Turns compression off for the account and sends the file again as is
+    void resendUncompressed();
+
+    /// The gzip encoded content of the file if it compressed well, sent instead of the file's
+    QByteArray _gzipEncodedData;
+
 public:
     PropagateUploadFileV1(OwncloudPropagator *propagator, const SyncFileItemPtr &item)
         : PropagateUploadFileCommon(propagator, item)
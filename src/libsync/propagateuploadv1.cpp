@@ -26,10 +26,13 @@
 #include "syncengine.h"
 #include "propagateremotedelete.h"
 #include "common/asserts.h"
+#include "transfercompression.h"
 
 #include <QNetworkAccessManager>
 #include <QFileInfo>
 #include <QDir>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <cmath>
 #include <cstring>
 
@@ -77,11 +80,45 @@ void PropagateUploadFileV1::doStartUpload()
     }
 
     _currentChunk = 0;
+    _gzipEncodedData.clear();
 
     propagator()->reportProgress(*_item, 0);
+    if (_chunkCount == 1 && mayCompressUpload()) {
+        startCompressedUpload();
+        return;
+    }
     startNextChunk();
 }
 
+void PropagateUploadFileV1::startCompressedUpload()
+{
+    propagator()->_activeJobList.append(this);
+
+    auto watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        propagator()->_activeJobList.removeOne(this);
+        if (_finished || propagator()->_abortRequested) {
+            return;
+        }
+        _gzipEncodedData = watcher->result();
+        startNextChunk();
+    });
+    watcher->setFuture(QtConcurrent::run([fileName = _fileToUpload._path, size = _fileToUpload._size] {
+        // Errors reading the file are left to the upload, which reports them
+        QFile file(fileName);
+        QString openError;
+        if (!FileSystem::openAndSeekFileSharedRead(&file, &openError, 0)) {
+            return QByteArray();
+        }
+        const auto data = file.read(size);
+        if (data.size() != size || !TransferCompression::isCompressible(data)) {
+            return QByteArray();
+        }
+        return TransferCompression::gzipCompress(data);
+    }));
+}
+
 void PropagateUploadFileV1::startNextChunk()
 {
     if (propagator()->_abortRequested)
@@ -137,6 +174,9 @@ void PropagateUploadFileV1::startNextChunk()
     const QString fileName = _fileToUpload._path;
     auto device = std::make_unique<UploadDevice>(
             fileName, chunkStart, currentChunkSize, &propagator()->_bandwidthManager);
+    if (_chunkCount == 1) {
+        device->setGzipEncodedData(_gzipEncodedData);
+    }
     if (!device->open(QIODevice::ReadOnly)) {
         qCWarning(lcPropagateUploadV1) << "Could not prepare upload device: " << device->errorString();
 
@@ -149,6 +189,10 @@ void PropagateUploadFileV1::startNextChunk()
         abortWithError(SyncFileItem::SoftError, device->errorString());
         return;
     }
+    if (device->isGzipEncoded()) {
+        qCDebug(lcPropagateUploadV1) << "Sending" << fileName << "gzip encoded," << device->size() << "of" << currentChunkSize << "bytes";
+        headers[QByteArrayLiteral("Content-Encoding")] = TransferCompression::gzipEncoding;
+    }
 
     // job takes ownership of device via a QScopedPointer. Job deletes itself when finishing
     auto devicePtr = device.get(); // for connections later
@@ -189,7 +233,7 @@ void PropagateUploadFileV1::startNextChunk()
         parallelChunkUpload = false;
     }
 
-    if (parallelChunkUpload && (propagator()->_activeJobList.count() < propagator()->maximumActiveTransferJob())
+    if (parallelChunkUpload && (propagator()->activeJobCount() < propagator()->maximumActiveTransferJob())
         && _currentChunk < _chunkCount) {
         startNextChunk();
     }
@@ -198,6 +242,15 @@ void PropagateUploadFileV1::startNextChunk()
     }
 }
 
+bool PropagateUploadFileV1::mayCompressUpload() const
+{
+    const auto account = propagator()->account();
+    return propagator()->syncOptions()._compressUploads
+        && !account->compressedUploadsRejected()
+        && _fileToUpload._size <= TransferCompression::maxUploadSize
+        && TransferCompression::mayCompress(_item->_file, _fileToUpload._size);
+}
+
 void PropagateUploadFileV1::slotPutFinished()
 {
     auto *job = qobject_cast<PUTFileJob *>(sender());
@@ -216,6 +269,13 @@ void PropagateUploadFileV1::slotPutFinished()
     _item->_responseTimeStamp = job->responseTimestamp();
     _item->_requestId = job->requestId();
     QNetworkReply::NetworkError err = job->reply()->error();
+    if (_item->_httpErrorCode == 415 && job->reply()->request().hasRawHeader("Content-Encoding")) {
+        // Unsupported Media Type: the server doesn't decode the upload after all
+        qCWarning(lcPropagateUploadV1) << "Server refused the gzip encoded upload of" << _item->_file << ", sending it as is";
+        _item->_httpErrorCode = 0;
+        resendUncompressed();
+        return;
+    }
     if (err != QNetworkReply::NoError) {
         commonErrorHandling(job);
         const auto exceptionParsed = getExceptionFromReply(job->reply());
@@ -341,9 +401,50 @@ void PropagateUploadFileV1::slotPutFinished()
         // Well, the mtime was not set
     }
 
+    if (job->reply()->request().hasRawHeader("Content-Encoding")) {
+        verifyCompressedUpload();
+        return;
+    }
     finalize();
 }
 
+void PropagateUploadFileV1::verifyCompressedUpload()
+{
+    // Servers that don't decode the body store the gzip data as the file, without any error
+    auto propfindJob = new PropfindJob(propagator()->account(), propagator()->fullRemotePath(_fileToUpload._file), this);
+    propfindJob->setProperties({QByteArrayLiteral("getcontentlength")});
+    _jobs.append(propfindJob);
+    connect(propfindJob, &QObject::destroyed, this, &PropagateUploadFileCommon::slotJobDestroyed);
+    connect(propfindJob, &PropfindJob::result, this, [this](const QVariantMap &result) {
+        propagator()->_activeJobList.removeOne(this);
+        const auto storedSize = result.value(QStringLiteral("getcontentlength")).toLongLong();
+        if (storedSize != _fileToUpload._size) {
+            // The If-Match header of the new upload has the etag of the encoded one
+            qCWarning(lcPropagateUploadV1) << "Server stored" << storedSize << "bytes for the gzip encoded upload of" << _item->_file
+                                           << "instead of" << _fileToUpload._size << ", sending it as is";
+            resendUncompressed();
+            return;
+        }
+        finalize();
+    });
+    connect(propfindJob, &PropfindJob::finishedWithError, this, [this] {
+        propagator()->_activeJobList.removeOne(this);
+        qCWarning(lcPropagateUploadV1) << "Could not check the gzip encoded upload of" << _item->_file << ", sending it as is";
+        resendUncompressed();
+    });
+    propagator()->_activeJobList.append(this);
+    propfindJob->start();
+}
+
+void PropagateUploadFileV1::resendUncompressed()
+{
+    propagator()->account()->setCompressedUploadsRejected();
+    _finished = false;
+    _currentChunk = 0;
+    _gzipEncodedData.clear();
+    startNextChunk();
+}
+
 
 void PropagateUploadFileV1::slotUploadProgress(qint64 sent, qint64 total)
 {
@@ -355,6 +456,11 @@ void PropagateUploadFileV1::slotUploadProgress(qint64 sent, qint64 total)
         return;
     }
 
+    if (_chunkCount == 1 && total > 0 && total != _fileToUpload._size) {
+        // A gzip encoded body: report the progress in bytes of the file
+        sent = sent * _fileToUpload._size / total;
+    }
+
     int progressChunk = _currentChunk + _startChunk - 1;
     if (progressChunk >= _chunkCount)
         progressChunk = _currentChunk - 1;
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "remotetreeindex.h"
+
+#include <QLoggingCategory>
+
+#include <algorithm>
+
+namespace {
+
+QString parentPath(const QString &path)
+{
+    const auto slashPosition = path.lastIndexOf(QLatin1Char('/'));
+    return slashPosition < 0 ? QString() : path.left(slashPosition);
+}
+
+}
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcRemoteTreeIndex, "nextcloud.sync.remotetreeindex", QtInfoMsg)
+
+bool RemoteTreeIndex::Listing::hasProperties(const QList<QByteArray> &wanted) const
+{
+    return std::all_of(wanted.cbegin(), wanted.cend(), [this](const QByteArray &property) {
+        return properties.contains(property);
+    });
+}
+
+QString RemoteTreeIndex::normalizedPath(const QString &path)
+{
+    return path.split(QLatin1Char('/'), Qt::SkipEmptyParts).join(QLatin1Char('/'));
+}
+
+void RemoteTreeIndex::insertListing(const QString &path, Listing listing)
+{
+    const auto listingPath = normalizedPath(path);
+
+    listing.folderIndexes.clear();
+    for (int i = 0; i < listing.folders.size(); ++i) {
+        listing.folderIndexes.insert(listing.folders.at(i).path, i);
+    }
+
+    // Subfolders with another etag changed since they were listed
+    for (int i = 1; i < listing.folders.size(); ++i) {
+        const auto &folder = listing.folders.at(i);
+        const auto cached = _listings.object(folder.path);
+        if (cached && cached->etag != folder.properties.value(QStringLiteral("getetag")).toUtf8()) {
+            qCDebug(lcRemoteTreeIndex) << "Etag of" << folder.path << "changed, dropping its listings";
+            removeTree(folder.path);
+        }
+    }
+
+    listing.age.start();
+    const auto cost = qMax(1, listing.folders.size());
+    _listings.insert(listingPath, new Listing(std::move(listing)), cost);
+}
+
+const RemoteTreeIndex::Listing *RemoteTreeIndex::findListing(const QString &path, const QList<QByteArray> &wanted) const
+{
+    const auto listing = _listings.object(normalizedPath(path));
+    if (!listing || listing->age.hasExpired(maxListingAgeMsec) || !listing->hasProperties(wanted)) {
+        return nullptr;
+    }
+    return listing;
+}
+
+qint64 RemoteTreeIndex::folderSize(const QString &path) const
+{
+    const auto folderPath = normalizedPath(path);
+    const auto listing = findListing(parentPath(folderPath));
+    if (!listing || folderPath.isEmpty()) {
+        return -1;
+    }
+    const auto index = listing->folderIndexes.value(folderPath, -1);
+    return index < 0 ? -1 : listing->folders.at(index).size;
+}
+
+void RemoteTreeIndex::invalidate(const QString &path)
+{
+    const auto folderPath = normalizedPath(path);
+    removeTree(folderPath);
+    if (!folderPath.isEmpty()) {
+        _listings.remove(parentPath(folderPath));
+    }
+}
+
+void RemoteTreeIndex::clear()
+{
+    _listings.clear();
+}
+
+void RemoteTreeIndex::removeTree(const QString &path)
+{
+    if (path.isEmpty()) {
+        _listings.clear();
+        return;
+    }
+    _listings.remove(path);
+    const auto prefix = path + QLatin1Char('/');
+    const auto paths = _listings.keys();
+    for (const auto &cachedPath : paths) {
+        if (cachedPath.startsWith(prefix)) {
+            _listings.remove(cachedPath);
+        }
+    }
+}
+
+}
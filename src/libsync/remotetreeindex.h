@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace OCC {
+
+/**
+ * @brief Remembers the folders of the recent directory listings of an account
+ *
+ * Every LsColJob that asks for the etag records the folders it saw: the
+ * listed folder itself and its subfolders, with their properties. The
+ * discovery keeps the index up to date on every sync, so the folder size
+ * checks and the selective sync views can be served without another
+ * PROPFIND.
+ *
+ * A listing stays valid as long as the etag of its folder did not change:
+ * when a newer listing of the parent reports another etag for a subfolder,
+ * the listings of that subfolder and of everything below it are dropped.
+ * Listings are also dropped after maxListingAgeMsec, since nothing keeps
+ * them up to date while no sync runs.
+ *
+ * Files are not recorded, to keep the memory use bound by the number of
+ * folders.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT RemoteTreeIndex
+{
+public:
+    struct Folder
+    {
+        QString href; ///< as in LsColJob::directoryListingSubfolders
+        QString path; ///< relative to the account's dav url, see normalizedPath()
+        QMap<QString, QString> properties;
+        QByteArray fileId;
+        qint64 size = -1;
+    };
+
+    struct Listing
+    {
+        QByteArray etag; ///< of the listed folder
+        QList<QByteArray> properties; ///< that were asked for
+        QVector<Folder> folders; ///< the listed folder first, then its subfolders
+        QHash<QString, int> folderIndexes; ///< path -> index in folders
+        QElapsedTimer age;
+
+        [[nodiscard]] bool hasProperties(const QList<QByteArray> &wanted) const;
+    };
+
+    /// path relative to the account's dav url without leading, trailing or duplicate slashes
+    [[nodiscard]] static QString normalizedPath(const QString &path);
+
+    /// Records the listing of path and drops the outdated listings of its subfolders
+    void insertListing(const QString &path, Listing listing);
+
+    /// A listing of path recent enough and with all the wanted properties, or nullptr
+    [[nodiscard]] const Listing *findListing(const QString &path, const QList<QByteArray> &wanted = {}) const;
+
+    /// Size of the folder as reported by the listing of its parent, -1 if unknown
+    [[nodiscard]] qint64 folderSize(const QString &path) const;
+
+    /// Forgets path, everything below it and the listing of its parent
+    void invalidate(const QString &path);
+
+    void clear();
+
+private:
+    static constexpr int maxFolders = 200000;
+    static constexpr qint64 maxListingAgeMsec = 10 * 60 * 1000;
+
+    /// Drops the listing of path and of everything below it
+    void removeTree(const QString &path);
+
+    QCache<QString, Listing> _listings{maxFolders};
+};
+
+}
@@ -32,6 +32,8 @@
 #include "common/vfs.h"
 #include "clientsideencryption.h"
 #include "clientsideencryptionjobs.h"
+#include "logger.h"
+#include "networktimings.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -42,6 +44,7 @@
 #include <climits>
 #include <cassert>
 #include <chrono>
+#include <memory>
 
 #include <QCoreApplication>
 #include <QSslSocket>
@@ -65,6 +68,57 @@ Q_LOGGING_CATEGORY(lcEngine, "nextcloud.sync.engine", QtInfoMsg)
 
 bool SyncEngine::s_anySyncRunning = false;
 
+namespace {
+
+// A path that a running sync is going to propagate
+struct PathClaim
+{
+    QString path;
+    // Removals, renames and type changes of folders affect the whole subtree
+    bool recursive = false;
+    const SyncEngine *engine = nullptr;
+};
+
+// The claims of the running syncs of a journal: the sync of a single item
+// runs next to the sync of the whole folder and they must stay off each other's paths
+struct JournalPathClaims
+{
+    QVector<PathClaim> claims;
+    // Bumped whenever a sync releases its paths, the discovery results of
+    // the syncs that ran meanwhile may be outdated
+    quint64 generation = 0;
+};
+
+JournalPathClaims &pathClaims(const SyncJournalDb *journal)
+{
+    static QHash<const SyncJournalDb *, JournalPathClaims> claims;
+    return claims[journal];
+}
+
+QVector<PathClaim> pathClaimsOf(const SyncFileItem &item, const SyncEngine *engine)
+{
+    const auto recursive = item.isDirectory()
+        && item._instruction != CSYNC_INSTRUCTION_NEW
+        && item._instruction != CSYNC_INSTRUCTION_UPDATE_METADATA;
+    QVector<PathClaim> claims{{item._file, recursive, engine}};
+    if (!item._renameTarget.isEmpty() && item._renameTarget != item._file) {
+        claims.append({item._renameTarget, recursive, engine});
+    }
+    return claims;
+}
+
+bool isBelow(const QString &path, const QString &folder)
+{
+    return path.size() > folder.size() && path.at(folder.size()) == QLatin1Char('/') && path.startsWith(folder);
+}
+
+bool overlaps(const PathClaim &a, const PathClaim &b)
+{
+    return a.path == b.path || (a.recursive && isBelow(b.path, a.path)) || (b.recursive && isBelow(a.path, b.path));
+}
+
+}
+
 /** When the client touches a file, block change notifications for this duration (ms)
  *
  * On Linux and Windows the file watcher can't distinguish a change that originates
@@ -120,6 +174,7 @@ SyncEngine::SyncEngine(AccountPtr account,
 SyncEngine::~SyncEngine()
 {
     abort();
+    releasePaths();
     _excludedFiles.reset();
 }
 
@@ -211,6 +266,40 @@ static bool isFileTransferInstruction(SyncInstructions instruction)
         || instruction == CSYNC_INSTRUCTION_TYPE_CHANGE;
 }
 
+/** A new local file that can be uploaded before discovery ends
+ *
+ * Anything that might still be affected by moves, removals, conflicts or
+ * end-to-end encryption waits for the regular propagation.
+ */
+static bool isStreamableUpload(const SyncFileItem &item)
+{
+    return item._instruction == CSYNC_INSTRUCTION_NEW
+        && item._direction == SyncFileItem::Up
+        && item._type == ItemTypeFile
+        && item._file == item._originalFile
+        && item._renameTarget.isEmpty()
+        && !item.isEncrypted()
+        && !item._isRestoration
+        && !Utility::isConflictFile(item._file);
+}
+
+/** Whether the discovery result of a directory can't change anymore
+ *
+ * Directory items are discovered after their contents. One that exists on
+ * both sides at the same path won't be moved or removed by the rest of the
+ * discovery, so neither are its new files.
+ */
+static bool isFinalDirectory(const SyncFileItem &item)
+{
+    return (item._instruction == CSYNC_INSTRUCTION_NONE || item._instruction == CSYNC_INSTRUCTION_UPDATE_METADATA)
+        && item._type == ItemTypeDirectory
+        && item._file == item._originalFile
+        && !item.isEncrypted()
+        && !item._isFileDropDetected
+        && !item._isEncryptedMetadataNeedUpdate
+        && !item._isSelectiveSync;
+}
+
 void SyncEngine::deleteStaleDownloadInfos(const SyncFileItemVector &syncItems)
 {
     // Find all downloadinfo paths that we want to preserve.
@@ -337,6 +426,10 @@ void OCC::SyncEngine::slotItemDiscovered(const OCC::SyncFileItemPtr &item)
 {
     emit itemDiscovered(item);
 
+    if (_syncOptions._streamingPropagation && item->isDirectory()) {
+        streamDirectoryItems(item);
+    }
+
     if (Utility::isConflictFile(item->_file))
         _seenConflictFiles.insert(item->_file);
     if (item->_instruction == CSYNC_INSTRUCTION_UPDATE_METADATA && !item->isDirectory()) {
@@ -478,9 +571,15 @@ void OCC::SyncEngine::slotItemDiscovered(const OCC::SyncFileItemPtr &item)
     checkErrorBlacklisting(*item);
     _needsUpdate = true;
 
-    // Insert sorted
-    auto it = std::lower_bound( _syncItems.begin(), _syncItems.end(), item ); // the _syncItems is sorted
-    _syncItems.insert( it, item );
+    // Sorted once discovery is done
+    _syncItems.append(item);
+
+    if (_syncOptions._streamingPropagation && isStreamableUpload(*item)) {
+        const auto slashPosition = item->_file.lastIndexOf(QLatin1Char('/'));
+        if (slashPosition > 0) {
+            _streamingCandidates[item->_file.left(slashPosition)].append(item);
+        }
+    }
 
     slotNewItem(item);
 
@@ -491,7 +590,11 @@ void OCC::SyncEngine::slotItemDiscovered(const OCC::SyncFileItemPtr &item)
 
 void SyncEngine::startSync()
 {
-    if (_journal->exists()) {
+    // A sync of a single item may run on an engine of its own next to the sync
+    // of the whole folder: the housekeeping of the whole journal is left to the latter
+    const auto singleItemSync = singleItemDiscoveryOptions().isValid();
+
+    if (_journal->exists() && !singleItemSync) {
         QVector<SyncJournalDb::PollInfo> pollInfos = _journal->getPollInfos();
         if (!pollInfos.isEmpty()) {
             qCInfo(lcEngine) << "Finish Poll jobs before starting a sync";
@@ -518,19 +621,31 @@ void SyncEngine::startSync()
         }
     }
 
-    if (s_anySyncRunning || _syncRunning) {
+    if (_syncRunning || (s_anySyncRunning && !singleItemSync)) {
         return;
     }
-    const auto currentEncryptionStatus = EncryptionStatusEnums::toDbEncryptionStatus(EncryptionStatusEnums::fromEndToEndEncryptionApiVersion(_account->capabilities().clientSideEncryptionVersion()));
-    [[maybe_unused]] const auto result = _journal->listAllE2eeFoldersWithEncryptionStatusLessThan(static_cast<int>(currentEncryptionStatus), [this](const SyncJournalFileRecord &record) {
-        _journal->schedulePathForRemoteDiscovery(record.path());
-    });
+    if (!singleItemSync) {
+        const auto currentEncryptionStatus = EncryptionStatusEnums::toDbEncryptionStatus(EncryptionStatusEnums::fromEndToEndEncryptionApiVersion(_account->capabilities().clientSideEncryptionVersion()));
+        [[maybe_unused]] const auto result = _journal->listAllE2eeFoldersWithEncryptionStatusLessThan(static_cast<int>(currentEncryptionStatus), [this](const SyncJournalFileRecord &record) {
+            _journal->schedulePathForRemoteDiscovery(record.path());
+        });
+        s_anySyncRunning = true;
+    }
 
-    s_anySyncRunning = true;
+    _singleItemSync = singleItemSync;
     _syncRunning = true;
+    _pathClaimsGeneration = pathClaims(_journal).generation;
     _anotherSyncNeeded = NoFollowUpSync;
     _clearTouchedFilesTimer.stop();
 
+    if (NetworkTimings::isEnabled() && !_singleItemSync) {
+        if (!_networkTimings) {
+            _networkTimings = QSharedPointer<NetworkTimings>::create();
+            NetworkTimings::attach(this, _networkTimings);
+        }
+        _networkTimings->startRun();
+    }
+
     _hasNoneFiles = false;
     _hasRemoveFile = false;
     _seenConflictFiles.clear();
@@ -569,6 +684,11 @@ void SyncEngine::startSync()
 
     _syncItems.clear();
     _needsUpdate = false;
+    _streamingCandidates.clear();
+    _streamingQueue.clear();
+    _streamedItems.clear();
+    _streamingStatus = SyncFileItem::Success;
+    _pendingPropagationStatus.reset();
 
     if (!_journal->exists()) {
         qCInfo(lcEngine) << "New sync (no sync journal exists)";
@@ -595,7 +715,12 @@ void SyncEngine::startSync()
     // Functionality like selective sync might have set up etag storage
     // filtering via schedulePathForRemoteDiscovery(). This *is* the next sync, so
     // undo the filter to allow this sync to retrieve and store the correct etags.
-    _journal->clearEtagStorageFilter();
+    if (!_singleItemSync) {
+        _journal->clearEtagStorageFilter();
+    }
+
+    // The blacklist stays loaded between runs, pick up what others wrote since the last one.
+    _journal->reloadErrorBlacklistOnNextUse();
 
     _excludedFiles->setExcludeConflictFiles(!_account->capabilities().uploadConflictFiles());
 
@@ -619,7 +744,9 @@ void SyncEngine::startSync()
         return;
     }
 
-    processCaseClashConflictsBeforeDiscovery();
+    if (!_singleItemSync) {
+        processCaseClashConflictsBeforeDiscovery();
+    }
 
     _stopWatch.start();
     _progressInfo->_status = ProgressInfo::Starting;
@@ -632,6 +759,9 @@ void SyncEngine::startSync()
     emit transmissionProgress(*_progressInfo);
 
     _discoveryPhase.reset(new DiscoveryPhase);
+    if (_networkTimings) {
+        NetworkTimings::attach(_discoveryPhase.data(), _networkTimings);
+    }
     _discoveryPhase->_leadingAndTrailingSpacesFilesAllowed = _leadingAndTrailingSpacesFilesAllowed;
     _discoveryPhase->_account = _account;
     _discoveryPhase->_excludes = _excludedFiles.data();
@@ -641,6 +771,7 @@ void SyncEngine::startSync()
         _discoveryPhase->_excludes->reloadExcludeFiles();
     }
     _discoveryPhase->_statedb = _journal;
+    _discoveryPhase->loadCaseClashConflictRecords();
     _discoveryPhase->_localDir = Utility::trailingSlashPath(_localPath);
     _discoveryPhase->_remoteFolder = Utility::trailingSlashPath(_remotePath);
     _discoveryPhase->_syncOptions = _syncOptions;
@@ -782,6 +913,11 @@ void SyncEngine::slotDiscoveryFinished()
 
     qCInfo(lcEngine) << "#### Discovery end #################################################### " << _stopWatch.addLapTime(QLatin1String("Discovery Finished")) << "ms";
 
+    // Whatever wasn't handed to the streaming propagator yet is still in
+    // _syncItems and goes with the regular propagation
+    _streamingCandidates.clear();
+    _streamingQueue.clear();
+
     // Sanity check
     if (!_journal->open()) {
         qCWarning(lcEngine) << "Bailing out, DB failure";
@@ -828,6 +964,53 @@ void SyncEngine::slotDiscoveryFinished()
             _anotherSyncNeeded = ImmediateFollowUp;
         }
 
+        // The items were appended in discovery order
+        sortSyncFileItems(_syncItems);
+
+        if (!_streamedItems.isEmpty()) {
+            QSet<const SyncFileItem *> streamedItems;
+            for (const auto &item : qAsConst(_streamedItems)) {
+                streamedItems.insert(item.data());
+            }
+            _syncItems.erase(std::remove_if(_syncItems.begin(), _syncItems.end(), [&streamedItems](const SyncFileItemPtr &item) {
+                return streamedItems.contains(item.data());
+            }), _syncItems.end());
+            qCInfo(lcEngine) << _streamedItems.size() << "items were propagated during discovery";
+        }
+
+        // With disjoint paths the commits of one engine on the shared journal are as
+        // harmless as the intermediate commits of the propagator
+        if (_singleItemSync) {
+            for (const auto &item : qAsConst(_syncItems)) {
+                if (const auto engine = otherEngineClaiming(*item)) {
+                    qCInfo(lcEngine) << item->_file << "is being synced by another sync of this folder, waiting for it";
+                    waitForPathsOf(engine);
+                    return;
+                }
+            }
+            if (pathClaims(_journal).generation != _pathClaimsGeneration) {
+                qCInfo(lcEngine) << "Another sync of this folder finished during discovery, discovering again";
+                waitForPathsOf(nullptr);
+                return;
+            }
+        } else {
+            const auto claimedElsewhere = std::remove_if(_syncItems.begin(), _syncItems.end(), [this](const SyncFileItemPtr &item) {
+                return otherEngineClaiming(*item) != nullptr;
+            });
+            if (claimedElsewhere != _syncItems.end()) {
+                qCInfo(lcEngine) << std::distance(claimedElsewhere, _syncItems.end()) << "items are being synced by the sync of a single item, leaving them to the next sync";
+                for (auto it = claimedElsewhere; it != _syncItems.end(); ++it) {
+                    // Keep the parent folders from storing the new etags
+                    _journal->schedulePathForRemoteDiscovery((*it)->_file);
+                }
+                _syncItems.erase(claimedElsewhere, _syncItems.end());
+                if (_anotherSyncNeeded == NoFollowUpSync) {
+                    _anotherSyncNeeded = ImmediateFollowUp;
+                }
+            }
+        }
+        claimPaths(_syncItems);
+
         Q_ASSERT(std::is_sorted(_syncItems.begin(), _syncItems.end()));
 
         qCInfo(lcEngine) << "#### Reconcile (aboutToPropagate) #################################################### " << _stopWatch.addLapTime(QStringLiteral("Reconcile (aboutToPropagate)")) << "ms";
@@ -863,27 +1046,26 @@ void SyncEngine::slotDiscoveryFinished()
         // do a database commit
         _journal->commit(QStringLiteral("post treewalk"));
 
-        _propagator = QSharedPointer<OwncloudPropagator>(
-            new OwncloudPropagator(_account, _localPath, _remotePath, _journal, _bulkUploadBlackList));
-        _propagator->setSyncOptions(_syncOptions);
-        connect(_propagator.data(), &OwncloudPropagator::itemCompleted,
-            this, &SyncEngine::slotItemCompleted);
-        connect(_propagator.data(), &OwncloudPropagator::progress,
-            this, &SyncEngine::slotProgress);
+        _propagator = createPropagator();
         connect(_propagator.data(), &OwncloudPropagator::finished, this, &SyncEngine::slotPropagationFinished, Qt::QueuedConnection);
-        connect(_propagator.data(), &OwncloudPropagator::seenLockedFile, this, &SyncEngine::seenLockedFile);
-        connect(_propagator.data(), &OwncloudPropagator::touchedFile, this, &SyncEngine::slotAddTouchedFile);
-        connect(_propagator.data(), &OwncloudPropagator::insufficientLocalStorage, this, &SyncEngine::slotInsufficientLocalStorage);
-        connect(_propagator.data(), &OwncloudPropagator::insufficientRemoteStorage, this, &SyncEngine::slotInsufficientRemoteStorage);
-        connect(_propagator.data(), &OwncloudPropagator::newItem, this, &SyncEngine::slotNewItem);
+        if (_streamingPropagator) {
+            // Both run under the limit of parallel jobs of the sync
+            _propagator->shareJobLimitsWith(_streamingPropagator.data());
+            _streamingPropagator->shareJobLimitsWith(_propagator.data());
+        }
 
         // apply the network limits to the propagator
         setNetworkLimits(_uploadLimit, _downloadLimit);
 
-        deleteStaleDownloadInfos(_syncItems);
-        deleteStaleUploadInfos(_syncItems);
-        deleteStaleErrorBlacklistEntries(_syncItems);
-        _journal->commit(QStringLiteral("post stale entry removal"));
+        // The items propagated during discovery are not stale either. A single item
+        // sync did not see the other items, which are not stale because of that.
+        if (!_singleItemSync) {
+            const auto allItems = _streamedItems.isEmpty() ? _syncItems : _syncItems + _streamedItems;
+            deleteStaleDownloadInfos(allItems);
+            deleteStaleUploadInfos(allItems);
+            deleteStaleErrorBlacklistEntries(allItems);
+            _journal->commit(QStringLiteral("post stale entry removal"));
+        }
 
         // Emit the started signal only after the propagator has been set up.
         if (_needsUpdate)
@@ -926,6 +1108,132 @@ void SyncEngine::slotDiscoveryFinished()
     finish();
 }
 
+QSharedPointer<OwncloudPropagator> SyncEngine::createPropagator()
+{
+    const auto propagator = QSharedPointer<OwncloudPropagator>(
+        new OwncloudPropagator(_account, _localPath, _remotePath, _journal, _bulkUploadBlackList));
+    propagator->setSyncOptions(_syncOptions);
+    propagator->_uploadLimit = _uploadLimit;
+    propagator->_downloadLimit = _downloadLimit;
+    connect(propagator.data(), &OwncloudPropagator::itemCompleted,
+        this, &SyncEngine::slotItemCompleted);
+    connect(propagator.data(), &OwncloudPropagator::progress,
+        this, &SyncEngine::slotProgress);
+    connect(propagator.data(), &OwncloudPropagator::seenLockedFile, this, &SyncEngine::seenLockedFile);
+    connect(propagator.data(), &OwncloudPropagator::touchedFile, this, &SyncEngine::slotAddTouchedFile);
+    connect(propagator.data(), &OwncloudPropagator::insufficientLocalStorage, this, &SyncEngine::slotInsufficientLocalStorage);
+    connect(propagator.data(), &OwncloudPropagator::insufficientRemoteStorage, this, &SyncEngine::slotInsufficientRemoteStorage);
+    connect(propagator.data(), &OwncloudPropagator::newItem, this, &SyncEngine::slotNewItem);
+    if (_networkTimings) {
+        NetworkTimings::attach(propagator.data(), _networkTimings);
+    }
+    return propagator;
+}
+
+void SyncEngine::streamDirectoryItems(const SyncFileItemPtr &directoryItem)
+{
+    const auto candidates = _streamingCandidates.take(directoryItem->_file);
+    if (candidates.isEmpty() || !isFinalDirectory(*directoryItem)) {
+        // They stay in _syncItems for the regular propagation
+        return;
+    }
+    for (const auto &item : candidates) {
+        // blacklisting and the other checks ran before it became a candidate,
+        // but keep away from anything that was changed since
+        if (isStreamableUpload(*item)) {
+            _streamingQueue.append(item);
+        }
+    }
+    // Once the directory item itself has been looked at, see startStreamingPropagation()
+    QMetaObject::invokeMethod(this, [this] { startStreamingPropagation(); }, Qt::QueuedConnection);
+}
+
+void SyncEngine::startStreamingPropagation()
+{
+    if (_streamingPropagator || _streamingQueue.isEmpty() || !_discoveryPhase) {
+        // The running propagation picks up the queue when it is done
+        return;
+    }
+    if (_singleItemSync) {
+        // It only claims its paths once discovery is over, the items stay in _syncItems
+        return;
+    }
+    if (!_hasNoneFiles) {
+        // Until an unchanged item shows up the user may still have to confirm that all
+        // files are removed, nothing is uploaded before that
+        return;
+    }
+
+    auto items = std::move(_streamingQueue);
+    _streamingQueue.clear();
+    // Left in _syncItems, the end of discovery checks them again
+    items.erase(std::remove_if(items.begin(), items.end(), [this](const SyncFileItemPtr &item) {
+        return otherEngineClaiming(*item) != nullptr;
+    }), items.end());
+    if (items.isEmpty()) {
+        return;
+    }
+    claimPaths(items);
+    sortSyncFileItems(items);
+    _streamedItems.append(items);
+    qCInfo(lcEngine) << "Propagating" << items.size() << "new files while discovery continues";
+
+    emit aboutToPropagateEarly(items);
+
+    if (!_progressInfo->isUpdatingEstimates()) {
+        _progressInfo->startEstimateUpdates();
+    }
+
+    _streamingPropagator = createPropagator();
+    connect(_streamingPropagator.data(), &OwncloudPropagator::finished, this, &SyncEngine::slotStreamingPropagationFinished, Qt::QueuedConnection);
+    _streamingPropagator->start(std::move(items));
+}
+
+void SyncEngine::abortStreamingPropagation()
+{
+    if (!_streamingPropagator) {
+        return;
+    }
+    const auto propagator = _streamingPropagator;
+    _streamingPropagator.clear();
+    disconnect(propagator.data(), nullptr, this, nullptr);
+
+    // Keep it alive until its jobs are done aborting
+    const auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(propagator.data(), &OwncloudPropagator::finished, this, [propagator, connection] {
+        QObject::disconnect(*connection);
+    }, Qt::QueuedConnection);
+    propagator->abort();
+}
+
+void SyncEngine::slotStreamingPropagationFinished(OCC::SyncFileItem::Status status)
+{
+    if (!_streamingPropagator) {
+        return;
+    }
+    if (_streamingPropagator->_anotherSyncNeeded && _anotherSyncNeeded == NoFollowUpSync) {
+        _anotherSyncNeeded = ImmediateFollowUp;
+    }
+    if (status != SyncFileItem::Success && _streamingStatus == SyncFileItem::Success) {
+        _streamingStatus = status;
+    }
+    _streamingPropagator.clear();
+
+    if (_propagator) {
+        // Discovery is over, the regular propagation may be waiting for us
+        if (_pendingPropagationStatus) {
+            const auto pendingStatus = *_pendingPropagationStatus;
+            _pendingPropagationStatus.reset();
+            slotPropagationFinished(pendingStatus);
+        }
+    } else if (_discoveryPhase) {
+        startStreamingPropagation();
+    } else {
+        // the sync was aborted during discovery
+        finalize(false);
+    }
+}
+
 void SyncEngine::slotCleanPollsJobAborted(const QString &error, const ErrorCategory errorCategory)
 {
     emit syncError(error, errorCategory);
@@ -937,6 +1245,11 @@ void SyncEngine::setNetworkLimits(int upload, int download)
     _uploadLimit = upload;
     _downloadLimit = download;
 
+    if (_streamingPropagator) {
+        _streamingPropagator->_uploadLimit = upload;
+        _streamingPropagator->_downloadLimit = download;
+    }
+
     if (!_propagator)
         return;
 
@@ -958,6 +1271,15 @@ void SyncEngine::slotItemCompleted(const SyncFileItemPtr &item, const ErrorCateg
 
 void SyncEngine::slotPropagationFinished(OCC::SyncFileItem::Status status)
 {
+    if (_streamingPropagator) {
+        // Wait for the files that started uploading during discovery
+        _pendingPropagationStatus = status;
+        return;
+    }
+    if (status == SyncFileItem::Success) {
+        status = _streamingStatus;
+    }
+
     if (_propagator->_anotherSyncNeeded && _anotherSyncNeeded == NoFollowUpSync) {
         _anotherSyncNeeded = ImmediateFollowUp;
     }
@@ -966,10 +1288,12 @@ void SyncEngine::slotPropagationFinished(OCC::SyncFileItem::Status status)
         _journal->setDataFingerprint(_discoveryPhase->_dataFingerprint);
     }
 
-    conflictRecordMaintenance();
-    caseClashConflictRecordMaintenance();
+    if (!_singleItemSync) {
+        conflictRecordMaintenance();
+        caseClashConflictRecordMaintenance();
 
-    _journal->deleteStaleFlagsEntries();
+        _journal->deleteStaleFlagsEntries();
+    }
     _journal->commit("All Finished.", false);
 
     // Send final progress information even if no
@@ -989,11 +1313,39 @@ void SyncEngine::finalize(bool success)
     qCInfo(lcEngine) << "Sync run took " << _stopWatch.addLapTime(QLatin1String("Sync Finished")) << "ms";
     _stopWatch.stop();
 
+    if (!_singleItemSync && lcEngine().isDebugEnabled()) {
+        qCDebug(lcEngine).noquote() << "Most expensive journal statements so far:\n" << _journal->queryStatisticsSummary();
+    }
+
+    if (NetworkTimings::isEnabled() && _networkTimings) {
+        qCInfo(lcEngine).noquote() << "Network timings:\n" << _networkTimings->statsSummary();
+        auto harDirectory = Logger::instance()->logDir();
+        if (harDirectory.isEmpty()) {
+            harDirectory = QDir::tempPath();
+        }
+        // Named after the journal too, several folders may finish their sync at the same time
+        const auto journalName = QFileInfo(_journal->databaseFilePath()).completeBaseName().remove(QLatin1Char('.'));
+        const auto harFile = QDir(harDirectory).filePath(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_HHmmss_"))
+            + journalName + QStringLiteral("_network.har"));
+        if (_networkTimings->writeHar(harFile)) {
+            qCInfo(lcEngine) << "Network timings of this sync run written to" << harFile;
+        }
+    }
+
     if (_discoveryPhase) {
         _discoveryPhase.take()->deleteLater();
     }
-    s_anySyncRunning = false;
+    abortStreamingPropagation();
+    _streamingCandidates.clear();
+    _streamingQueue.clear();
+    _streamedItems.clear();
+
+    if (!_singleItemSync) {
+        s_anySyncRunning = false;
+    }
+    _singleItemSync = false;
     _syncRunning = false;
+    releasePaths();
     emit finished(success);
 
     if (_account->shouldSkipE2eeMetadataChecksumValidation()) {
@@ -1247,16 +1599,98 @@ void SyncEngine::abort()
         // If we're already in the propagation phase, aborting that is sufficient
         qCInfo(lcEngine) << "Aborting sync in propagator...";
         _propagator->abort();
+        if (_streamingPropagator) {
+            _streamingPropagator->abort();
+        }
     } else if (_discoveryPhase) {
         // Delete the discovery and all child jobs after ensuring
         // it can't finish and start the propagator
         disconnect(_discoveryPhase.data(), nullptr, this, nullptr);
         _discoveryPhase.take()->deleteLater();
         qCInfo(lcEngine) << "Aborting sync in discovery...";
+        if (_streamingPropagator) {
+            // finalize once the uploads started during discovery are aborted
+            _streamingQueue.clear();
+            _streamingPropagator->abort();
+            return;
+        }
+        finalize(false);
+    } else if (_waitingForPaths) {
+        qCInfo(lcEngine) << "Aborting sync waiting for another sync of this folder...";
+        _waitingForPaths = false;
+        if (_pathsClaimant) {
+            disconnect(_pathsClaimant.data(), nullptr, this, nullptr);
+        }
         finalize(false);
     }
 }
 
+SyncEngine *SyncEngine::otherEngineClaiming(const SyncFileItem &item) const
+{
+    const auto &claims = pathClaims(_journal).claims;
+    if (claims.isEmpty()) {
+        return nullptr;
+    }
+    for (const auto &claim : pathClaimsOf(item, this)) {
+        for (const auto &other : claims) {
+            if (other.engine != this && overlaps(claim, other)) {
+                return const_cast<SyncEngine *>(other.engine);
+            }
+        }
+    }
+    return nullptr;
+}
+
+void SyncEngine::claimPaths(const SyncFileItemVector &items)
+{
+    auto &claims = pathClaims(_journal).claims;
+    for (const auto &item : items) {
+        claims.append(pathClaimsOf(*item, this));
+    }
+}
+
+void SyncEngine::releasePaths()
+{
+    auto &journalClaims = pathClaims(_journal);
+    const auto released = std::remove_if(journalClaims.claims.begin(), journalClaims.claims.end(), [this](const PathClaim &claim) {
+        return claim.engine == this;
+    });
+    if (released != journalClaims.claims.end()) {
+        journalClaims.claims.erase(released, journalClaims.claims.end());
+        ++journalClaims.generation;
+    }
+}
+
+void SyncEngine::waitForPathsOf(SyncEngine *engine)
+{
+    // Discover again once the other sync is done, its results would be outdated
+    _syncItems.clear();
+    if (_discoveryPhase) {
+        _discoveryPhase.take()->deleteLater();
+    }
+    _syncRunning = false;
+    _waitingForPaths = true;
+    _pathsClaimant = engine;
+    if (!engine) {
+        QMetaObject::invokeMethod(this, &SyncEngine::slotPathsReleased, Qt::QueuedConnection);
+        return;
+    }
+    connect(engine, &SyncEngine::finished, this, &SyncEngine::slotPathsReleased, Qt::QueuedConnection);
+    connect(engine, &QObject::destroyed, this, &SyncEngine::slotPathsReleased, Qt::QueuedConnection);
+}
+
+void SyncEngine::slotPathsReleased()
+{
+    if (!_waitingForPaths) {
+        return;
+    }
+    _waitingForPaths = false;
+    if (_pathsClaimant) {
+        disconnect(_pathsClaimant.data(), nullptr, this, nullptr);
+    }
+    startSync();
+}
+
 void SyncEngine::slotSummaryError(const QString &message)
 {
     if (_uniqueErrors.contains(message))
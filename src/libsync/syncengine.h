@@ -24,6 +24,8 @@
 #include <QMap>
 #include <QStringList>
 #include <QSharedPointer>
+#include <QPointer>
+#include <optional>
 #include <set>
 
 #include "syncfileitem.h"
@@ -41,6 +43,7 @@ namespace OCC {
 class SyncJournalFileRecord;
 class SyncJournalDb;
 class OwncloudPropagator;
+class NetworkTimings;
 class ProcessDirectoryJob;
 
 enum AnotherSyncNeeded {
@@ -127,9 +130,18 @@ public:
     static void switchToVirtualFiles(const QString &localPath, SyncJournalDb &journal, Vfs &vfs);
 
     [[nodiscard]] QSharedPointer<OwncloudPropagator> getPropagator() const { return _propagator; } // for the test
+
+    /// The timings of this engine's requests, null unless NetworkTimings::isEnabled() when a sync started
+    [[nodiscard]] QSharedPointer<NetworkTimings> networkTimings() const { return _networkTimings; }
     [[nodiscard]] const SyncEngine::SingleItemDiscoveryOptions &singleItemDiscoveryOptions() const;
 
 public slots:
+    /**
+     * Limits the next sync to one item and the folders leading to it.
+     *
+     * Such a sync leaves the journal-wide maintenance alone, so it can
+     * run on an engine of its own next to the sync of the whole folder.
+     */
     void setSingleItemDiscoveryOptions(const OCC::SyncEngine::SingleItemDiscoveryOptions &singleItemDiscoveryOptions);
 
     void startSync();
@@ -162,6 +174,9 @@ signals:
     // after the above signals. with the items that actually need propagating
     void aboutToPropagate(OCC::SyncFileItemVector &);
 
+    // with streaming propagation, for the items propagated while discovery is still running
+    void aboutToPropagateEarly(OCC::SyncFileItemVector &);
+
     // after each item completed by a job (successful or not)
     void itemCompleted(const OCC::SyncFileItemPtr &item, const OCC::ErrorCategory category);
 
@@ -213,6 +228,7 @@ private slots:
     void slotItemCompleted(const OCC::SyncFileItemPtr &item, const OCC::ErrorCategory category);
     void slotDiscoveryFinished();
     void slotPropagationFinished(SyncFileItem::Status status);
+    void slotStreamingPropagationFinished(SyncFileItem::Status status);
     void slotProgress(const OCC::SyncFileItem &item, qint64 current);
     void slotCleanPollsJobAborted(const QString &error, const OCC::ErrorCategory category);
 
@@ -232,6 +248,9 @@ private slots:
     void slotUnscheduleFilesDelayedSync();
     void slotCleanupScheduledSyncTimers();
 
+    /** The sync this one waits for released its paths */
+    void slotPathsReleased();
+
 private:
     // Some files need a sync run to be executed at a specified time after
     // their status is scheduled to change (e.g. lock status will expire in
@@ -293,6 +312,21 @@ private:
     // cleanup and emit the finished signal
     void finalize(bool success);
 
+    // The other running sync of the journal that is going to propagate the path of item, if any
+    [[nodiscard]] SyncEngine *otherEngineClaiming(const SyncFileItem &item) const;
+    void claimPaths(const SyncFileItemVector &items);
+    void releasePaths();
+    // Drops the discovery results and starts again once engine is finished, right away without engine
+    void waitForPathsOf(SyncEngine *engine);
+
+    [[nodiscard]] QSharedPointer<OwncloudPropagator> createPropagator();
+
+    // Streaming propagation: hands the new uploads waiting for this directory
+    // to the propagator if its discovery result is final
+    void streamDirectoryItems(const SyncFileItemPtr &directoryItem);
+    void startStreamingPropagation();
+    void abortStreamingPropagation();
+
     void processCaseClashConflictsBeforeDiscovery();
 
     // Aggregate scheduled sync runs into interval buckets. Can be used to
@@ -328,6 +362,19 @@ private:
     QScopedPointer<DiscoveryPhase> _discoveryPhase;
     QSharedPointer<OwncloudPropagator> _propagator;
 
+    // Streaming propagation (SyncOptions::_streamingPropagation):
+    // new uploads waiting for the discovery of their directory to complete,
+    // uploads ready to go and all items propagated before the end of discovery.
+    QHash<QString, SyncFileItemVector> _streamingCandidates;
+    SyncFileItemVector _streamingQueue;
+    SyncFileItemVector _streamedItems;
+    QSharedPointer<OwncloudPropagator> _streamingPropagator;
+
+    QSharedPointer<NetworkTimings> _networkTimings; // null while not recording
+    SyncFileItem::Status _streamingStatus = SyncFileItem::Success;
+    // Status of the regular propagation if it finished before the streaming one
+    std::optional<SyncFileItem::Status> _pendingPropagationStatus;
+
     QSet<QString> _bulkUploadBlackList;
 
     // List of all files with conflicts
@@ -396,6 +443,16 @@ private:
     QVector<QSharedPointer<ScheduledSyncTimer>> _scheduledSyncTimers;
 
     SingleItemDiscoveryOptions _singleItemDiscoveryOptions;
+
+    // The running sync is limited to the item of _singleItemDiscoveryOptions,
+    // it can run next to another engine syncing the same journal
+    bool _singleItemSync = false;
+
+    // A single item sync waits for _pathsClaimant to finish before it discovers again
+    bool _waitingForPaths = false;
+    QPointer<SyncEngine> _pathsClaimant;
+    // The generation of the path claims of the journal when this sync started
+    quint64 _pathClaimsGeneration = 0;
 };
 }
 
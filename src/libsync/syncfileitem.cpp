@@ -22,6 +22,8 @@
 #include <QLoggingCategory>
 #include "csync/vio/csync_vio_local.h"
 
+#include <algorithm>
+
 namespace OCC {
 
 Q_LOGGING_CATEGORY(lcFileItem, "nextcloud.sync.fileitem", QtInfoMsg)
@@ -252,4 +254,43 @@ void SyncFileItem::updateLockStateFromDbRecord(const SyncJournalFileRecord &dbRe
     _lockTimeout = dbRecord._lockstate._lockTimeout;
 }
 
+QByteArray pathSortKey(const QString &path)
+{
+    // Two big endian bytes per UTF-16 code unit. '/' becomes the lowest
+    // value and everything that sorted below it moves up by one.
+    QByteArray key(path.size() * 2, Qt::Uninitialized);
+    auto out = reinterpret_cast<uchar *>(key.data());
+    for (const auto c : path) {
+        auto unit = c.unicode();
+        if (unit == u'/') {
+            unit = 0;
+        } else if (unit < u'/') {
+            ++unit;
+        }
+        *out++ = static_cast<uchar>(unit >> 8);
+        *out++ = static_cast<uchar>(unit & 0xff);
+    }
+    return key;
+}
+
+void sortSyncFileItems(SyncFileItemVector &items)
+{
+    if (items.size() < 2) {
+        return;
+    }
+
+    QVector<QPair<QByteArray, SyncFileItemPtr>> keyedItems;
+    keyedItems.reserve(items.size());
+    for (auto it = items.crbegin(); it != items.crend(); ++it) {
+        keyedItems.append(qMakePair(pathSortKey((*it)->destination()), *it));
+    }
+    std::stable_sort(keyedItems.begin(), keyedItems.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    for (int i = 0; i < keyedItems.size(); ++i) {
+        items[i] = std::move(keyedItems[i].second);
+    }
+}
+
 }
@@ -312,6 +312,21 @@ public:
     // - for conflicts (remote checksum)
     QByteArray _checksumHeader;
 
+    /** For new local files: synced files of the same size that may have identical content
+     *
+     * The upload compares their checksum with the one it computes anyway and
+     * copies a matching file on the server instead of sending the content, see
+     * PropagateUploadFileCommon. The etag is the one the source must still
+     * have for the copy to be valid.
+     */
+    struct CopySourceCandidate
+    {
+        QString path;
+        QByteArray etag;
+        QByteArray checksumHeader;
+    };
+    QVector<CopySourceCandidate> _copySourceCandidates;
+
     // The size and modtime of the file getting overwritten (on the disk for downloads, on the server for uploads).
     qint64 _previousSize = 0;
     time_t _previousModtime = 0;
@@ -343,6 +358,23 @@ inline bool operator<(const SyncFileItemPtr &item1, const SyncFileItemPtr &item2
 }
 
 using SyncFileItemVector = QVector<SyncFileItemPtr>;
+
+/**
+ * @brief Byte string that orders paths like operator< on SyncFileItem
+ *
+ * Comparing two keys with memcmp gives the same result as comparing the
+ * paths, without having to special case '/' on every comparison.
+ */
+OWNCLOUDSYNC_EXPORT QByteArray pathSortKey(const QString &path);
+
+/**
+ * @brief Sorts the items by destination, like std::sort with operator< would
+ *
+ * The sort key of every item is computed once. Items with the same
+ * destination end up in reverse order, as if each had been inserted
+ * with std::lower_bound.
+ */
+OWNCLOUDSYNC_EXPORT void sortSyncFileItems(SyncFileItemVector &items);
 }
 
 Q_DECLARE_METATYPE(OCC::SyncFileItem)
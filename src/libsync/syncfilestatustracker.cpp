@@ -115,6 +115,8 @@ SyncFileStatusTracker::SyncFileStatusTracker(SyncEngine *syncEngine)
 {
     connect(syncEngine, &SyncEngine::aboutToPropagate,
         this, &SyncFileStatusTracker::slotAboutToPropagate);
+    connect(syncEngine, &SyncEngine::aboutToPropagateEarly,
+        this, &SyncFileStatusTracker::slotAboutToPropagateEarly);
     connect(syncEngine, &SyncEngine::itemCompleted,
         this, &SyncFileStatusTracker::slotItemCompleted);
     connect(syncEngine, &SyncEngine::finished, this, &SyncFileStatusTracker::slotSyncFinished);
@@ -185,52 +187,80 @@ void SyncFileStatusTracker::slotCheckAndRemoveSilentlyExcluded(const QString &fo
     }
 }
 
-void SyncFileStatusTracker::incSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedFlag)
+void SyncFileStatusTracker::incSyncCount(const QString &relativePath, SharedFlag sharedFlag)
 {
     // Will return 0 (and increase to 1) if the path wasn't in the map yet
     int count = _syncCount[relativePath]++;
     if (!count) {
-        SyncFileStatus status = sharedFlag == UnknownShared
-            ? fileStatus(relativePath)
-            : resolveSyncAndErrorStatus(relativePath, sharedFlag);
-        emit fileStatusChanged(getSystemDestination(relativePath), status);
+        scheduleStatusChange(relativePath, sharedFlag);
 
         // We passed from OK to SYNC, increment the parent to keep it marked as
         // SYNC while we propagate ourselves and our own children.
         ASSERT(!relativePath.endsWith('/'));
         int lastSlashIndex = relativePath.lastIndexOf('/');
         if (lastSlashIndex != -1)
-            incSyncCountAndEmitStatusChanged(relativePath.left(lastSlashIndex), UnknownShared);
+            incSyncCount(relativePath.left(lastSlashIndex), UnknownShared);
         else if (!relativePath.isEmpty())
-            incSyncCountAndEmitStatusChanged(QString(), UnknownShared);
+            incSyncCount(QString(), UnknownShared);
     }
 }
 
-void SyncFileStatusTracker::decSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedFlag)
+void SyncFileStatusTracker::decSyncCount(const QString &relativePath, SharedFlag sharedFlag)
 {
     int count = --_syncCount[relativePath];
     if (!count) {
         // Remove from the map, same as 0
         _syncCount.remove(relativePath);
 
-        SyncFileStatus status = sharedFlag == UnknownShared
-            ? fileStatus(relativePath)
-            : resolveSyncAndErrorStatus(relativePath, sharedFlag);
-        emit fileStatusChanged(getSystemDestination(relativePath), status);
+        scheduleStatusChange(relativePath, sharedFlag);
 
         // We passed from SYNC to OK, decrement our parent.
         ASSERT(!relativePath.endsWith('/'));
         int lastSlashIndex = relativePath.lastIndexOf('/');
         if (lastSlashIndex != -1)
-            decSyncCountAndEmitStatusChanged(relativePath.left(lastSlashIndex), UnknownShared);
+            decSyncCount(relativePath.left(lastSlashIndex), UnknownShared);
         else if (!relativePath.isEmpty())
-            decSyncCountAndEmitStatusChanged(QString(), UnknownShared);
+            decSyncCount(QString(), UnknownShared);
+    }
+}
+
+void SyncFileStatusTracker::scheduleStatusChange(const QString &relativePath, SharedFlag sharedFlag)
+{
+    auto it = _pendingStatusChanges.find(relativePath);
+    if (it == _pendingStatusChanges.end()) {
+        _pendingStatusChanges.insert(relativePath, sharedFlag);
+    } else if (sharedFlag != UnknownShared) {
+        // Spares the database lookup of fileStatus()
+        it.value() = sharedFlag;
+    }
+}
+
+void SyncFileStatusTracker::emitPendingStatusChanges()
+{
+    if (_pendingStatusChanges.isEmpty()) {
+        return;
+    }
+    QHash<QString, SharedFlag> pendingStatusChanges;
+    std::swap(_pendingStatusChanges, pendingStatusChanges);
+
+    // Children sort after their parents, emit them first so that a
+    // directory never shows up to date before its contents
+    auto paths = pendingStatusChanges.keys();
+    std::sort(paths.begin(), paths.end(), [](const QString &lhs, const QString &rhs) {
+        return pathCompare(lhs, rhs) > 0;
+    });
+    for (const auto &path : qAsConst(paths)) {
+        const auto sharedFlag = pendingStatusChanges.value(path);
+        const auto status = sharedFlag == UnknownShared
+            ? fileStatus(path)
+            : resolveSyncAndErrorStatus(path, sharedFlag);
+        emit fileStatusChanged(getSystemDestination(path), status);
     }
 }
 
 void SyncFileStatusTracker::slotAboutToPropagate(SyncFileItemVector &items)
 {
-    ASSERT(_syncCount.isEmpty());
+    ASSERT(_syncCount.isEmpty() || _hasEarlyPropagation);
 
     ProblemsMap oldProblems;
     std::swap(_syncProblems, oldProblems);
@@ -254,9 +284,9 @@ void SyncFileStatusTracker::slotAboutToPropagate(SyncFileItemVector &items)
             && item->_instruction != CSYNC_INSTRUCTION_IGNORE
             && item->_instruction != CSYNC_INSTRUCTION_ERROR) {
             // Mark this path as syncing for instructions that will result in propagation.
-            incSyncCountAndEmitStatusChanged(item->destination(), sharedFlag);
+            incSyncCount(item->destination(), sharedFlag);
         } else {
-            emit fileStatusChanged(getSystemDestination(item->destination()), resolveSyncAndErrorStatus(item->destination(), sharedFlag));
+            scheduleStatusChange(item->destination(), sharedFlag);
         }
     }
 
@@ -266,7 +296,7 @@ void SyncFileStatusTracker::slotAboutToPropagate(SyncFileItemVector &items)
     QSet<QString> oldDirtyPaths;
     std::swap(_dirtyPaths, oldDirtyPaths);
     for (const auto &oldDirtyPath : qAsConst(oldDirtyPaths))
-        emit fileStatusChanged(getSystemDestination(oldDirtyPath), fileStatus(oldDirtyPath));
+        scheduleStatusChange(oldDirtyPath, UnknownShared);
 
     // Make sure to push any status that might have been resolved indirectly since the last sync
     // (like an error file being deleted from disk)
@@ -277,8 +307,22 @@ void SyncFileStatusTracker::slotAboutToPropagate(SyncFileItemVector &items)
         SyncFileStatus::SyncFileStatusTag severity = oldProblem.second;
         if (severity == SyncFileStatus::StatusError)
             invalidateParentPaths(path);
-        emit fileStatusChanged(getSystemDestination(path), fileStatus(path));
+        scheduleStatusChange(path, UnknownShared);
+    }
+
+    emitPendingStatusChanges();
+}
+
+void SyncFileStatusTracker::slotAboutToPropagateEarly(SyncFileItemVector &items)
+{
+    // Only new uploads are propagated early, they are all marked as syncing
+    _hasEarlyPropagation = true;
+    for (const auto &item : qAsConst(items)) {
+        _dirtyPaths.remove(item->destination());
+        const auto sharedFlag = item->_remotePerm.hasPermission(RemotePermissions::IsShared) ? Shared : NotShared;
+        incSyncCount(item->destination(), sharedFlag);
     }
+    emitPendingStatusChanges();
 }
 
 void SyncFileStatusTracker::slotItemCompleted(const SyncFileItemPtr &item)
@@ -301,14 +345,17 @@ void SyncFileStatusTracker::slotItemCompleted(const SyncFileItemPtr &item)
         && item->_instruction != CSYNC_INSTRUCTION_IGNORE
         && item->_instruction != CSYNC_INSTRUCTION_ERROR) {
         // decSyncCount calls *must* be symmetric with incSyncCount calls in slotAboutToPropagate
-        decSyncCountAndEmitStatusChanged(item->destination(), sharedFlag);
+        decSyncCount(item->destination(), sharedFlag);
     } else {
-        emit fileStatusChanged(getSystemDestination(item->destination()), resolveSyncAndErrorStatus(item->destination(), sharedFlag));
+        scheduleStatusChange(item->destination(), sharedFlag);
     }
+    emitPendingStatusChanges();
 }
 
 void SyncFileStatusTracker::slotSyncFinished()
 {
+    _hasEarlyPropagation = false;
+
     // Clear the sync counts to reduce the impact of unsymetrical inc/dec calls (e.g. when directory job abort)
     QHash<QString, int> oldSyncCount;
     std::swap(_syncCount, oldSyncCount);
@@ -318,8 +365,9 @@ void SyncFileStatusTracker::slotSyncFinished()
             continue;
         }
 
-        emit fileStatusChanged(getSystemDestination(it.key()), fileStatus(it.key()));
+        scheduleStatusChange(it.key(), UnknownShared);
     }
+    emitPendingStatusChanges();
 }
 
 void SyncFileStatusTracker::slotSyncEngineRunningChanged()
@@ -355,7 +403,7 @@ void SyncFileStatusTracker::invalidateParentPaths(const QString &path)
     QStringList splitPath = path.split('/', Qt::SkipEmptyParts);
     for (int i = 0; i < splitPath.size(); ++i) {
         QString parentPath = QStringList(splitPath.mid(0, i)).join(QLatin1String("/"));
-        emit fileStatusChanged(getSystemDestination(parentPath), fileStatus(parentPath));
+        scheduleStatusChange(parentPath, UnknownShared);
     }
 }
 
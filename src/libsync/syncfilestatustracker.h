@@ -49,6 +49,7 @@ signals:
 
 private slots:
     void slotAboutToPropagate(OCC::SyncFileItemVector &items);
+    void slotAboutToPropagateEarly(OCC::SyncFileItemVector &items);
     void slotItemCompleted(const OCC::SyncFileItemPtr &item);
     void slotSyncFinished();
     void slotSyncEngineRunningChanged();
@@ -69,8 +70,13 @@ private:
 
     void invalidateParentPaths(const QString &path);
     QString getSystemDestination(const QString &relativePath);
-    void incSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedState);
-    void decSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedState);
+    void incSyncCount(const QString &relativePath, SharedFlag sharedState);
+    void decSyncCount(const QString &relativePath, SharedFlag sharedState);
+
+    // Status changes are collected while a batch of items is processed and
+    // emitted once per path at its end, children before their parents.
+    void scheduleStatusChange(const QString &relativePath, SharedFlag sharedState);
+    void emitPendingStatusChanges();
 
     SyncEngine *_syncEngine;
 
@@ -81,6 +87,9 @@ private:
     // We'll show a file/directory as SYNC as long as its sync count is > 0.
     // A directory that starts/ends propagation will in turn increase/decrease its own parent by 1.
     QHash<QString, int> _syncCount;
+    // Items propagated during discovery are counted before slotAboutToPropagate
+    bool _hasEarlyPropagation = false;
+    QHash<QString, SharedFlag> _pendingStatusChanges;
 };
 }
 
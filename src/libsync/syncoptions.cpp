@@ -64,6 +64,15 @@ void SyncOptions::fillFromEnvironmentVariables()
     if (!targetChunkUploadDurationEnv.isEmpty())
         _targetChunkUploadDuration = std::chrono::milliseconds(targetChunkUploadDurationEnv.toUInt());
 
+    if (qEnvironmentVariableIsSet("OWNCLOUD_DEDUPLICATE_UPLOADS"))
+        _deduplicateUploads = qEnvironmentVariableIntValue("OWNCLOUD_DEDUPLICATE_UPLOADS") != 0;
+
+    if (qEnvironmentVariableIsSet("OWNCLOUD_COMPRESS_UPLOADS"))
+        _compressUploads = qEnvironmentVariableIntValue("OWNCLOUD_COMPRESS_UPLOADS") != 0;
+
+    if (qEnvironmentVariableIsSet("OWNCLOUD_STREAMING_PROPAGATION"))
+        _streamingPropagation = qEnvironmentVariableIntValue("OWNCLOUD_STREAMING_PROPAGATION") != 0;
+
     int maxParallel = qgetenv("OWNCLOUD_MAX_PARALLEL").toInt();
     if (maxParallel > 0)
         _parallelNetworkJobs = maxParallel;
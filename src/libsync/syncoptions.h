@@ -63,6 +63,34 @@ public:
      */
     std::chrono::milliseconds _targetChunkUploadDuration = std::chrono::minutes(1);
 
+    /** If new files whose content was already uploaded to the account should be
+     * copied on the server instead of being uploaded again
+     *
+     * Off by default, enabled with OWNCLOUD_DEDUPLICATE_UPLOADS=1.
+     */
+    bool _deduplicateUploads = false;
+
+    /** Files smaller than this (in Bytes) are always uploaded, a COPY would not save anything */
+    qint64 _deduplicateUploadsMinSize = 1000 * 1000; // 1MB
+
+    /** If uploads in a single request may be sent gzip encoded, see TransferCompression
+     *
+     * No server announces support for encoded uploads, so this is off by
+     * default and enabled with OWNCLOUD_COMPRESS_UPLOADS=1 against servers that
+     * are known to decode them. The size the server stored is checked after
+     * each encoded upload. A 415 reply or a wrong size turns it off for the
+     * account and the file is sent again as is.
+     */
+    bool _compressUploads = false;
+
+    /** If new files should already be uploaded while discovery is still running
+     *
+     * Only files in directories whose discovery is complete and that are
+     * neither moved nor removed are propagated early, everything else waits
+     * for the end of discovery as usual.
+     */
+    bool _streamingPropagation = false;
+
     /** The maximum number of active jobs in parallel  */
     int _parallelNetworkJobs = 6;
 
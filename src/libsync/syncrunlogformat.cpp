@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "config.h"
+#include "syncrunlogformat.h"
+#include "completedsyncitem.h"
+
+#include <QFile>
+
+#ifdef ZLIB_FOUND
+#include <zlib.h>
+#endif
+
+namespace OCC {
+
+namespace {
+
+QString dateTimeStr(const QDateTime &dt)
+{
+    return dt.toString(Qt::ISODate);
+}
+
+bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+}
+
+bool SyncRunLogFormat::shouldLog(const CompletedSyncItem &item)
+{
+    // don't log the directory items that are in the list
+    return item.direction() != SyncFileItem::None
+        && item.instruction() != CSYNC_INSTRUCTION_IGNORE;
+}
+
+SyncRunLogFormat::Record SyncRunLogFormat::itemRecord(const CompletedSyncItem &item)
+{
+    Record record;
+    record.type = RecordType::Item;
+
+    auto &line = record.item;
+    line.responseTimeStamp = item.responseTimeStamp();
+    line.file = item.file();
+    line.renameTarget = item.renameTarget();
+    line.errorString = item.errorString();
+    line.etag = item.etag();
+    line.fileId = item.fileId();
+    line.requestId = item.requestId();
+    line.modtime = item.modtime();
+    line.size = item.size();
+    line.previousSize = item.previousSize();
+    line.previousModtime = item.previousModtime();
+    line.instruction = item.instruction();
+    line.direction = item.direction();
+    line.status = item.status();
+    line.httpErrorCode = item.httpErrorCode();
+    return record;
+}
+
+void SyncRunLogFormat::writeRecord(QDataStream &stream, const Record &record)
+{
+    stream << static_cast<quint8>(record.type);
+    switch (record.type) {
+    case RecordType::Header:
+        stream << record.text;
+        break;
+    case RecordType::SyncStarted:
+        stream << record.timestamp;
+        break;
+    case RecordType::Lap:
+        stream << record.text << record.timestamp << record.lapMsec << record.totalMsec;
+        break;
+    case RecordType::SyncFinished:
+        stream << record.timestamp << record.lapMsec << record.totalMsec;
+        break;
+    case RecordType::Item: {
+        const auto &line = record.item;
+        stream << line.responseTimeStamp << line.file << line.renameTarget << line.errorString
+               << line.etag << line.fileId << line.requestId
+               << line.modtime << line.size << line.previousSize << line.previousModtime
+               << line.instruction << line.direction << line.status << line.httpErrorCode;
+        break;
+    }
+    case RecordType::Invalid:
+        break;
+    }
+}
+
+bool SyncRunLogFormat::readRecord(QDataStream &stream, Record &record)
+{
+    quint8 type = 0;
+    stream >> type;
+    record = Record();
+    record.type = static_cast<RecordType>(type);
+
+    switch (record.type) {
+    case RecordType::Header:
+        stream >> record.text;
+        break;
+    case RecordType::SyncStarted:
+        stream >> record.timestamp;
+        break;
+    case RecordType::Lap:
+        stream >> record.text >> record.timestamp >> record.lapMsec >> record.totalMsec;
+        break;
+    case RecordType::SyncFinished:
+        stream >> record.timestamp >> record.lapMsec >> record.totalMsec;
+        break;
+    case RecordType::Item: {
+        auto &line = record.item;
+        stream >> line.responseTimeStamp >> line.file >> line.renameTarget >> line.errorString
+            >> line.etag >> line.fileId >> line.requestId
+            >> line.modtime >> line.size >> line.previousSize >> line.previousModtime
+            >> line.instruction >> line.direction >> line.status >> line.httpErrorCode;
+        break;
+    }
+    case RecordType::Invalid:
+    default:
+        return false;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+QString SyncRunLogFormat::toText(const Record &record)
+{
+    switch (record.type) {
+    case RecordType::Header:
+        return record.text + QLatin1Char('\n')
+            + QStringLiteral("# timestamp | duration | file | instruction | dir | modtime | etag | "
+                             "size | fileId | status | errorString | http result code | "
+                             "other size | other modtime | X-Request-ID\n");
+    case RecordType::SyncStarted:
+        return QStringLiteral("#=#=#=# Syncrun started %1\n").arg(dateTimeStr(record.timestamp));
+    case RecordType::Lap:
+        return QStringLiteral("#=#=#=#=# %1 %2 (last step: %3 msec, total: %4 msec)\n")
+            .arg(record.text, dateTimeStr(record.timestamp), QString::number(record.lapMsec), QString::number(record.totalMsec));
+    case RecordType::SyncFinished:
+        return QStringLiteral("#=#=#=# Syncrun finished %1 (last step: %2 msec, total: %3 msec)\n")
+            .arg(dateTimeStr(record.timestamp), QString::number(record.lapMsec), QString::number(record.totalMsec));
+    case RecordType::Item:
+        break;
+    case RecordType::Invalid:
+        return {};
+    }
+
+    const auto &line = record.item;
+    const QChar L = QLatin1Char('|');
+    QString text;
+    text.reserve(128 + line.file.size() + line.renameTarget.size() + line.errorString.size());
+    text += responseTime(line.responseTimeStamp) + L;
+    text += L;
+    if (line.instruction != CSYNC_INSTRUCTION_RENAME) {
+        text += (line.renameTarget.isEmpty() ? line.file : line.renameTarget) + L;
+    } else {
+        text += line.file + QLatin1String(" -> ") + line.renameTarget + L;
+    }
+    text += QString::number(line.instruction) + L;
+    text += QString::number(line.direction) + L;
+    text += QString::number(line.modtime) + L;
+    text += QString::fromUtf8(line.etag) + L;
+    text += QString::number(line.size) + L;
+    text += QString::fromUtf8(line.fileId) + L;
+    text += QString::number(line.status) + L;
+    text += line.errorString + L;
+    text += QString::number(line.httpErrorCode) + L;
+    text += QString::number(line.previousSize) + L;
+    text += QString::number(line.previousModtime) + L;
+    text += QString::fromUtf8(line.requestId) + L;
+    text += QLatin1Char('\n');
+    return text;
+}
+
+bool SyncRunLogFormat::isBinaryLogSupported()
+{
+#ifdef ZLIB_FOUND
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SyncRunLogFormat::appendToBinaryLog(const QString &fileName, const QByteArray &data)
+{
+#ifdef ZLIB_FOUND
+    // "ab" starts a new gzip member at the end of the file, readers see the members as one stream
+    auto compressed = gzopen(QFile::encodeName(fileName).constData(), "ab");
+    if (!compressed) {
+        return false;
+    }
+    const auto written = gzwrite(compressed, data.constData(), static_cast<unsigned>(data.size()));
+    return gzclose(compressed) == Z_OK && written == data.size();
+#else
+    Q_UNUSED(fileName)
+    Q_UNUSED(data)
+    return false;
+#endif
+}
+
+QByteArray SyncRunLogFormat::readBinaryLog(const QString &fileName, qint64 maxSize)
+{
+#ifdef ZLIB_FOUND
+    auto compressed = gzopen(QFile::encodeName(fileName).constData(), "rb");
+    if (!compressed) {
+        return {};
+    }
+
+    QByteArray data;
+    constexpr int chunkSize = 64 * 1024;
+    while (maxSize < 0 || data.size() < maxSize) {
+        const auto offset = data.size();
+        const auto toRead = maxSize < 0 ? chunkSize : static_cast<int>(qMin<qint64>(chunkSize, maxSize - offset));
+        data.resize(offset + toRead);
+        const auto read = gzread(compressed, data.data() + offset, static_cast<unsigned>(toRead));
+        if (read <= 0) {
+            // the end, or a member that was cut off: keep what could be read
+            data.resize(offset);
+            break;
+        }
+        data.resize(offset + read);
+    }
+    gzclose(compressed);
+    return data;
+#else
+    Q_UNUSED(fileName)
+    Q_UNUSED(maxSize)
+    return {};
+#endif
+}
+
+QString SyncRunLogFormat::responseTime(const QByteArray &responseTimeStamp)
+{
+    // Equivalent to matching (\d\d:\d\d:\d\d) on the header value, without a regular expression per item
+    if (responseTimeStamp.size() > 6) {
+        const auto data = responseTimeStamp.constData();
+        for (int i = 0; i + 8 <= responseTimeStamp.size(); ++i) {
+            if (isDigit(data[i]) && isDigit(data[i + 1]) && data[i + 2] == ':'
+                && isDigit(data[i + 3]) && isDigit(data[i + 4]) && data[i + 5] == ':'
+                && isDigit(data[i + 6]) && isDigit(data[i + 7])) {
+                return QString::fromLatin1(data + i, 8);
+            }
+        }
+    }
+    return QString::fromLatin1(responseTimeStamp);
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QString>
+
+namespace OCC {
+
+class CompletedSyncItem;
+
+/**
+ * @brief Encoding of the per folder sync run log
+ *
+ * The sync run log can be written either as the historical pipe separated
+ * text format or as a compact binary stream of records. Both are produced from
+ * the same Record so that the binary log can be rendered back into exactly the
+ * text the client would have written (see the nextcloudsyncrunlog tool).
+ *
+ * A binary log is gzip compressed. Uncompressed, it starts with binaryMagic
+ * and is followed by QDataStream encoded records. Each batch of records is
+ * appended as a gzip member of its own, so a log that was cut off by a crash
+ * only loses the last batch. Without zlib only the text format is available.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT SyncRunLogFormat
+{
+public:
+    static constexpr char binaryMagic[] = "NCSYNCLOG1";
+    static constexpr int binaryMagicSize = sizeof(binaryMagic) - 1;
+    static constexpr QDataStream::Version streamVersion = QDataStream::Qt_5_15;
+
+    enum class RecordType : quint8 {
+        Invalid = 0,
+        Header, ///< folder path, written once when a log file is created
+        SyncStarted,
+        Item,
+        Lap,
+        SyncFinished,
+    };
+
+    struct ItemLine
+    {
+        QByteArray responseTimeStamp;
+        QString file;
+        QString renameTarget;
+        QString errorString;
+        QByteArray etag;
+        QByteArray fileId;
+        QByteArray requestId;
+        qint64 modtime = 0;
+        qint64 size = 0;
+        qint64 previousSize = 0;
+        qint64 previousModtime = 0;
+        qint32 instruction = 0;
+        qint32 direction = 0;
+        qint32 status = 0;
+        quint16 httpErrorCode = 0;
+    };
+
+    struct Record
+    {
+        RecordType type = RecordType::Invalid;
+        QString text; ///< folder path for Header, step name for Lap
+        QDateTime timestamp;
+        qint64 lapMsec = 0;
+        qint64 totalMsec = 0;
+        ItemLine item;
+    };
+
+    /// Returns false for items that are not part of the log (directories that were not touched, ignored files)
+    static bool shouldLog(const CompletedSyncItem &item);
+    static Record itemRecord(const CompletedSyncItem &item);
+
+    static void writeRecord(QDataStream &stream, const Record &record);
+    static bool readRecord(QDataStream &stream, Record &record);
+
+    /// Formats the record the way the text log shows it, including the trailing newline
+    static QString toText(const Record &record);
+
+    /// Whether the binary log can be written and read, it needs zlib
+    static bool isBinaryLogSupported();
+
+    /// Compresses data and appends it to the binary log fileName
+    static bool appendToBinaryLog(const QString &fileName, const QByteArray &data);
+    /// The uncompressed content of the binary log fileName, at most maxSize bytes of it if maxSize >= 0
+    static QByteArray readBinaryLog(const QString &fileName, qint64 maxSize = -1);
+
+    /// Extracts the hh:mm:ss part of an HTTP date header, falling back to the raw value
+    static QString responseTime(const QByteArray &responseTimeStamp);
+};
+
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "config.h"
+#include "transfercompression.h"
+
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QSet>
+
+#ifdef ZLIB_FOUND
+#include <zlib.h>
+#endif
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcTransferCompression, "nextcloud.sync.transfercompression", QtInfoMsg)
+
+namespace {
+
+// zlib window bits selecting the gzip header instead of the zlib one
+constexpr int gzipWindowBits = 15 + 16;
+
+// Formats that are compressed already or are rarely text
+const QSet<QString> &incompressibleSuffixes()
+{
+    static const QSet<QString> suffixes = {
+        QStringLiteral("7z"), QStringLiteral("aac"), QStringLiteral("avi"), QStringLiteral("bz2"),
+        QStringLiteral("docx"), QStringLiteral("flac"), QStringLiteral("gif"), QStringLiteral("gz"),
+        QStringLiteral("heic"), QStringLiteral("jar"), QStringLiteral("jpeg"), QStringLiteral("jpg"),
+        QStringLiteral("m4a"), QStringLiteral("mkv"), QStringLiteral("mov"), QStringLiteral("mp3"),
+        QStringLiteral("mp4"), QStringLiteral("odp"), QStringLiteral("ods"), QStringLiteral("odt"),
+        QStringLiteral("ogg"), QStringLiteral("opus"), QStringLiteral("pdf"), QStringLiteral("png"),
+        QStringLiteral("pptx"), QStringLiteral("rar"), QStringLiteral("tgz"), QStringLiteral("webm"),
+        QStringLiteral("webp"), QStringLiteral("xlsx"), QStringLiteral("xz"), QStringLiteral("zip"),
+        QStringLiteral("zst"),
+    };
+    return suffixes;
+}
+
+}
+
+bool TransferCompression::isEnabled()
+{
+#ifdef ZLIB_FOUND
+    static const bool enabled = !qEnvironmentVariableIsSet("OWNCLOUD_TRANSFER_COMPRESSION")
+        || qEnvironmentVariableIntValue("OWNCLOUD_TRANSFER_COMPRESSION") != 0;
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+bool TransferCompression::mayCompress(const QString &fileName, qint64 size)
+{
+    if (!isEnabled() || size < minSize) {
+        return false;
+    }
+    return !incompressibleSuffixes().contains(QFileInfo(fileName).suffix().toLower());
+}
+
+bool TransferCompression::isCompressible(const QByteArray &data)
+{
+#ifdef ZLIB_FOUND
+    const auto probe = QByteArray::fromRawData(data.constData(), static_cast<int>(qMin<qint64>(data.size(), probeSize)));
+    if (probe.size() < minSize) {
+        return false;
+    }
+
+    auto bound = compressBound(static_cast<uLong>(probe.size()));
+    QByteArray compressed(static_cast<int>(bound), Qt::Uninitialized);
+    if (compress2(reinterpret_cast<Bytef *>(compressed.data()), &bound,
+            reinterpret_cast<const Bytef *>(probe.constData()), static_cast<uLong>(probe.size()), Z_BEST_SPEED)
+        != Z_OK) {
+        return false;
+    }
+    // Only worth it if at least a fifth of the bytes are saved
+    return bound * 5 < static_cast<uLong>(probe.size()) * 4;
+#else
+    Q_UNUSED(data)
+    return false;
+#endif
+}
+
+QByteArray TransferCompression::gzipCompress(const QByteArray &data)
+{
+#ifdef ZLIB_FOUND
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+
+    QByteArray output(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))), Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    const auto result = deflate(&stream, Z_FINISH);
+    output.resize(static_cast<int>(stream.total_out));
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        qCWarning(lcTransferCompression) << "Could not compress data" << result;
+        return {};
+    }
+    return output;
+#else
+    Q_UNUSED(data)
+    return {};
+#endif
+}
+
+QByteArray TransferCompression::gzipDecompress(const QByteArray &data)
+{
+#ifdef ZLIB_FOUND
+    z_stream stream = {};
+    if (inflateInit2(&stream, gzipWindowBits) != Z_OK) {
+        return {};
+    }
+
+    constexpr int outputChunkSize = 64 * 1024;
+    QByteArray output;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int result = Z_OK;
+    while (result == Z_OK) {
+        const auto offset = output.size();
+        output.resize(offset + outputChunkSize);
+        stream.next_out = reinterpret_cast<Bytef *>(output.data() + offset);
+        stream.avail_out = outputChunkSize;
+        result = inflate(&stream, Z_NO_FLUSH);
+        output.resize(offset + outputChunkSize - static_cast<int>(stream.avail_out));
+    }
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END || stream.avail_in != 0) {
+        qCWarning(lcTransferCompression) << "Invalid gzip data" << result;
+        return {};
+    }
+    return output;
+#else
+    Q_UNUSED(data)
+    return {};
+#endif
+}
+
+}
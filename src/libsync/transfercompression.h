@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QByteArray>
+#include <QString>
+
+namespace OCC {
+
+/**
+ * @brief gzip Content-Encoding of file transfers
+ *
+ * Text-like content (source trees, CSV exports, logs) shrinks a lot when
+ * compressed. Uploads of such files are sent with "Content-Encoding: gzip" if
+ * SyncOptions::_compressUploads is set. Downloads are decoded transparently by
+ * Qt; only files that are not worth it ask for the identity encoding, which
+ * also keeps the byte ranges of resumed downloads meaningful.
+ *
+ * Whether a file is worth compressing is decided from its name and size
+ * (mayCompress) and, for uploads, from a quick probe of its first bytes
+ * (isCompressible). Checksums are always computed over the uncompressed
+ * content.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT TransferCompression
+{
+public:
+    static constexpr auto gzipEncoding = "gzip";
+
+    /// Files smaller than this are not worth the compression overhead
+    static constexpr qint64 minSize = 4 * 1024;
+    /// Uploads are compressed in memory on a worker thread, larger files are always sent as they are
+    static constexpr qint64 maxUploadSize = 16 * 1000 * 1000;
+    /// Amount of data the compressibility probe looks at
+    static constexpr qint64 probeSize = 64 * 1024;
+
+    /// Whether gzip support was compiled in and is not disabled with OWNCLOUD_TRANSFER_COMPRESSION=0
+    [[nodiscard]] static bool isEnabled();
+
+    /// Whether a file of that name and size is a candidate for compression at all
+    [[nodiscard]] static bool mayCompress(const QString &fileName, qint64 size);
+
+    /// Compresses the first probeSize bytes of data quickly and checks the compression ratio
+    [[nodiscard]] static bool isCompressible(const QByteArray &data);
+
+    /// Returns an empty array on error
+    [[nodiscard]] static QByteArray gzipCompress(const QByteArray &data);
+    [[nodiscard]] static QByteArray gzipDecompress(const QByteArray &data);
+};
+
+}
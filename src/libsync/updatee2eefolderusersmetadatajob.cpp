@@ -19,6 +19,13 @@
 #include "common/syncjournaldb.h"
 
 #include <QSslCertificate>
+#include <QTimer>
+
+namespace {
+// Every sub job fetches and uploads the metadata of one nested folder, keep a
+// few of them in flight without flooding the server
+constexpr auto maxRunningSubJobs = 4;
+}
 
 namespace OCC
 {
@@ -175,14 +182,15 @@ void UpdateE2eeFolderUsersMetadataJob::slotUpdateMetadataFinished(int code, cons
     if (_operation == Operation::Add || _operation == Operation::Remove) {
         qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "Trying to schedule more jobs.";
         scheduleSubJobs();
-        if (_subJobs.isEmpty()) {
+        if (_pendingSubJobs.isEmpty()) {
             if (_keepLock) {
                 emit finished(200);
             } else {
                 unlockFolder(EncryptedFolderMetadataHandler::UnlockFolderWithResult::Success);
             }
         } else {
-            _subJobs.values().last()->start();
+            qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "Updating the metadata of" << _pendingSubJobs.size() << "nested folders";
+            startSubJobs();
         }
     } else {
         emit finished(200);
@@ -213,12 +221,28 @@ void UpdateE2eeFolderUsersMetadataJob::scheduleSubJobs()
             subJob->setKeyChecksums(folderMetadata->keyChecksums());
             subJob->setParent(this);
             subJob->setFolderToken(_encryptedFolderMetadataHandler->folderToken());
-            _subJobs.insert(subJob);
+            _pendingSubJobs.append(subJob);
             connect(subJob, &UpdateE2eeFolderUsersMetadataJob::finished, this, &UpdateE2eeFolderUsersMetadataJob::slotSubJobFinished);
         }
     });
 }
 
+void UpdateE2eeFolderUsersMetadataJob::startSubJobs()
+{
+    while (!_subJobFailed && !_pendingSubJobs.isEmpty() && _runningSubJobs.size() < maxRunningSubJobs) {
+        const auto subJob = _pendingSubJobs.takeFirst();
+        _runningSubJobs.insert(subJob);
+        // a sub job may finish right away, don't get into slotSubJobFinished() from here
+        QTimer::singleShot(0, subJob, [subJob] {
+            subJob->start();
+        });
+    }
+
+    if (_runningSubJobs.isEmpty()) {
+        subJobsFinished(!_subJobFailed);
+    }
+}
+
 void UpdateE2eeFolderUsersMetadataJob::unlockFolder(const EncryptedFolderMetadataHandler::UnlockFolderWithResult result)
 {
     qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "Calling Unlock";
@@ -235,6 +259,11 @@ void UpdateE2eeFolderUsersMetadataJob::slotFolderUnlocked(const QByteArray &fold
     if (httpStatus != 200) {
         qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "Failed to unlock a folder" << folderId << httpStatus;
     }
+    if (_subJobFailed) {
+        // unlocked after a nested folder could not be updated, report why
+        emit finished(_subJobErrorCode, _subJobErrorMessage);
+        return;
+    }
     const auto message = httpStatus != 200 ? tr("Failed to unlock a folder.") : QString{};
     emit finished(httpStatus, message);
 }
@@ -248,21 +277,25 @@ void UpdateE2eeFolderUsersMetadataJob::subJobsFinished(bool success)
 
 void UpdateE2eeFolderUsersMetadataJob::slotSubJobFinished(int code, const QString &message)
 {
-    if (code != 200) {
-        qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "sub job finished with error" << message;
-        subJobsFinished(false);
-        return;
-    }
     const auto job = qobject_cast<UpdateE2eeFolderUsersMetadataJob *>(sender());
     Q_ASSERT(job);
     if (!job) {
         qCWarning(lcUpdateE2eeFolderUsersMetadataJob) << "slotSubJobFinished must be invoked by signal";
-        emit finished(-1, tr("Error updating metadata for a folder %1").arg(_path) + QStringLiteral(":%1").arg(message));
-        subJobsFinished(false);
         return;
     }
 
-    {
+    _runningSubJobs.remove(job);
+    job->deleteLater();
+
+    if (code != 200) {
+        // don't start any more sub jobs, unlock once the running ones are done with our lock
+        qCDebug(lcUpdateE2eeFolderUsersMetadataJob) << "sub job finished with error" << message;
+        if (!_subJobFailed) {
+            _subJobFailed = true;
+            _subJobErrorCode = code;
+            _subJobErrorMessage = message;
+        }
+    } else {
         QMutexLocker locker(&_subJobSyncItemsMutex);
         const auto foundInHash = _subJobSyncItems.constFind(job->path());
         if (foundInHash != _subJobSyncItems.constEnd() && foundInHash.value()) {
@@ -273,14 +306,7 @@ void UpdateE2eeFolderUsersMetadataJob::slotSubJobFinished(int code, const QStrin
         }
     }
 
-    _subJobs.remove(job);
-    job->deleteLater();
-
-    if (_subJobs.isEmpty()) {
-        subJobsFinished(true);
-    } else {
-        _subJobs.values().last()->start();
-    }
+    startSubJobs();
 }
 
 void UpdateE2eeFolderUsersMetadataJob::slotCertificateFetchedFromKeychain(const QSslCertificate &certificate)
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QScopedPointer>
 #include <QString>
+#include <QVector>
 
 class QSslCertificate;
 namespace OCC
@@ -66,6 +67,7 @@ public slots:
 
 private:
     void scheduleSubJobs();
+    void startSubJobs();
     void startUpdate();
     void subJobsFinished(bool success);
 
@@ -100,7 +102,13 @@ private:
     QByteArray _metadataKeyForDecryption;
     QSet<QByteArray> _keyChecksums;
     //-------------------------------------------------------------------------------------------------
-    QSet<UpdateE2eeFolderUsersMetadataJob *> _subJobs;
+    // nested folders are independent of each other, so their metadata is re-encrypted by several sub jobs at a time, sharing our lock
+    QVector<UpdateE2eeFolderUsersMetadataJob *> _pendingSubJobs;
+    QSet<UpdateE2eeFolderUsersMetadataJob *> _runningSubJobs;
+    bool _subJobFailed = false;
+    // the error of the first sub job that failed, reported once the folder is unlocked
+    int _subJobErrorCode = 0;
+    QString _subJobErrorMessage;
     UserData _userData; // share info, etc.
     QHash<QString, SyncFileItemPtr> _subJobSyncItems; //used when migrating to update corresponding SyncFileItem(s) for nested folders, such that records in db will get updated when propagate item job is finalized
     QMutex _subJobSyncItemsMutex;
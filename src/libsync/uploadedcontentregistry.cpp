@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "uploadedcontentregistry.h"
+
+#include <QLoggingCategory>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcUploadedContentRegistry, "nextcloud.sync.uploadedcontentregistry", QtInfoMsg)
+
+UploadedContentRegistry::UploadedContentRegistry(QObject *parent)
+    : QObject(parent)
+    , _sources(maxSources)
+{
+}
+
+QByteArray UploadedContentRegistry::contentKey(const QByteArray &checksumHeader, qint64 size)
+{
+    if (checksumHeader.isEmpty() || size <= 0) {
+        return {};
+    }
+    return checksumHeader + '/' + QByteArray::number(size);
+}
+
+UploadedContentRegistry::Source UploadedContentRegistry::find(const QByteArray &key) const
+{
+    if (const auto source = _sources.object(key)) {
+        return *source;
+    }
+    return {};
+}
+
+bool UploadedContentRegistry::isUploading(const QByteArray &key) const
+{
+    return _runningUploads.contains(key);
+}
+
+void UploadedContentRegistry::uploadStarted(const QByteArray &key, QObject *uploader)
+{
+    Q_ASSERT(!key.isEmpty());
+    _runningUploads.insert(key, uploader);
+    connect(uploader, &QObject::destroyed, this, [this, key, uploader] {
+        if (_runningUploads.value(key) == uploader) {
+            uploadFinished(key, {});
+        }
+    });
+}
+
+void UploadedContentRegistry::uploadFinished(const QByteArray &key, const Source &source)
+{
+    if (const auto uploader = _runningUploads.take(key)) {
+        disconnect(uploader, &QObject::destroyed, this, nullptr);
+    }
+    if (source.isValid()) {
+        qCDebug(lcUploadedContentRegistry) << "Content" << key << "is available at" << source.remotePath;
+        _sources.insert(key, new Source(source));
+    }
+    emit uploadDone(key);
+}
+
+void UploadedContentRegistry::forget(const QByteArray &key)
+{
+    _sources.remove(key);
+}
+
+}
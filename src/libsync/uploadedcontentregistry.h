@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+namespace OCC {
+
+/**
+ * @brief Remembers which content was recently uploaded to an account
+ *
+ * Uploads of files whose content (checksum and size) is already on the server
+ * can be replaced by a server side COPY of the existing file. The registry is
+ * shared by all sync folders of an account, so duplicates across folders are
+ * found too.
+ *
+ * Uploads register themselves while they are running so that other uploads of
+ * the same content can wait for them instead of sending the same bytes in
+ * parallel.
+ *
+ * The recorded etag must be sent along with the COPY (If-Match) since the
+ * source may have been changed on the server since it was uploaded.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT UploadedContentRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    struct Source
+    {
+        QString remotePath; ///< relative to the account's dav url, like OwncloudPropagator::fullRemotePath()
+        QByteArray etag;
+
+        [[nodiscard]] bool isValid() const { return !remotePath.isEmpty() && !etag.isEmpty(); }
+    };
+
+    explicit UploadedContentRegistry(QObject *parent = nullptr);
+
+    /// Key identifying a content; empty if the content can't be identified
+    [[nodiscard]] static QByteArray contentKey(const QByteArray &checksumHeader, qint64 size);
+
+    [[nodiscard]] Source find(const QByteArray &key) const;
+    [[nodiscard]] bool isUploading(const QByteArray &key) const;
+
+    /** Marks the content as being uploaded by uploader
+     *
+     * The upload is considered failed if the uploader is destroyed before
+     * uploadFinished() was called.
+     */
+    void uploadStarted(const QByteArray &key, QObject *uploader);
+
+    /// Pass an invalid source if the upload failed
+    void uploadFinished(const QByteArray &key, const Source &source);
+
+    /// Drops a source that turned out to be outdated
+    void forget(const QByteArray &key);
+
+signals:
+    /// The running upload of key finished, successfully or not
+    void uploadDone(const QByteArray &key);
+
+private:
+    static constexpr int maxSources = 10000;
+
+    QCache<QByteArray, Source> _sources;
+    QHash<QByteArray, QObject *> _runningUploads;
+};
+
+}
@@ -52,6 +52,8 @@ public:
     Optional<PinState> pinState(const QString &folderPath) override
     { return pinStateInDb(folderPath); }
     AvailabilityResult availability(const QString &folderPath) override;
+    Optional<VfsItemAvailability> combinedAvailability(const QStringList &folderPaths) override
+    { return combinedAvailabilityInDb(folderPaths); }
 
 public slots:
     void fileStatusChanged(const QString &, OCC::SyncFileStatus) override {}
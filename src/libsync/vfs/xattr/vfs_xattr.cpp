@@ -193,6 +193,11 @@ Vfs::AvailabilityResult VfsXAttr::availability(const QString &folderPath)
     return availabilityInDb(folderPath);
 }
 
+Optional<VfsItemAvailability> VfsXAttr::combinedAvailability(const QStringList &folderPaths)
+{
+    return combinedAvailabilityInDb(folderPaths);
+}
+
 void VfsXAttr::fileStatusChanged(const QString &, SyncFileStatus)
 {
 }
@@ -54,6 +54,7 @@ public:
     bool setPinState(const QString &folderPath, PinState state) override;
     Optional<PinState> pinState(const QString &folderPath) override;
     AvailabilityResult availability(const QString &folderPath) override;
+    Optional<VfsItemAvailability> combinedAvailability(const QStringList &folderPaths) override;
 
 public slots:
     void fileStatusChanged(const QString &systemFileName, OCC::SyncFileStatus fileStatus) override;
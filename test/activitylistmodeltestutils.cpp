@@ -32,6 +32,8 @@ static QByteArray fake400Response = R"(
 static QByteArray fake500Response = R"(
 {"ocs":{"meta":{"status":"failure","statuscode":500,"message":"Internal Server Error.\n"},"data":[]}}
 )";
+
+static const QByteArray newestActivitiesEtag = QByteArrayLiteral("\"newest-activities\"");
 }
 
 namespace ActivityListModelTestUtils
@@ -62,7 +64,22 @@ QNetworkReply *almTestQnamOverride(FakeQNAM * const fakeQnam,
     }
 
     if (path.startsWith(QStringLiteral("/ocs/v2.php/apps/activity/api/v2/activity"))) {
-        reply = new FakePayloadReply(op, req, FakeRemoteActivityStorage::instance()->activityJsonData(since, limit), searchResultsReplyDelay, fakeQnam);
+        // since=0 asks for the newest activities, which don't change during a test
+        const auto storage = FakeRemoteActivityStorage::instance();
+        const auto newestActivities = since == 0;
+        const auto data = storage->activityJsonData(newestActivities ? storage->startingIdLast() : since, limit);
+        const auto isEmptyPage = QJsonDocument::fromJson(data).object().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toArray().isEmpty();
+
+        // like the server, answer 304 for an unchanged newest page and for an empty one
+        if ((newestActivities && req.rawHeader("If-None-Match") == newestActivitiesEtag) || isEmptyPage) {
+            reply = new FakeErrorReply(op, req, parent, 304);
+        } else {
+            const auto payloadReply = new FakePayloadReply(op, req, data, searchResultsReplyDelay, fakeQnam);
+            if (newestActivities) {
+                payloadReply->_additionalRawHeaders.insert("ETag", newestActivitiesEtag);
+            }
+            reply = payloadReply;
+        }
     }
 
     if (!reply) {
@@ -506,15 +523,8 @@ int FakeRemoteActivityStorage::totalNumActivites() const {
 
 void TestingALM::startFetchJobWithNumActivities(const int numActivities)
 {
-    auto *job = new OCC::JsonApiJob(
-        accountState()->account(), QLatin1String("ocs/v2.php/apps/activity/api/v2/activity"), this);
+    const auto job = createFetchJob(numActivities);
     QObject::connect(this, &TestingALM::activityJobStatusCode, this, &TestingALM::slotProcessReceivedActivities);
-    QObject::connect(job, &OCC::JsonApiJob::jsonReceived, this, &TestingALM::activitiesReceived);
-
-    QUrlQuery params;
-    params.addQueryItem(QLatin1String("since"), QString::number(currentItem()));
-    params.addQueryItem(QLatin1String("limit"), QString::number(numActivities));
-    job->addQueryParams(params);
 
     setAndRefreshCurrentlyFetching(true);
     job->start();
@@ -87,6 +87,9 @@ public:
         return maxActivities() + 1;
     }
 
+    using OCC::ActivityListModel::doneFetching;
+    using OCC::ActivityListModel::startRefreshJob;
+
 public slots:
     void startFetchJob() override;
     void startMaxActivitiesFetchJob();
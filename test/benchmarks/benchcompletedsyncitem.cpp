@@ -0,0 +1,78 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "completedsyncitem.h"
+#include "progressdispatcher.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+
+using namespace OCC;
+
+constexpr int numItems = 200000;
+constexpr int numObservers = 4;
+
+// What a typical observer reads from a finished item
+template<typename Getter>
+qint64 observe(const Getter &getter)
+{
+    qint64 checksum = 0;
+    for (int observer = 0; observer < numObservers; ++observer) {
+        checksum += getter();
+    }
+    return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    SyncFileItemVector items;
+    items.reserve(numItems);
+    for (int i = 0; i < numItems; ++i) {
+        auto item = SyncFileItemPtr::create();
+        item->_file = QStringLiteral("dir%1/subdir/file%2.txt").arg(i / 100).arg(i);
+        item->_originalFile = item->_file;
+        item->_instruction = CSYNC_INSTRUCTION_NEW;
+        item->_direction = SyncFileItem::Up;
+        item->_status = SyncFileItem::Success;
+        item->_etag = "etag" + QByteArray::number(i);
+        item->_fileId = "fileid" + QByteArray::number(i);
+        item->_size = i;
+        items.append(item);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 copiedChecksum = 0;
+    for (const auto &item : items) {
+        // every observer takes its own copy of the item
+        copiedChecksum += observe([&item] {
+            const SyncFileItem copy = *item;
+            return copy._size + copy._file.size();
+        });
+    }
+    const auto copiedElapsed = timer.nsecsElapsed();
+
+    timer.restart();
+    qint64 sharedChecksum = 0;
+    for (const auto &item : items) {
+        // one record is built and the same pointer is handed to all observers
+        const auto completed = CompletedSyncItem::create(*item, ErrorCategory::NoError);
+        sharedChecksum += observe([&completed] {
+            const auto shared = completed;
+            return shared->size() + shared->file().size();
+        });
+    }
+    const auto sharedElapsed = timer.nsecsElapsed();
+
+    qDebug() << "ITEMS" << numItems << "OBSERVERS" << numObservers;
+    qDebug() << "COPIED ITEM PER OBSERVER:" << copiedElapsed / numItems << "ns/item";
+    qDebug() << "SHARED COMPLETED RECORD:" << sharedElapsed / numItems << "ns/item";
+    return copiedChecksum == sharedChecksum ? 0 : -1;
+}
@@ -0,0 +1,82 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "common/remotepermissions.h"
+#include "common/syncjournaldb.h"
+#include "common/syncjournalfilerecord.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+using namespace OCC;
+
+constexpr int numParses = 5000000;
+constexpr int numRecords = 100000;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // What servers typically report for files and folders, shared or not
+    const QStringList serverStrings = {
+        QStringLiteral("RGDNVW"),
+        QStringLiteral("RGDNVCK"),
+        QStringLiteral("SRGDNVW"),
+        QStringLiteral("SRGDNVCK"),
+        QStringLiteral("RMGDNVW"),
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    int checksum = 0;
+    for (int i = 0; i < numParses; ++i) {
+        checksum += RemotePermissions::fromServerString(serverStrings.at(i % serverStrings.size())).toDbIntValue();
+    }
+    const auto parseElapsed = timer.elapsed();
+
+    QTemporaryDir dir;
+    SyncJournalDb db(dir.filePath(QStringLiteral("bench.db")));
+    timer.restart();
+    for (int i = 0; i < numRecords; ++i) {
+        SyncJournalFileRecord record;
+        record._path = QByteArray("dir") + QByteArray::number(i / 100) + "/file" + QByteArray::number(i);
+        record._type = ItemTypeFile;
+        record._etag = "etag";
+        record._fileId = QByteArray::number(i);
+        record._remotePerm = RemotePermissions::fromServerString(serverStrings.at(i % serverStrings.size()));
+        if (!db.setFileRecord(record)) {
+            return -1;
+        }
+    }
+    db.commit(QStringLiteral("bench"));
+    const auto writeElapsed = timer.elapsed();
+
+    timer.restart();
+    int readChecksum = 0;
+    for (int i = 0; i < numRecords; ++i) {
+        SyncJournalFileRecord record;
+        if (!db.getFileRecord(QByteArray("dir") + QByteArray::number(i / 100) + "/file" + QByteArray::number(i), &record) || !record.isValid()) {
+            return -1;
+        }
+        readChecksum += record._remotePerm.toDbIntValue();
+    }
+    const auto readElapsed = timer.elapsed();
+    db.close();
+
+    qDebug() << "PARSES" << numParses << "RECORDS" << numRecords;
+    qDebug() << "PARSE SERVER STRINGS:" << parseElapsed << "ms";
+    qDebug() << "WRITE RECORDS:" << writeElapsed << "ms";
+    qDebug() << "READ RECORDS:" << readElapsed << "ms";
+
+    int expectedChecksum = 0;
+    for (int i = 0; i < numRecords; ++i) {
+        expectedChecksum += RemotePermissions::fromServerString(serverStrings.at(i % serverStrings.size())).toDbIntValue();
+    }
+    return checksum != 0 && readChecksum == expectedChecksum ? 0 : -1;
+}
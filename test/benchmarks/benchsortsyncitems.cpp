@@ -0,0 +1,50 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncfileitem.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <random>
+
+using namespace OCC;
+
+constexpr int numItems = 1000000;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Deep trees with shared prefixes, in discovery order
+    SyncFileItemVector discovered;
+    discovered.reserve(numItems);
+    for (int i = 0; i < numItems; ++i) {
+        auto item = SyncFileItemPtr::create();
+        item->_file = QStringLiteral("Documents/project-%1/src/module %2/file-%3.txt").arg(i / 10000).arg(i / 100).arg(i);
+        discovered.append(item);
+    }
+    std::shuffle(discovered.begin(), discovered.end(), std::mt19937(42));
+
+    auto items = discovered;
+    QElapsedTimer timer;
+    timer.start();
+    std::sort(items.begin(), items.end());
+    const auto comparatorElapsed = timer.elapsed();
+
+    auto keyedItems = discovered;
+    timer.restart();
+    sortSyncFileItems(keyedItems);
+    const auto keyedElapsed = timer.elapsed();
+
+    qDebug() << "ITEMS" << numItems;
+    qDebug() << "STD::SORT WITH OPERATOR<:" << comparatorElapsed << "ms";
+    qDebug() << "SORT KEYS:" << keyedElapsed << "ms";
+    return std::equal(items.cbegin(), items.cend(), keyedItems.cbegin()) ? 0 : -1;
+}
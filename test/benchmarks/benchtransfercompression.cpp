@@ -0,0 +1,151 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncenginetestutils.h"
+#include "transfercompression.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+using namespace OCC;
+
+namespace {
+
+struct Sample
+{
+    const char *name;
+    QByteArray data;
+};
+
+QByteArray sourceCode(int size)
+{
+    QByteArray data;
+    int line = 0;
+    while (data.size() < size) {
+        data += "    if (item->_size > " + QByteArray::number(line) + ") {\n        qCDebug(lcBench) << \"line\" << " + QByteArray::number(line % 97) + ";\n    }\n";
+        ++line;
+    }
+    data.truncate(size);
+    return data;
+}
+
+QByteArray csvExport(int size)
+{
+    QByteArray data = "date;account;amount;currency;comment\n";
+    QRandomGenerator generator(1);
+    while (data.size() < size) {
+        data += "2026-" + QByteArray::number(1 + generator.bounded(12)) + "-" + QByteArray::number(1 + generator.bounded(28))
+            + ";" + QByteArray::number(generator.bounded(1000)) + ";" + QByteArray::number(generator.bounded(100000) / 100.0)
+            + ";EUR;monthly transfer\n";
+    }
+    data.truncate(size);
+    return data;
+}
+
+QByteArray randomData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    QRandomGenerator generator(2);
+    for (auto &byte : data) {
+        byte = static_cast<char>(generator.bounded(256));
+    }
+    return data;
+}
+
+// Upload bytes as seen by the server for a sync of files with the given content
+qint64 bytesOnTheWire(bool compressUploads, int fileCount, qint64 *syncMsec)
+{
+    FakeFolder fakeFolder{FileInfo{}};
+    if (compressUploads) {
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._compressUploads = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+    }
+
+    qint64 sent = 0;
+    QObject parent;
+    fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *outgoingData) -> QNetworkReply * {
+        if (op != QNetworkAccessManager::PutOperation) {
+            return nullptr;
+        }
+        auto payload = outgoingData->readAll();
+        sent += payload.size();
+        if (request.rawHeader("Content-Encoding") == TransferCompression::gzipEncoding) {
+            payload = TransferCompression::gzipDecompress(payload);
+        }
+        return new FakePutReply(fakeFolder.remoteModifier(), op, request, payload, &parent);
+    });
+
+    fakeFolder.localModifier().mkdir("src");
+    fakeFolder.localModifier().mkdir("media");
+    for (int i = 0; i < fileCount; ++i) {
+        fakeFolder.localModifier().insert(QStringLiteral("src/file%1.cpp").arg(i), 200 * 1000, 'S');
+        fakeFolder.localModifier().insert(QStringLiteral("media/file%1.jpg").arg(i), 200 * 1000, 'J');
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!fakeFolder.syncOnce()) {
+        return -1;
+    }
+    *syncMsec = timer.elapsed();
+    return sent;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (!TransferCompression::isEnabled()) {
+        qDebug() << "Transfer compression is not available";
+        return 0;
+    }
+
+    constexpr int sampleSize = 4 * 1000 * 1000;
+    const Sample samples[] = {
+        {"source code", sourceCode(sampleSize)},
+        {"csv export", csvExport(sampleSize)},
+        {"random", randomData(sampleSize)},
+    };
+
+    QElapsedTimer timer;
+    for (const auto &sample : samples) {
+        timer.start();
+        const auto compressible = TransferCompression::isCompressible(sample.data);
+        const auto probeNsec = timer.nsecsElapsed();
+
+        timer.restart();
+        const auto compressed = TransferCompression::gzipCompress(sample.data);
+        const auto compressMsec = timer.elapsed();
+
+        timer.restart();
+        const auto decompressed = TransferCompression::gzipDecompress(compressed);
+        const auto decompressMsec = timer.elapsed();
+        if (decompressed != sample.data) {
+            qDebug() << "ROUND TRIP FAILED" << sample.name;
+            return -1;
+        }
+
+        qDebug() << sample.name << "SIZE" << sample.data.size() << "COMPRESSED" << compressed.size()
+                 << "RATIO" << double(compressed.size()) / sample.data.size()
+                 << "COMPRESSIBLE" << compressible << "PROBE NSEC" << probeNsec
+                 << "COMPRESS MSEC" << compressMsec << "DECOMPRESS MSEC" << decompressMsec;
+    }
+
+    qint64 plainMsec = 0;
+    qint64 gzipMsec = 0;
+    const auto plainBytes = bytesOnTheWire(false, 50, &plainMsec);
+    const auto gzipBytes = bytesOnTheWire(true, 50, &gzipMsec);
+    qDebug() << "UPLOADED PLAIN" << plainBytes << "bytes in" << plainMsec << "msec";
+    qDebug() << "UPLOADED WITH COMPRESSION" << gzipBytes << "bytes in" << gzipMsec << "msec";
+
+    return (plainBytes > 0 && gzipBytes > 0 && gzipBytes < plainBytes) ? 0 : -1;
+}
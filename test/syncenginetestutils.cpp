@@ -663,6 +663,51 @@ void FakeMoveReply::respond()
     emit finished();
 }
 
+FakeCopyReply::FakeCopyReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+    : FakeReply { parent }
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(op);
+    open(QIODevice::ReadOnly);
+
+    QString fileName = getFilePathFromUrl(request.url());
+    Q_ASSERT(!fileName.isEmpty());
+    QString dest = getFilePathFromUrl(QUrl::fromEncoded(request.rawHeader("Destination")));
+    Q_ASSERT(!dest.isEmpty());
+
+    const auto source = remoteRootFileInfo.find(fileName);
+    if (!source) {
+        _httpStatus = 404;
+    } else if (request.hasRawHeader("If-Match") && request.rawHeader("If-Match") != '"' + source->etag + '"') {
+        _httpStatus = 412;
+    } else if (request.rawHeader("Overwrite") == "F" && remoteRootFileInfo.find(dest)) {
+        _httpStatus = 412;
+    } else {
+        Q_ASSERT(!source->isDir);
+        const auto size = source->size;
+        const auto contentChar = source->contentChar;
+        const auto checksums = source->checksums;
+        auto fileInfo = remoteRootFileInfo.create(dest, size, contentChar);
+        fileInfo->checksums = checksums;
+        if (request.hasRawHeader("X-OC-Mtime")) {
+            fileInfo->lastModified = OCC::Utility::qDateTimeFromTime_t(request.rawHeader("X-OC-Mtime").toLongLong());
+        }
+        remoteRootFileInfo.find(dest, /*invalidateEtags=*/true);
+    }
+    QMetaObject::invokeMethod(this, "respond", Qt::QueuedConnection);
+}
+
+void FakeCopyReply::respond()
+{
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, _httpStatus);
+    if (_httpStatus != 201) {
+        setError(_httpStatus == 404 ? ContentNotFoundError : InternalServerError, QStringLiteral("Copy failed"));
+    }
+    emit metaDataChanged();
+    emit finished();
+}
+
 FakeGetReply::FakeGetReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
     : FakeReply { parent }
 {
@@ -916,6 +961,9 @@ void FakePayloadReply::respond()
     for (auto it = _additionalHeaders.constKeyValueBegin(); it != _additionalHeaders.constKeyValueEnd(); ++it) {
         setHeader(it->first, it->second);
     }
+    for (auto it = _additionalRawHeaders.constKeyValueBegin(); it != _additionalRawHeaders.constKeyValueEnd(); ++it) {
+        setRawHeader(it->first, it->second);
+    }
     emit metaDataChanged();
     emit readyRead();
     setFinished(true);
@@ -1076,6 +1124,8 @@ QNetworkReply *FakeQNAM::createRequest(QNetworkAccessManager::Operation op, cons
             reply = new FakeDeleteReply { info, op, newRequest, this };
         } else if (verb == QLatin1String("MOVE") && !isUpload) {
             reply = new FakeMoveReply { info, op, newRequest, this };
+        } else if (verb == QLatin1String("COPY")) {
+            reply = new FakeCopyReply { info, op, newRequest, this };
         } else if (verb == QLatin1String("MOVE") && isUpload) {
             reply = new FakeChunkMoveReply { info, _remoteRootFileInfo, op, newRequest, this };
         } else if (verb == QLatin1String("POST") || op == QNetworkAccessManager::PostOperation) {
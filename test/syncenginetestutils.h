@@ -302,6 +302,19 @@ public:
     qint64 readData(char *, qint64) override { return 0; }
 };
 
+class FakeCopyReply : public FakeReply
+{
+    Q_OBJECT
+    int _httpStatus = 201;
+public:
+    FakeCopyReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
+
+    Q_INVOKABLE void respond();
+
+    void abort() override { }
+    qint64 readData(char *, qint64) override { return 0; }
+};
+
 class FakeGetReply : public FakeReply
 {
     Q_OBJECT
@@ -378,6 +391,7 @@ public:
     QByteArray _body;
 
     QMap<QNetworkRequest::KnownHeaders, QByteArray> _additionalHeaders;
+    QMap<QByteArray, QByteArray> _additionalRawHeaders;
 
     static const int defaultDelay = 10;
 };
@@ -129,6 +129,45 @@ private slots:
         QCOMPARE(model->rowCount(), 50);
     };
 
+    // An unchanged newest page must not send the next page back to the start
+    void testNotModifiedRefreshKeepsPaging() {
+        const auto model = testingALM();
+        QSignalSpy activitiesJob(model.data(), &TestingALM::activitiesProcessed);
+        model->startFetchJob();
+        QVERIFY(activitiesJob.wait(3000));
+        QCOMPARE(model->rowCount(), 50);
+        const auto pagedUntil = model->currentItem();
+
+        // the refresh sends the ETag of the newest page, which didn't change
+        QSignalSpy statusCodes(model.data(), &TestingALM::activityJobStatusCode);
+        model->startRefreshJob();
+        QVERIFY(statusCodes.wait(3000));
+        QCOMPARE(statusCodes.first().first().toInt(), 304);
+        QCOMPARE(model->rowCount(), 50);
+        QCOMPARE(model->currentItem(), pagedUntil);
+        QVERIFY(!model->doneFetching());
+
+        // the next page continues after the one fetched before the refresh
+        model->startFetchJob();
+        QVERIFY(activitiesJob.wait(3000));
+        QCOMPARE(model->rowCount(), FakeRemoteActivityStorage::instance()->totalNumActivites());
+    };
+
+    // The server answers 304 for the empty page after the last one, which ends the paging
+    void testNotModifiedEmptyPageEndsPaging() {
+        const auto model = testingALM();
+        QSignalSpy statusCodes(model.data(), &TestingALM::activityJobStatusCode);
+        do {
+            QVERIFY(!model->doneFetching());
+            model->startFetchJob();
+            QVERIFY(statusCodes.wait(3000));
+        } while (statusCodes.last().first().toInt() != 304 && statusCodes.count() < 10);
+
+        QCOMPARE(statusCodes.count(), 3);
+        QCOMPARE(model->rowCount(), FakeRemoteActivityStorage::instance()->totalNumActivites());
+        QVERIFY(model->doneFetching());
+    };
+
     // Test receiving activity from local user action
     void testLocalSyncFileAction() {
         testActivityAdd(&TestingALM::addSyncFileItemToActivityList, testSyncFileItemActivity);
@@ -13,7 +13,9 @@
  */
 #include "syncenginetestutils.h"
 #include "clientsideencryption.h"
+#include "discoveryphase.h"
 #include "foldermetadata.h"
+#include "updatee2eefolderusersmetadatajob.h"
 #include <QtTest>
 
 using namespace OCC;
@@ -376,6 +378,186 @@ private slots:
         }
         QVERIFY(isFirstUserPresentAndCanDecrypt);
     }
+
+    void testDiscoveryE2eMetadataCache()
+    {
+        FakeFolder fakeFolder{FileInfo{}};
+        const auto account = fakeFolder.account();
+        account->setCapabilities({{QStringLiteral("end-to-end-encryption"), QVariantMap{
+            {QStringLiteral("enabled"), true},
+            {QStringLiteral("api-version"), "2.0"}
+        }}});
+        account->e2e()->_certificate = _account->e2e()->_certificate;
+        account->e2e()->_publicKey = _account->e2e()->_publicKey;
+        account->e2e()->_privateKey = _account->e2e()->_privateKey;
+
+        fakeFolder.remoteModifier().mkdir("enc");
+        fakeFolder.remoteModifier().insert("enc/mangled");
+        fakeFolder.remoteModifier().setE2EE("enc", true);
+
+        int nMetadataRequests = 0;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.url().path().contains(QLatin1String("/meta-data/"))) {
+                ++nMetadataRequests;
+                return new FakeErrorReply(op, request, &parent, 404);
+            }
+            return nullptr;
+        });
+
+        auto &journal = fakeFolder.syncJournal();
+        const auto storeCacheEntry = [&](SyncFileItem::EncryptionStatus encryptionStatus, bool hasNestedFolders) {
+            const auto folder = fakeFolder.remoteModifier().find("enc");
+            const QJsonObject cached{
+                {QStringLiteral("encryptionStatus"), static_cast<int>(encryptionStatus)},
+                {QStringLiteral("hasNestedFolders"), hasNestedFolders},
+                {QStringLiteral("files"), QJsonObject{{QStringLiteral("mangled"), QStringLiteral("original.txt")}}},
+            };
+            const auto data = EncryptionHelper::encryptStringSymmetric(account->e2e()->localCacheKey(), QJsonDocument(cached).toJson(QJsonDocument::Compact));
+            journal.setE2eMetadataCache(folder->fileId, folder->etag, data);
+        };
+        QStringList names;
+        const auto discover = [&] {
+            names.clear();
+            auto job = new DiscoverySingleDirectoryJob(account, QStringLiteral("/enc"), {QStringLiteral("/enc")}, &parent);
+            job->setE2eMetadataCache(&journal);
+            connect(job, &DiscoverySingleDirectoryJob::finished, &parent, [&names](const HttpResult<QVector<RemoteInfo>> &result) {
+                if (result) {
+                    for (const auto &info : *result) {
+                        names.append(info.name);
+                    }
+                }
+            });
+            job->start();
+            return job;
+        };
+
+        // A stored entry for the current etag is applied without asking the server
+        storeCacheEntry(SyncFileItem::EncryptionStatus::EncryptedMigratedV2_0, false);
+        {
+            QSignalSpy done(discover(), &QObject::destroyed);
+            QVERIFY(done.wait());
+        }
+        QCOMPARE(nMetadataRequests, 0);
+        QCOMPARE(names, QStringList{"original.txt"});
+
+        // A changed folder has a new etag, the entry is not used
+        fakeFolder.remoteModifier().insert("enc/other");
+        {
+            QSignalSpy done(discover(), &QObject::destroyed);
+            QVERIFY(done.wait());
+        }
+        QCOMPARE(nMetadataRequests, 1);
+        QVERIFY(!names.contains("original.txt"));
+
+        // Metadata of an older version that this client migrates is fetched and the entry dropped
+        nMetadataRequests = 0;
+        storeCacheEntry(SyncFileItem::EncryptionStatus::Encrypted, false);
+        {
+            QSignalSpy done(discover(), &QObject::destroyed);
+            QVERIFY(done.wait());
+        }
+        QCOMPARE(nMetadataRequests, 1);
+        QVERIFY(!names.contains("original.txt"));
+        const auto folder = fakeFolder.remoteModifier().find("enc");
+        QVERIFY(journal.e2eMetadataCache(folder->fileId, folder->etag).isEmpty());
+
+        // ... unless it has nested folders, which are not migrated
+        nMetadataRequests = 0;
+        storeCacheEntry(SyncFileItem::EncryptionStatus::Encrypted, true);
+        {
+            QSignalSpy done(discover(), &QObject::destroyed);
+            QVERIFY(done.wait());
+        }
+        QCOMPARE(nMetadataRequests, 0);
+        QVERIFY(names.contains("original.txt"));
+    }
+
+    void testFolderUserUpdateWithFailingNestedFolder()
+    {
+        FakeFolder fakeFolder{FileInfo{}};
+        const auto account = fakeFolder.account();
+        account->setCapabilities({{QStringLiteral("end-to-end-encryption"), QVariantMap{
+            {QStringLiteral("enabled"), true},
+            {QStringLiteral("api-version"), "2.0"}
+        }}});
+        account->e2e()->_certificate = _account->e2e()->_certificate;
+        account->e2e()->_publicKey = _account->e2e()->_publicKey;
+        account->e2e()->_privateKey = _account->e2e()->_privateKey;
+
+        const QStringList nestedFolders = {"enc/s1", "enc/s2", "enc/s3", "enc/s4", "enc/s5", "enc/s6"};
+        fakeFolder.remoteModifier().mkdir("enc");
+        for (const auto &nestedFolder : nestedFolders) {
+            fakeFolder.remoteModifier().mkdir(nestedFolder);
+        }
+        QVERIFY(fakeFolder.syncOnce());
+
+        // The nested folders are known by their mangled names, keep them equal to the paths
+        auto &journal = fakeFolder.syncJournal();
+        for (const auto &path : QStringList{"enc"} + nestedFolders) {
+            SyncJournalFileRecord record;
+            QVERIFY(journal.getFileRecord(path, &record));
+            record._e2eEncryptionStatus = SyncJournalFileRecord::EncryptionStatus::EncryptedMigratedV2_0;
+            record._e2eMangledName = path == QStringLiteral("enc") ? QByteArray{} : path.toUtf8();
+            QVERIFY(journal.setFileRecord(record));
+        }
+
+        QHash<QByteArray, QString> pathsByFileId;
+        for (const auto &path : QStringList{"enc"} + nestedFolders) {
+            pathsByFileId.insert(fakeFolder.remoteModifier().find(path)->fileId, path);
+        }
+        QStringList metadataFetched;
+        QStringList metadataStored;
+        int nUnlocks = 0;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            const auto urlPath = request.url().path();
+            const auto path = pathsByFileId.value(urlPath.mid(urlPath.lastIndexOf(QLatin1Char('/')) + 1).toUtf8());
+            if (urlPath.contains(QLatin1String("/lock/"))) {
+                if (op == QNetworkAccessManager::DeleteOperation) {
+                    ++nUnlocks;
+                    return new FakePayloadReply(op, request, {}, &parent);
+                }
+                return new FakePayloadReply(op, request, R"({"ocs":{"data":{"e2e-token":"token"},"meta":{"statuscode":200}}})", &parent);
+            }
+            if (urlPath.contains(QLatin1String("/meta-data/"))) {
+                if (op == QNetworkAccessManager::GetOperation) {
+                    // none of the folders has metadata yet
+                    metadataFetched.append(path);
+                    return new FakeErrorReply(op, request, &parent, 404);
+                }
+                metadataStored.append(path);
+                if (path == QStringLiteral("enc/s2")) {
+                    return new FakeErrorReply(op, request, &parent, 500);
+                }
+                // the other nested folders only succeed after enc/s2 failed
+                return new FakePayloadReply(op, request, {}, path == QStringLiteral("enc") ? 0 : 100, &parent);
+            }
+            return nullptr;
+        });
+
+        QPointer<UpdateE2eeFolderUsersMetadataJob> job = new UpdateE2eeFolderUsersMetadataJob(account, &journal, QStringLiteral("/"),
+            UpdateE2eeFolderUsersMetadataJob::Add, QStringLiteral("/enc"), QStringLiteral("sharee"), account->e2e()->_certificate, &parent);
+        QSignalSpy finished(job.data(), SIGNAL(finished(int, QString)));
+        job->start();
+        QVERIFY(finished.wait());
+        // Give a second emission the chance to happen
+        QTest::qWait(200);
+
+        QCOMPARE(finished.count(), 1);
+        QCOMPARE(finished.first().at(0).toInt(), 500);
+        QVERIFY(finished.first().at(1).toString().contains(QStringLiteral("enc/s2")));
+
+        // The running sub jobs finish, no new ones start after the failure
+        metadataFetched.sort();
+        QCOMPARE(metadataFetched, (QStringList{"enc", "enc/s1", "enc/s2", "enc/s3", "enc/s4"}));
+        metadataStored.sort();
+        QCOMPARE(metadataStored, (QStringList{"enc", "enc/s1", "enc/s2", "enc/s3", "enc/s4"}));
+
+        // The folder is unlocked once
+        QCOMPARE(nUnlocks, 1);
+        QVERIFY(journal.e2EeLockedFolders().isEmpty());
+    }
 };
 
 QTEST_GUILESS_MAIN(TestClientSideEncryptionV2)
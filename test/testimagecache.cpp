@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "gui/tray/imagecache.h"
+
+using namespace OCC;
+
+namespace {
+
+const QByteArray squareSvg = QByteArrayLiteral(
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"8\" height=\"8\" viewBox=\"0 0 8 8\">"
+    "<rect width=\"8\" height=\"8\" fill=\"#000000\"/></svg>");
+
+}
+
+class TestImageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testImageKey()
+    {
+        const auto key = ImageCache::imageKey(QStringLiteral("https://cloud/icon.svg"), QSize(16, 16));
+        QCOMPARE(ImageCache::imageKey(QStringLiteral("https://cloud/icon.svg"), QSize(16, 16)), key);
+        QVERIFY(ImageCache::imageKey(QStringLiteral("https://cloud/icon.svg"), QSize(32, 32)) != key);
+        QVERIFY(ImageCache::imageKey(QStringLiteral("https://cloud/icon.svg"), QSize(16, 16), Qt::red) != key);
+        QVERIFY(ImageCache::imageKey(QStringLiteral("https://cloud/other.svg"), QSize(16, 16)) != key);
+    }
+
+    void testMemoryCache()
+    {
+        QTemporaryDir dir;
+        ImageCache cache(dir.path());
+
+        QImage image(QSize(16, 16), QImage::Format_ARGB32);
+        image.fill(Qt::green);
+        cache.insertImage(QStringLiteral("a"), image, QSize(8, 8));
+
+        QImage found;
+        QSize originalSize;
+        QVERIFY(cache.findImage(QStringLiteral("a"), &found, &originalSize));
+        QCOMPARE(found, image);
+        QCOMPARE(originalSize, QSize(8, 8));
+        QVERIFY(!cache.findImage(QStringLiteral("b"), &found));
+
+        // null images are not worth remembering
+        cache.insertImage(QStringLiteral("null"), QImage());
+        QVERIFY(!cache.findImage(QStringLiteral("null"), &found));
+
+        // The least recently used images go once the budget is exceeded: 8MiB each
+        QImage large(QSize(2048, 1024), QImage::Format_ARGB32);
+        large.fill(Qt::blue);
+        cache.insertImage(QStringLiteral("large1"), large);
+        cache.insertImage(QStringLiteral("large2"), large);
+        cache.insertImage(QStringLiteral("large3"), large);
+        QVERIFY(cache.findImage(QStringLiteral("large1"), &found));
+        cache.insertImage(QStringLiteral("large4"), large);
+        QVERIFY(cache.findImage(QStringLiteral("large1"), &found));
+        QVERIFY(cache.findImage(QStringLiteral("large4"), &found));
+        QVERIFY(!cache.findImage(QStringLiteral("a"), &found));
+
+        cache.clearImages();
+        QVERIFY(!cache.findImage(QStringLiteral("large1"), &found));
+    }
+
+    void testDiskCache()
+    {
+        QTemporaryDir dir;
+        ImageCache cache(dir.path());
+        const QUrl fresh(QStringLiteral("https://cloud/fresh.png"));
+        const QUrl revalidate(QStringLiteral("https://cloud/revalidate.png"));
+        const QUrl noStore(QStringLiteral("https://cloud/nostore.png"));
+        const QUrl noEtag(QStringLiteral("https://cloud/noetag.png"));
+
+        cache.insertData(fresh, "fresh data", "\"etag1\"", "max-age=3600");
+        cache.insertData(revalidate, "stale data", "\"etag2\"", "no-cache");
+        cache.insertData(noStore, "secret", "\"etag3\"", "max-age=3600, no-store");
+        cache.insertData(noEtag, "unusable", QByteArray(), QByteArray());
+
+        auto data = cache.findData(fresh);
+        QCOMPARE(data.data, QByteArray("fresh data"));
+        QCOMPARE(data.etag, QByteArray("\"etag1\""));
+        QVERIFY(data.fresh);
+
+        data = cache.findData(revalidate);
+        QCOMPARE(data.data, QByteArray("stale data"));
+        QCOMPARE(data.etag, QByteArray("\"etag2\""));
+        QVERIFY(!data.fresh);
+
+        QVERIFY(cache.findData(noStore).data.isEmpty());
+        QVERIFY(cache.findData(noEtag).data.isEmpty());
+
+        // a 304 renews the stored data
+        cache.updateData(revalidate, "private, max-age=60");
+        data = cache.findData(revalidate);
+        QCOMPARE(data.data, QByteArray("stale data"));
+        QVERIFY(data.fresh);
+
+        // and the data survives the cache object
+        ImageCache otherCache(dir.path());
+        QCOMPARE(otherCache.findData(fresh).data, QByteArray("fresh data"));
+    }
+
+    void testRenderImage()
+    {
+        auto image = ImageCache::renderImage(squareSvg, QSize(16, 16), Qt::red);
+        QCOMPARE(image.size(), QSize(16, 16));
+        QCOMPARE(image.pixelColor(8, 8), QColor(Qt::red));
+
+        image = ImageCache::renderImage(squareSvg, QSize(), QColor());
+        QCOMPARE(image.size(), QSize(8, 8));
+        QCOMPARE(image.pixelColor(4, 4), QColor(Qt::black));
+
+        QImage png(QSize(4, 4), QImage::Format_ARGB32);
+        png.fill(Qt::green);
+        QByteArray pngData;
+        QBuffer buffer(&pngData);
+        buffer.open(QIODevice::WriteOnly);
+        png.save(&buffer, "PNG");
+        QCOMPARE(ImageCache::renderImage(pngData, QSize(16, 16)).pixelColor(1, 1), QColor(Qt::green));
+
+        QVERIFY(ImageCache::renderImage("<svg broken", QSize(16, 16)).isNull());
+        QVERIFY(ImageCache::renderImage("[]", QSize(16, 16)).isNull());
+    }
+};
+
+QTEST_MAIN(TestImageCache)
+#include "testimagecache.moc"
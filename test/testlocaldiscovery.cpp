@@ -148,6 +148,70 @@ private slots:
         QVERIFY(tracker.localDiscoveryPaths().empty());
     }
 
+    // Check that a full local discovery spread over several syncs sees everything
+    void testFullDiscoverySlices()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+
+        LocalDiscoveryTracker tracker;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::itemCompleted, &tracker, &LocalDiscoveryTracker::slotItemCompleted);
+        connect(&fakeFolder.syncEngine(), &SyncEngine::finished, &tracker, &LocalDiscoveryTracker::slotSyncFinished);
+
+        fakeFolder.localModifier().mkdir("A/X");
+        fakeFolder.localModifier().mkdir("A/Y");
+        fakeFolder.localModifier().insert("A/X/x1");
+        fakeFolder.localModifier().insert("A/Y/y1");
+        tracker.startSyncFullDiscovery();
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(!tracker.lastSyncCompletedFullDiscovery());
+
+        // Everything fits into one slice
+        QVERIFY(!tracker.planFullDiscoverySlices(fakeFolder.syncJournal(), 100));
+        QVERIFY(!tracker.hasFullDiscoverySlices());
+
+        // "A" has 7 records and is split, the others get a slice each
+        QVERIFY(tracker.planFullDiscoverySlices(fakeFolder.syncJournal(), 4));
+        QCOMPARE(tracker.fullDiscoverySlicePaths(), (std::set<QString>{ "A/X", "A/Y" }));
+
+        fakeFolder.localModifier().insert("A/Y/y2");
+        fakeFolder.localModifier().insert("C/c3");
+        fakeFolder.localModifier().insert("B/b3");
+        tracker.addTouchedPath("B/b3");
+
+        auto syncSlice = [&]() {
+            fakeFolder.syncEngine().setLocalDiscoveryOptions(LocalDiscoveryStyle::DatabaseAndFilesystem, tracker.fullDiscoverySlicePaths());
+            tracker.startSyncFullDiscoverySlice();
+            return fakeFolder.syncOnce();
+        };
+
+        QVERIFY(syncSlice());
+        QVERIFY(fakeFolder.currentRemoteState().find("A/Y/y2"));
+        QVERIFY(fakeFolder.currentRemoteState().find("B/b3"));
+        QVERIFY(!fakeFolder.currentRemoteState().find("C/c3"));
+        QCOMPARE(tracker.fullDiscoverySlicePaths(), (std::set<QString>{ "B" }));
+
+        QVERIFY(syncSlice());
+        QVERIFY(!fakeFolder.currentRemoteState().find("C/c3"));
+        QCOMPARE(tracker.fullDiscoverySlicePaths(), (std::set<QString>{ "C" }));
+
+        // A failing slice is retried
+        fakeFolder.serverErrorPaths().append("C/c3");
+        QVERIFY(!syncSlice());
+        QCOMPARE(tracker.fullDiscoverySlicePaths(), (std::set<QString>{ "C", "C/c3" }));
+        fakeFolder.serverErrorPaths().clear();
+        QVERIFY(fakeFolder.syncJournal().wipeErrorBlacklist() != -1);
+
+        QVERIFY(syncSlice());
+        QVERIFY(fakeFolder.currentRemoteState().find("C/c3"));
+        QVERIFY(!tracker.lastSyncCompletedFullDiscovery());
+        QCOMPARE(tracker.fullDiscoverySlicePaths(), (std::set<QString>{ "S" }));
+
+        QVERIFY(syncSlice());
+        QVERIFY(tracker.lastSyncCompletedFullDiscovery());
+        QVERIFY(!tracker.hasFullDiscoverySlices());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
     void testLocalDiscoveryDecision()
     {
         FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
@@ -0,0 +1,155 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "networkjobs.h"
+#include "networktimings.h"
+#include "syncenginetestutils.h"
+
+using namespace OCC;
+
+class TestNetworkTimings : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup()
+    {
+        NetworkTimings::setEnabled(false);
+    }
+
+    void testBuckets()
+    {
+        QCOMPARE(NetworkTimings::bucketOf(0), 0);
+        QCOMPARE(NetworkTimings::bucketOf(1), 1);
+        QCOMPARE(NetworkTimings::bucketOf(3), 2);
+        QCOMPARE(NetworkTimings::bucketOf(4), 3);
+        QCOMPARE(NetworkTimings::bucketOf(1000), 10);
+        QCOMPARE(NetworkTimings::bucketOf(1ll << 40), NetworkTimings::bucketCount - 1);
+
+        NetworkTimings::Histogram histogram;
+        QCOMPARE(histogram.quantileMsec(0.5), 0ll);
+        for (int i = 0; i < 90; ++i) {
+            histogram.add(10);
+        }
+        for (int i = 0; i < 10; ++i) {
+            histogram.add(1000);
+        }
+        histogram.add(-1);
+        QCOMPARE(histogram.count, 100u);
+        QCOMPARE(histogram.maxMsec, 1000ll);
+        QCOMPARE(histogram.totalMsec, 10900ll);
+        QCOMPARE(histogram.quantileMsec(0.5), 16ll);
+        QCOMPARE(histogram.quantileMsec(0.95), 1024ll);
+    }
+
+    void testEndpoint()
+    {
+        const QUrl account(QStringLiteral("https://cloud.example.com/nextcloud"));
+        QCOMPARE(NetworkTimings::endpoint(QUrl(QStringLiteral("https://cloud.example.com/nextcloud/remote.php/dav/files/alice/Documents/a.txt")), account),
+            QStringLiteral("remote.php/dav/files"));
+        QCOMPARE(NetworkTimings::endpoint(QUrl(QStringLiteral("https://cloud.example.com/nextcloud/remote.php/dav/uploads/alice/123/00001")), account),
+            QStringLiteral("remote.php/dav/uploads"));
+        QCOMPARE(NetworkTimings::endpoint(QUrl(QStringLiteral("https://cloud.example.com/nextcloud/remote.php/webdav/a.txt")), account),
+            QStringLiteral("remote.php/webdav"));
+        QCOMPARE(NetworkTimings::endpoint(QUrl(QStringLiteral("https://cloud.example.com/nextcloud/ocs/v2.php/apps/files_sharing/api/v1/shares/42?format=json")), account),
+            QStringLiteral("ocs/v2.php/apps/files_sharing/api/v1/shares/{id}"));
+        QCOMPARE(NetworkTimings::endpoint(QUrl(QStringLiteral("https://cloud.example.com/status.php")), QUrl(QStringLiteral("https://cloud.example.com"))),
+            QStringLiteral("status.php"));
+    }
+
+    void testDisabledRecordsNothing()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.remoteModifier().appendByte(QStringLiteral("A/a1"));
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(!fakeFolder.syncEngine().networkTimings());
+    }
+
+    void testSyncRun()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        NetworkTimings::setEnabled(true);
+
+        fakeFolder.localModifier().appendByte(QStringLiteral("A/a1"));
+        fakeFolder.remoteModifier().appendByte(QStringLiteral("B/b1"));
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        const auto timings = fakeFolder.syncEngine().networkTimings();
+        QVERIFY(timings);
+        const auto stats = timings->stats();
+        QVERIFY(stats.contains(QStringLiteral("PROPFIND remote.php/dav/files")));
+        QVERIFY(stats.contains(QStringLiteral("PUT remote.php/dav/files")));
+        QVERIFY(stats.contains(QStringLiteral("GET remote.php/dav/files")));
+        QCOMPARE(stats.value(QStringLiteral("PUT remote.php/dav/files")).timeToFirstByte.count, 1u);
+        QVERIFY(stats.value(QStringLiteral("PUT remote.php/dav/files")).bytesSent > 0);
+        QVERIFY(timings->statsSummary().contains(QStringLiteral("GET remote.php/dav/files: 1 requests")));
+
+        const auto requests = timings->runRequests();
+        QVERIFY(!requests.isEmpty());
+        for (const auto &request : requests) {
+            QVERIFY(request.createdMsec >= 0);
+            QVERIFY(request.sentMsec >= request.createdMsec);
+            QVERIFY(request.finishedMsec >= request.sentMsec);
+        }
+
+        const auto log = timings->toHar().value(QStringLiteral("log")).toObject();
+        QCOMPARE(log.value(QStringLiteral("version")).toString(), QStringLiteral("1.2"));
+        const auto entries = log.value(QStringLiteral("entries")).toArray();
+        QCOMPARE(entries.size(), requests.size());
+        const auto entry = entries.first().toObject();
+        QVERIFY(entry.value(QStringLiteral("startedDateTime")).toString().endsWith(QLatin1Char('Z')));
+        QVERIFY(entry.value(QStringLiteral("request")).toObject().value(QStringLiteral("url")).toString().startsWith(QStringLiteral("http://localhost/owncloud/")));
+        QVERIFY(!entry.value(QStringLiteral("request")).toObject().value(QStringLiteral("url")).toString().contains(QStringLiteral("admin@")));
+        const auto timings = entry.value(QStringLiteral("timings")).toObject();
+        QCOMPARE(entry.value(QStringLiteral("time")).toInt(),
+            timings.value(QStringLiteral("blocked")).toInt() + timings.value(QStringLiteral("wait")).toInt() + timings.value(QStringLiteral("receive")).toInt());
+
+        // the next run starts a new waterfall but keeps aggregating
+        fakeFolder.remoteModifier().appendByte(QStringLiteral("B/b2"));
+        QVERIFY(fakeFolder.syncOnce());
+        const auto secondRun = timings->runRequests();
+        QVERIFY(!secondRun.isEmpty());
+        QVERIFY(std::none_of(secondRun.cbegin(), secondRun.cend(), [](const NetworkTimings::Request &request) { return request.verb == "PUT"; }));
+        QCOMPARE(timings->stats().value(QStringLiteral("GET remote.php/dav/files")).timeToFirstByte.count, 2u);
+    }
+
+    void testOnlyTheEngineRequests()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        FakeFolder otherFolder{FileInfo::A12_B12_C12_S12()};
+        NetworkTimings::setEnabled(true);
+
+        fakeFolder.localModifier().appendByte(QStringLiteral("A/a1"));
+        QVERIFY(fakeFolder.syncOnce());
+        const auto timings = fakeFolder.syncEngine().networkTimings();
+        QVERIFY(timings);
+        const auto requests = timings->runRequests();
+        QVERIFY(std::any_of(requests.cbegin(), requests.cend(), [](const NetworkTimings::Request &request) { return request.verb == "PUT"; }));
+
+        // another folder's run doesn't touch this one
+        otherFolder.remoteModifier().appendByte(QStringLiteral("B/b1"));
+        QVERIFY(otherFolder.syncOnce());
+        QVERIFY(otherFolder.syncEngine().networkTimings());
+        QVERIFY(otherFolder.syncEngine().networkTimings() != timings);
+        QCOMPARE(timings->runRequests().size(), requests.size());
+        QVERIFY(!timings->stats().contains(QStringLiteral("GET remote.php/dav/files")));
+
+        // neither do requests outside of the sync, like the ones of the GUI
+        auto job = new LsColJob(fakeFolder.account(), QStringLiteral("A"));
+        job->setProperties({"resourcetype", "getetag"});
+        QSignalSpy finished(job, &LsColJob::finishedWithoutError);
+        job->start();
+        QVERIFY(finished.wait());
+        QCOMPARE(timings->runRequests().size(), requests.size());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestNetworkTimings)
+#include "testnetworktimings.moc"
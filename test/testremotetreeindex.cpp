@@ -0,0 +1,127 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "remotetreeindex.h"
+#include "networkjobs.h"
+#include "syncenginetestutils.h"
+
+using namespace OCC;
+
+namespace {
+
+RemoteTreeIndex::Folder makeFolder(const QString &path, const QByteArray &etag, qint64 size)
+{
+    RemoteTreeIndex::Folder folder;
+    folder.href = QStringLiteral("/dav/") + path + QLatin1Char('/');
+    folder.path = path;
+    folder.properties.insert(QStringLiteral("getetag"), QString::fromLatin1(etag));
+    folder.size = size;
+    return folder;
+}
+
+RemoteTreeIndex::Listing makeListing(const QVector<RemoteTreeIndex::Folder> &folders)
+{
+    RemoteTreeIndex::Listing listing;
+    listing.properties = {"resourcetype", "getetag", "http://owncloud.org/ns:size"};
+    listing.folders = folders;
+    listing.etag = folders.first().properties.value(QStringLiteral("getetag")).toUtf8();
+    return listing;
+}
+
+}
+
+class TestRemoteTreeIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testNormalizedPath()
+    {
+        QCOMPARE(RemoteTreeIndex::normalizedPath(QStringLiteral("/")), QString());
+        QCOMPARE(RemoteTreeIndex::normalizedPath(QStringLiteral("/A/")), QStringLiteral("A"));
+        QCOMPARE(RemoteTreeIndex::normalizedPath(QStringLiteral("A//b/")), QStringLiteral("A/b"));
+    }
+
+    void testFolderSizeAndEtags()
+    {
+        RemoteTreeIndex index;
+        index.insertListing(QStringLiteral("/"), makeListing({makeFolder({}, "root1", 30), makeFolder(QStringLiteral("A"), "a1", 10), makeFolder(QStringLiteral("B"), "b1", 20)}));
+        index.insertListing(QStringLiteral("A"), makeListing({makeFolder(QStringLiteral("A"), "a1", 10), makeFolder(QStringLiteral("A/sub"), "sub1", 5)}));
+        index.insertListing(QStringLiteral("A/sub"), makeListing({makeFolder(QStringLiteral("A/sub"), "sub1", 5)}));
+
+        QCOMPARE(index.folderSize(QStringLiteral("/A/")), 10ll);
+        QCOMPARE(index.folderSize(QStringLiteral("B")), 20ll);
+        QCOMPARE(index.folderSize(QStringLiteral("A/sub")), 5ll);
+        QCOMPARE(index.folderSize(QStringLiteral("C")), -1ll);
+        QCOMPARE(index.folderSize(QString()), -1ll);
+        QVERIFY(index.findListing(QStringLiteral("A"), {"getetag"}));
+        QVERIFY(!index.findListing(QStringLiteral("A"), {"http://owncloud.org/ns:permissions"}));
+
+        // a new etag of A drops what is known below A, but not its siblings
+        index.insertListing(QString(), makeListing({makeFolder({}, "root2", 31), makeFolder(QStringLiteral("A"), "a2", 11), makeFolder(QStringLiteral("B"), "b1", 20)}));
+        QVERIFY(!index.findListing(QStringLiteral("A")));
+        QVERIFY(!index.findListing(QStringLiteral("A/sub")));
+        QCOMPARE(index.folderSize(QStringLiteral("A")), 11ll);
+        QCOMPARE(index.folderSize(QStringLiteral("A/sub")), -1ll);
+
+        index.insertListing(QStringLiteral("B"), makeListing({makeFolder(QStringLiteral("B"), "b1", 20)}));
+        QVERIFY(index.findListing(QStringLiteral("B")));
+        index.invalidate(QStringLiteral("B"));
+        QVERIFY(!index.findListing(QStringLiteral("B")));
+        QVERIFY(!index.findListing(QString()));
+    }
+
+    void testCachedListing()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("A/sub"));
+        QVERIFY(fakeFolder.syncOnce());
+
+        int propfindCount = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray() == "PROPFIND") {
+                ++propfindCount;
+            }
+            return nullptr;
+        });
+
+        const auto list = [&fakeFolder](const QString &path, bool cachedListingAllowed) {
+            auto job = new LsColJob(fakeFolder.account(), path);
+            job->setProperties({"resourcetype", "getetag", "http://owncloud.org/ns:size"});
+            job->setCachedListingAllowed(cachedListingAllowed);
+            QSignalSpy subfolders(job, &LsColJob::directoryListingSubfolders);
+            job->start();
+            if (!subfolders.wait()) {
+                return QStringList();
+            }
+            return subfolders.first().first().toStringList();
+        };
+
+        // the listings of the sync answer without asking the server
+        const auto rootFolders = list(QStringLiteral("/"), true);
+        QCOMPARE(rootFolders.size(), 5);
+        QCOMPARE(list(QStringLiteral("A"), true).size(), 2);
+        QCOMPARE(propfindCount, 0);
+
+        // unless the caller wants fresh data
+        QCOMPARE(list(QStringLiteral("A"), false).size(), 2);
+        QCOMPARE(propfindCount, 1);
+
+        // the next sync lists A again since its etag changed
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("A/sub2"));
+        QVERIFY(fakeFolder.syncOnce());
+        propfindCount = 0;
+        QCOMPARE(list(QStringLiteral("A"), true).size(), 3);
+        QCOMPARE(propfindCount, 0);
+        QCOMPARE(fakeFolder.account()->remoteTreeIndex()->folderSize(QStringLiteral("A")), 8ll);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRemoteTreeIndex)
+#include "testremotetreeindex.moc"
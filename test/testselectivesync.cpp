@@ -67,8 +67,8 @@ private slots:
         QCOMPARE(newBigFolder.first()[1].toBool(), false);
         newBigFolder.clear();
 
-        QCOMPARE(sizeRequests.count(), 2); // "A/newBigDir" and "B/newSmallDir";
-        QCOMPARE(sizeRequests.filter("/subDir").count(), 0); // at no point we should request the size of the subdirs
+        // The sizes of "A/newBigDir" and "B/newSmallDir" come with the listings of their parents
+        QCOMPARE(sizeRequests.count(), 0);
         sizeRequests.clear();
 
         auto oldSync = fakeFolder.currentLocalState();
@@ -78,7 +78,7 @@ private slots:
         QCOMPARE(fakeFolder.currentLocalState(), oldSync);
         QCOMPARE(newBigFolder.count(), 1); // (since we don't have a real Folder, the files were not added to any list)
         newBigFolder.clear();
-        QCOMPARE(sizeRequests.count(), 1); // "A/newBigDir";
+        QCOMPARE(sizeRequests.count(), 0); // "A/newBigDir" is in the listing of "A"
         sizeRequests.clear();
 
         // Simulate that we accept all files by setting a wildcard white list
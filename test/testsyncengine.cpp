@@ -1764,6 +1764,447 @@ private slots:
         QVERIFY(fakeFolder.syncOnce());
         QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
     }
+
+    void testPropagationOrderOfMixedDepthDiscoveries()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+
+        QStringList mkcolPaths;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toString() == QLatin1String("MKCOL")) {
+                mkcolPaths.append(request.url().path());
+            }
+            return nullptr;
+        });
+        SyncFileItemVector propagatedItems;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToPropagate, this, [&propagatedItems](SyncFileItemVector &items) {
+            propagatedItems = items;
+        });
+
+        // Discovered level by level, so deep items arrive between shallow ones
+        fakeFolder.localModifier().mkdir("A/new");
+        fakeFolder.localModifier().mkdir("A/new/deep");
+        fakeFolder.localModifier().mkdir("A/new/deep/er");
+        fakeFolder.localModifier().insert("A/new/deep/er/file");
+        fakeFolder.localModifier().insert("A/new/deep/file");
+        fakeFolder.localModifier().insert("A/new/file");
+        fakeFolder.localModifier().insert("A/new-file");
+        fakeFolder.localModifier().mkdir("B/new");
+        fakeFolder.localModifier().insert("B/new/file");
+        fakeFolder.localModifier().mkdir("Z");
+        fakeFolder.localModifier().insert("Z/file");
+        fakeFolder.remoteModifier().mkdir("C/remote");
+        fakeFolder.remoteModifier().insert("C/remote/file");
+        fakeFolder.remoteModifier().insert("C/remote-file");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        QStringList propagatedPaths;
+        for (const auto &item : qAsConst(propagatedItems)) {
+            if (item->_instruction == CSYNC_INSTRUCTION_NEW) {
+                propagatedPaths.append(item->destination());
+            }
+        }
+        QCOMPARE(propagatedPaths, QStringList({
+            "A/new", "A/new/deep", "A/new/deep/er", "A/new/deep/er/file", "A/new/deep/file", "A/new/file", "A/new-file",
+            "B/new", "B/new/file",
+            "C/remote", "C/remote/file", "C/remote-file",
+            "Z", "Z/file",
+        }));
+
+        // Folders are created on the server before their contents
+        QCOMPARE(mkcolPaths.size(), 5);
+        for (int i = 1; i < mkcolPaths.size(); ++i) {
+            QVERIFY(mkcolPaths[i - 1] < mkcolPaths[i]);
+        }
+    }
+
+    void testDeduplicatedUpload()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._deduplicateUploads = true;
+        syncOptions._deduplicateUploadsMinSize = 0;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        int nPUT = 0, nCOPY = 0;
+        bool failCopy = false;
+        bool ignoreCopyMtime = false;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                ++nPUT;
+            } else if (request.attribute(QNetworkRequest::CustomVerbAttribute).toString() == QLatin1String("COPY")) {
+                ++nCOPY;
+                if (failCopy) {
+                    return new FakeErrorReply(op, request, &parent, 403);
+                }
+                if (ignoreCopyMtime) {
+                    auto copyRequest = request;
+                    copyRequest.setRawHeader("X-OC-Mtime", QByteArray());
+                    return new FakeCopyReply(fakeFolder.remoteModifier(), op, copyRequest, &parent);
+                }
+            }
+            return nullptr;
+        });
+
+        // Identical content in one sync run is uploaded once
+        fakeFolder.localModifier().insert("A/dup1", 100, 'X');
+        fakeFolder.localModifier().insert("B/dup2", 100, 'X');
+        fakeFolder.localModifier().insert("C/dup3", 100, 'X');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(nCOPY, 2);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // ... and is copied in later runs
+        nPUT = nCOPY = 0;
+        fakeFolder.localModifier().insert("A/dup4", 100, 'X');
+        fakeFolder.localModifier().insert("A/other", 100, 'Y');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(nCOPY, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        auto remoteState = fakeFolder.currentRemoteState();
+        QVERIFY(remoteState.find("A/dup4")->fileId != remoteState.find("A/dup1")->fileId);
+
+        // The source changed on the server: the outdated copy is refused and the file uploaded
+        nPUT = nCOPY = 0;
+        fakeFolder.remoteModifier().appendByte("A/dup1");
+        fakeFolder.localModifier().insert("B/dup5", 100, 'X');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nCOPY, 1);
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // Any error on the copy falls back to the upload
+        nPUT = nCOPY = 0;
+        failCopy = true;
+        fakeFolder.localModifier().insert("C/dup6", 100, 'X');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nCOPY, 1);
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // A copy that kept the modification time of its source is uploaded over
+        nPUT = nCOPY = 0;
+        failCopy = false;
+        ignoreCopyMtime = true;
+        fakeFolder.localModifier().insert("C/dup7", 100, 'X');
+        fakeFolder.localModifier().setModTime("C/dup7", QDateTime::currentDateTimeUtc().addDays(-2));
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nCOPY, 1);
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testLocalCopyDetection()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.localModifier().insert("A/original", 100, 'Z');
+        QVERIFY(fakeFolder.syncOnce());
+
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._deduplicateUploads = true;
+        syncOptions._deduplicateUploadsMinSize = 0;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        int nPUT = 0;
+        QStringList copySources;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                ++nPUT;
+            } else if (request.attribute(QNetworkRequest::CustomVerbAttribute).toString() == QLatin1String("COPY")) {
+                copySources.append(request.url().path());
+            }
+            return nullptr;
+        });
+
+        // A copy of a synced file is copied on the server, a file of the same size is uploaded
+        fakeFolder.localModifier().insert("B/copy", 100, 'Z');
+        fakeFolder.localModifier().insert("C/sameSize", 100, 'Q');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(copySources.size(), 1);
+        QVERIFY(copySources.first().endsWith(QLatin1String("/A/original")));
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        SyncJournalFileRecord record;
+        QVERIFY(fakeFolder.syncJournal().getFileRecord(QByteArrayLiteral("B/copy"), &record));
+        QVERIFY(record.isValid());
+        const auto remoteState = fakeFolder.currentRemoteState();
+        QCOMPARE(record._etag, remoteState.find("B/copy")->etag);
+    }
+
+    void testStreamingPropagation()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._streamingPropagation = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        QStringList earlyItems;
+        QStringList regularItems;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToPropagateEarly, this, [&](SyncFileItemVector &items) {
+            for (const auto &item : items) {
+                earlyItems.append(item->_file);
+            }
+        });
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToPropagate, this, [&](SyncFileItemVector &items) {
+            for (const auto &item : items) {
+                regularItems.append(item->_file);
+            }
+        });
+        QMap<QString, int> puts;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                ++puts[getFilePathFromUrl(request.url())];
+            }
+            return nullptr;
+        });
+        qint64 totalFiles = 0;
+        qint64 completedFiles = 0;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::transmissionProgress, this, [&](const ProgressInfo &progress) {
+            totalFiles = progress.totalFiles();
+            completedFiles = progress.completedFiles();
+        });
+
+        // new files in directories that stay where they are go early
+        fakeFolder.localModifier().insert("A/new1");
+        fakeFolder.localModifier().insert("B/new2");
+        // in the sync root, a moved or a new directory they wait for the end of discovery
+        fakeFolder.localModifier().insert("new3");
+        fakeFolder.localModifier().rename("C", "C2");
+        fakeFolder.localModifier().insert("C2/new4");
+        fakeFolder.localModifier().mkdir("D");
+        fakeFolder.localModifier().insert("D/new5");
+        fakeFolder.remoteModifier().appendByte("S/s1");
+        QVERIFY(fakeFolder.syncOnce());
+
+        earlyItems.sort();
+        QCOMPARE(earlyItems, QStringList({"A/new1", "B/new2"}));
+        QVERIFY(!regularItems.contains("A/new1"));
+        QVERIFY(!regularItems.contains("B/new2"));
+        QVERIFY(regularItems.contains("new3"));
+        QVERIFY(regularItems.contains("D/new5"));
+        for (const auto &path : {"A/new1", "B/new2", "new3", "C2/new4", "D/new5"}) {
+            QCOMPARE(puts.value(QString::fromLatin1(path)), 1);
+        }
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        // the early uploads are part of the progress of the run
+        QVERIFY(totalFiles >= 7);
+        QCOMPARE(completedFiles, totalFiles);
+
+        // Nothing goes early when it is off
+        syncOptions._streamingPropagation = false;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+        earlyItems.clear();
+        fakeFolder.localModifier().insert("A/new6");
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(earlyItems.isEmpty());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testStreamingPropagationWaitsForRemoveAllConfirmation()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._streamingPropagation = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        QStringList earlyItems;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToPropagateEarly, this, [&](SyncFileItemVector &items) {
+            for (const auto &item : items) {
+                earlyItems.append(item->_file);
+            }
+        });
+        int puts = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                ++puts;
+            }
+            return nullptr;
+        });
+        int confirmations = 0;
+        int putsBeforeConfirmation = -1;
+        bool cancel = true;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToRemoveAllFiles, this, [&](SyncFileItem::Direction, std::function<void(bool)> callback) {
+            ++confirmations;
+            putsBeforeConfirmation = puts;
+            callback(cancel);
+        });
+
+        // Everything but A is removed on the server, A only has a new local file left
+        fakeFolder.remoteModifier().remove("A/a1");
+        fakeFolder.remoteModifier().remove("A/a2");
+        fakeFolder.remoteModifier().remove("B");
+        fakeFolder.remoteModifier().remove("C");
+        fakeFolder.remoteModifier().remove("S");
+        fakeFolder.localModifier().insert("A/new1");
+
+        QVERIFY(!fakeFolder.syncOnce());
+        QCOMPARE(confirmations, 1);
+        QCOMPARE(putsBeforeConfirmation, 0);
+        QCOMPARE(puts, 0);
+        QVERIFY(earlyItems.isEmpty());
+        QVERIFY(!fakeFolder.currentRemoteState().find("A/new1"));
+
+        // Once confirmed the upload goes with the regular propagation
+        cancel = false;
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(confirmations, 2);
+        QCOMPARE(putsBeforeConfirmation, 0);
+        QCOMPARE(puts, 1);
+        QVERIFY(earlyItems.isEmpty());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testStreamingPropagationUploadError()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._streamingPropagation = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        fakeFolder.serverErrorPaths().append("A/new1", 500);
+        fakeFolder.localModifier().insert("A/new1");
+        fakeFolder.localModifier().insert("B/new2");
+
+        // The failure of an early upload fails the sync run
+        QVERIFY(!fakeFolder.syncOnce());
+        QVERIFY(!fakeFolder.currentRemoteState().find("A/new1"));
+        QVERIFY(fakeFolder.currentRemoteState().find("B/new2"));
+
+        fakeFolder.serverErrorPaths().clear();
+        fakeFolder.syncJournal().wipeErrorBlacklist();
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testSingleItemSyncNextToRunningSync()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        QSignalSpy folderSyncFinished(&fakeFolder.syncEngine(), &SyncEngine::finished);
+
+        fakeFolder.remoteModifier().insert("B/b3");
+        fakeFolder.scheduleSync();
+        fakeFolder.execUntilBeforePropagation();
+
+        // Changed after the sync of the whole folder discovered the remote files
+        fakeFolder.remoteModifier().insert("edit");
+        SyncJournalErrorBlacklistRecord entry;
+        entry._file = QStringLiteral("C/unrelated");
+        entry._errorString = QStringLiteral("error");
+        entry._retryCount = 1;
+        entry._lastTryEtag = "etag";
+        entry._lastTryTime = Utility::qDateTimeToTime_t(QDateTime::currentDateTimeUtc());
+        entry._ignoreDuration = 3600;
+        fakeFolder.syncJournal().setErrorBlacklistEntry(entry);
+
+        SyncEngine singleItemEngine(fakeFolder.account(), fakeFolder.localPath(), fakeFolder.syncEngine().syncOptions(), {}, &fakeFolder.syncJournal());
+        singleItemEngine.excludedFiles().addManualExclude(QStringLiteral("]*.~*"));
+        singleItemEngine.setSingleItemDiscoveryOptions({QStringLiteral("/"), QStringLiteral("edit"), {}});
+        singleItemEngine.setLocalDiscoveryOptions(LocalDiscoveryStyle::FilesystemOnly);
+        QSignalSpy singleItemSyncFinished(&singleItemEngine, &SyncEngine::finished);
+        QMetaObject::invokeMethod(&singleItemEngine, "startSync", Qt::QueuedConnection);
+        QVERIFY(singleItemSyncFinished.wait());
+        QVERIFY(singleItemSyncFinished.first().first().toBool());
+        QVERIFY(fakeFolder.currentLocalState().find("edit"));
+
+        // The single item sync leaves what it did not see alone
+        QVERIFY(fakeFolder.syncJournal().errorBlacklistEntry("C/unrelated").isValid());
+
+        if (folderSyncFinished.isEmpty()) {
+            QVERIFY(folderSyncFinished.wait());
+        }
+        QVERIFY(folderSyncFinished.first().first().toBool());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testSingleItemSyncWaitsForFolderSyncOfSameFile()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.remoteModifier().insert("edit");
+        QVERIFY(fakeFolder.syncOnce());
+
+        int nGET = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::GetOperation && request.url().path().endsWith(QStringLiteral("/edit"))) {
+                ++nGET;
+            }
+            return nullptr;
+        });
+
+        QSignalSpy folderSyncFinished(&fakeFolder.syncEngine(), &SyncEngine::finished);
+        fakeFolder.remoteModifier().appendByte("edit");
+        fakeFolder.scheduleSync();
+        fakeFolder.execUntilBeforePropagation();
+
+        SyncEngine singleItemEngine(fakeFolder.account(), fakeFolder.localPath(), fakeFolder.syncEngine().syncOptions(), {}, &fakeFolder.syncJournal());
+        singleItemEngine.excludedFiles().addManualExclude(QStringLiteral("]*.~*"));
+        singleItemEngine.setSingleItemDiscoveryOptions({QStringLiteral("/"), QStringLiteral("edit"), {}});
+        singleItemEngine.setLocalDiscoveryOptions(LocalDiscoveryStyle::FilesystemOnly);
+        QSignalSpy singleItemSyncFinished(&singleItemEngine, &SyncEngine::finished);
+        QMetaObject::invokeMethod(&singleItemEngine, "startSync", Qt::QueuedConnection);
+
+        if (folderSyncFinished.isEmpty()) {
+            QVERIFY(folderSyncFinished.wait());
+        }
+        QVERIFY(folderSyncFinished.first().first().toBool());
+        if (singleItemSyncFinished.isEmpty()) {
+            QVERIFY(singleItemSyncFinished.wait());
+        }
+        QCOMPARE(singleItemSyncFinished.size(), 1);
+        QVERIFY(singleItemSyncFinished.first().first().toBool());
+
+        // Only the sync of the folder downloaded it
+        QCOMPARE(nGET, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testFolderSyncSkipsFileOfRunningSingleItemSync()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.remoteModifier().insert("edit");
+        QVERIFY(fakeFolder.syncOnce());
+
+        QObject parent;
+        int nGET = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::GetOperation && request.url().path().endsWith(QStringLiteral("/edit"))) {
+                ++nGET;
+                return new FakeHangingReply(op, request, &parent);
+            }
+            return nullptr;
+        });
+
+        fakeFolder.remoteModifier().appendByte("edit");
+        fakeFolder.remoteModifier().appendByte("A/a1");
+
+        SyncEngine singleItemEngine(fakeFolder.account(), fakeFolder.localPath(), fakeFolder.syncEngine().syncOptions(), {}, &fakeFolder.syncJournal());
+        singleItemEngine.excludedFiles().addManualExclude(QStringLiteral("]*.~*"));
+        singleItemEngine.setSingleItemDiscoveryOptions({QStringLiteral("/"), QStringLiteral("edit"), {}});
+        singleItemEngine.setLocalDiscoveryOptions(LocalDiscoveryStyle::FilesystemOnly);
+        QSignalSpy singleItemSyncFinished(&singleItemEngine, &SyncEngine::finished);
+        QMetaObject::invokeMethod(&singleItemEngine, "startSync", Qt::QueuedConnection);
+        QTRY_COMPARE(nGET, 1);
+
+        // The download of the single item sync is still running
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGET, 1);
+        QCOMPARE(fakeFolder.currentLocalState().find("A/a1")->contentSize, fakeFolder.currentRemoteState().find("A/a1")->contentSize);
+        QVERIFY(fakeFolder.currentLocalState() != fakeFolder.currentRemoteState());
+
+        singleItemEngine.abort();
+        if (singleItemSyncFinished.isEmpty()) {
+            QVERIFY(singleItemSyncFinished.wait());
+        }
+        QVERIFY(!singleItemSyncFinished.first().first().toBool());
+
+        fakeFolder.setServerOverride(nullptr);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
 };
 
 QTEST_GUILESS_MAIN(TestSyncEngine)
@@ -7,6 +7,8 @@
 #include <QtTest>
 
 #include "syncfileitem.h"
+#include "completedsyncitem.h"
+#include "progressdispatcher.h"
 
 using namespace OCC;
 
@@ -63,6 +65,98 @@ private slots:
         QVERIFY(!(b < b));
         QVERIFY(!(c < c));
     }
+
+    void testSortKey_data() {
+        testComparator_data();
+    }
+
+    void testSortKey() {
+        QFETCH( SyncFileItem , a );
+        QFETCH( SyncFileItem , b );
+        QFETCH( SyncFileItem , c );
+
+        const auto keyA = pathSortKey(a.destination());
+        const auto keyB = pathSortKey(b.destination());
+        const auto keyC = pathSortKey(c.destination());
+        QVERIFY(keyA < keyB);
+        QVERIFY(keyB < keyC);
+        QVERIFY(keyA < keyC);
+        QVERIFY(!(keyA < keyA));
+    }
+
+    void testSortSyncFileItems() {
+        const QStringList paths = {
+            "foo-bar", "foo", "foo/bar", "foo/bar/baz", "foo.txt", "foo bar", "Foo",
+            "\u00e9t\u00e9", "\u00e9t\u00e9/x", "a\001b", "a/b", "a!b", "a", "", "z\U0001F600", "z\uFFFD"
+        };
+        SyncFileItemVector items;
+        for (const auto &path : paths) {
+            auto item = SyncFileItemPtr::create();
+            item->_file = path;
+            items.append(item);
+        }
+        auto renamed = SyncFileItemPtr::create();
+        renamed->_file = "zzz/source";
+        renamed->_renameTarget = "foo/bar/0";
+        items.append(renamed);
+
+        auto expected = items;
+        std::sort(expected.begin(), expected.end());
+        sortSyncFileItems(items);
+        QVERIFY(std::is_sorted(items.cbegin(), items.cend()));
+        for (int i = 0; i < items.size(); ++i) {
+            QCOMPARE(items.at(i)->destination(), expected.at(i)->destination());
+        }
+
+        // Equal destinations keep the order of sorted insertion: the last one first
+        auto first = SyncFileItemPtr::create();
+        first->_file = "same";
+        auto second = SyncFileItemPtr::create();
+        second->_file = "same";
+        SyncFileItemVector duplicates = {first, second};
+        sortSyncFileItems(duplicates);
+        QCOMPARE(duplicates.at(0), second);
+        QCOMPARE(duplicates.at(1), first);
+    }
+
+    void testCompletedSyncItem()
+    {
+        SyncFileItem item;
+        item._file = QStringLiteral("folder/file.txt");
+        item._originalFile = QStringLiteral("folder/file.txt");
+        item._instruction = CSYNC_INSTRUCTION_NEW;
+        item._direction = SyncFileItem::Up;
+        item._type = ItemTypeFile;
+        item._status = SyncFileItem::SoftError;
+        item._httpErrorCode = 507;
+        item._errorString = QStringLiteral("quota");
+        item._etag = "etag";
+        item._size = 42;
+
+        const auto completed = CompletedSyncItem::create(item, ErrorCategory::InsufficientRemoteStorage);
+        QCOMPARE(completed->file(), item._file);
+        QCOMPARE(completed->destination(), item._file);
+        QCOMPARE(completed->originalFile(), item._originalFile);
+        QCOMPARE(completed->instruction(), SyncInstructions(CSYNC_INSTRUCTION_NEW));
+        QCOMPARE(completed->direction(), SyncFileItem::Up);
+        QCOMPARE(completed->type(), ItemType(ItemTypeFile));
+        QCOMPARE(completed->status(), SyncFileItem::SoftError);
+        QCOMPARE(completed->errorCategory(), ErrorCategory::InsufficientRemoteStorage);
+        QCOMPARE(completed->httpErrorCode(), quint16(507));
+        QCOMPARE(completed->etag(), QByteArray("etag"));
+        QCOMPARE(completed->size(), qint64(42));
+        QVERIFY(completed->hasErrorStatus());
+        QVERIFY(!completed->isDirectory());
+
+        // equal paths share their storage
+        QCOMPARE(completed->originalFile().constData(), completed->file().constData());
+
+        // the record is a snapshot: later changes to the item are not visible
+        item._file = QStringLiteral("other");
+        item._renameTarget = QStringLiteral("renamed");
+        QCOMPARE(completed->file(), QStringLiteral("folder/file.txt"));
+        QVERIFY(completed->renameTarget().isEmpty());
+    }
 };
 
 QTEST_APPLESS_MAIN(TestSyncFileItem)
@@ -48,6 +48,16 @@ public:
         }
         return false;
     }
+
+    [[nodiscard]] int emissionCount(const QString &relativePath) const {
+        QFileInfo file(_syncEngine.localPath(), relativePath);
+        int count = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (QFileInfo(at(i)[0].toString()) == file)
+                ++count;
+        }
+        return count;
+    }
 };
 
 class TestSyncFileStatusTracker : public QObject
@@ -429,6 +439,32 @@ private slots:
         QCOMPARE(statusSpy.statusOf("C/c1"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
     }
 
+    // Many errors in the same directory must not push the parent status
+    // once per error, the changes of a batch are coalesced.
+    void parentStatusEmittedOncePerBatch() {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        for (int i = 0; i < 5; ++i) {
+            const auto path = QStringLiteral("B/e%1").arg(i);
+            fakeFolder.localModifier().insert(path);
+            fakeFolder.serverErrorPaths().append(path);
+        }
+        QVERIFY(!fakeFolder.syncOnce());
+        fakeFolder.serverErrorPaths().clear();
+
+        // The errors are blacklisted for the next sync
+        StatusPushSpy statusSpy(fakeFolder.syncEngine());
+        fakeFolder.scheduleSync();
+        fakeFolder.execUntilBeforePropagation();
+        verifyThatPushMatchesPull(fakeFolder, statusSpy);
+        QCOMPARE(statusSpy.statusOf("B/e0"), SyncFileStatus(SyncFileStatus::StatusError));
+        QCOMPARE(statusSpy.statusOf("B/e4"), SyncFileStatus(SyncFileStatus::StatusError));
+        QCOMPARE(statusSpy.statusOf("B"), SyncFileStatus(SyncFileStatus::StatusWarning));
+        QCOMPARE(statusSpy.emissionCount("B"), 1);
+        QCOMPARE(statusSpy.emissionCount("B/e0"), 1);
+        QVERIFY(statusSpy.statusEmittedBefore("B/e0", "B"));
+        fakeFolder.execUntilFinished();
+    }
+
     void sharedStatus() {
         SyncFileStatus sharedUpToDateStatus(SyncFileStatus::StatusUpToDate);
         sharedUpToDateStatus.setShared(true);
@@ -8,8 +8,10 @@
 
 #include <sqlite3.h>
 
+#include "common/ownsql.h"
 #include "common/syncjournaldb.h"
 #include "common/syncjournalfilerecord.h"
+#include "common/syncjournalreader.h"
 
 using namespace OCC;
 
@@ -168,6 +170,87 @@ private slots:
         QVERIFY(!wipedRecord._valid);
     }
 
+    void testErrorBlacklist()
+    {
+        QCOMPARE(_db.wipeErrorBlacklist(), 0);
+        QVERIFY(!_db.errorBlacklistEntry("nonexistent").isValid());
+
+        const auto makeEntry = [](const QString &file, SyncJournalErrorBlacklistRecord::Category category) {
+            SyncJournalErrorBlacklistRecord entry;
+            entry._file = file;
+            entry._errorString = "error";
+            entry._retryCount = 3;
+            entry._lastTryEtag = "etag";
+            entry._lastTryTime = 1000;
+            entry._ignoreDuration = 60;
+            entry._errorCategory = category;
+            return entry;
+        };
+        for (int i = 0; i < 10; ++i) {
+            _db.setErrorBlacklistEntry(makeEntry(QStringLiteral("dir/file%1").arg(i), SyncJournalErrorBlacklistRecord::Normal));
+        }
+        _db.setErrorBlacklistEntry(makeEntry("insufficient", SyncJournalErrorBlacklistRecord::InsufficientRemoteStorage));
+
+        auto entry = _db.errorBlacklistEntry("dir/file3");
+        QVERIFY(entry.isValid());
+        QCOMPARE(entry._file, QStringLiteral("dir/file3"));
+        QCOMPARE(entry._retryCount, 3);
+        QCOMPARE(entry._lastTryEtag, QByteArray("etag"));
+
+        // written after the blacklist was loaded
+        auto updated = makeEntry("dir/file3", SyncJournalErrorBlacklistRecord::Normal);
+        updated._retryCount = 4;
+        _db.setErrorBlacklistEntry(updated);
+        _db.setErrorBlacklistEntry(makeEntry("dir/new", SyncJournalErrorBlacklistRecord::Normal));
+        QCOMPARE(_db.errorBlacklistEntry("dir/file3")._retryCount, 4);
+        QVERIFY(_db.errorBlacklistEntry("dir/new").isValid());
+
+        _db.wipeErrorBlacklistEntry("dir/new");
+        QVERIFY(!_db.errorBlacklistEntry("dir/new").isValid());
+        _db.wipeErrorBlacklistCategory(SyncJournalErrorBlacklistRecord::InsufficientRemoteStorage);
+        QVERIFY(!_db.errorBlacklistEntry("insufficient").isValid());
+        QCOMPARE(_db.errorBlackListEntryCount(), 10);
+
+        QVERIFY(_db.deleteStaleErrorBlacklistEntries({"dir/file1", "dir/file3"}));
+        QCOMPARE(_db.errorBlackListEntryCount(), 2);
+        QVERIFY(!_db.errorBlacklistEntry("dir/file0").isValid());
+        QVERIFY(_db.errorBlacklistEntry("dir/file1").isValid());
+
+        // the database and the loaded blacklist agree
+        _db.close();
+        QCOMPARE(_db.errorBlacklistEntry("dir/file3")._retryCount, 4);
+        QVERIFY(!_db.errorBlacklistEntry("dir/file0").isValid());
+
+        // paths that only differ by case are separate rows, even where lookups fold the case
+        auto lowerCase = makeEntry("case/file", SyncJournalErrorBlacklistRecord::Normal);
+        lowerCase._errorString = "lower";
+        _db.setErrorBlacklistEntry(makeEntry("case/File", SyncJournalErrorBlacklistRecord::Normal));
+        _db.setErrorBlacklistEntry(lowerCase);
+        QCOMPARE(_db.errorBlackListEntryCount(), 4);
+        QVERIFY(_db.deleteStaleErrorBlacklistEntries({"dir/file1", "dir/file3", "case/file"}));
+        QCOMPARE(_db.errorBlackListEntryCount(), 3);
+        QCOMPARE(_db.errorBlacklistEntry("case/file")._errorString, QStringLiteral("lower"));
+        QVERIFY(_db.deleteStaleErrorBlacklistEntries({"dir/file1", "dir/file3"}));
+        QCOMPARE(_db.errorBlackListEntryCount(), 2);
+        QVERIFY(!_db.errorBlacklistEntry("case/file").isValid());
+
+        QVERIFY(_db.deleteStaleErrorBlacklistEntries({}));
+        QCOMPARE(_db.errorBlackListEntryCount(), 0);
+        QVERIFY(!_db.errorBlacklistEntry("dir/file1").isValid());
+
+        // entries another process wrote are picked up once the blacklist is reloaded
+        _db.commit(QStringLiteral("before other writer"), false);
+        {
+            SyncJournalDb otherDb(_db.databaseFilePath());
+            otherDb.setErrorBlacklistEntry(makeEntry("other/file", SyncJournalErrorBlacklistRecord::Normal));
+            otherDb.close();
+        }
+        _db.reloadErrorBlacklistOnNextUse();
+        QVERIFY(_db.errorBlacklistEntry("other/file").isValid());
+        _db.wipeErrorBlacklistEntry("other/file");
+        QCOMPARE(_db.errorBlackListEntryCount(), 0);
+    }
+
     void testNumericId()
     {
         SyncJournalFileRecord record;
@@ -203,6 +286,134 @@ private slots:
         QVERIFY(!_db.conflictRecord(record.path).isValid());
     }
 
+    void testCaseClashConflictRecords()
+    {
+        QVERIFY(_db.caseClashConflictRecords().isEmpty());
+
+        ConflictRecord record;
+        record.path = "A/file (case clash from abc)";
+        record.baseFileId = "def";
+        record.baseModtime = 1234;
+        record.baseEtag = "ghi";
+        record.initialBasePath = "A/File";
+        _db.setCaseConflictRecord(record);
+
+        const auto records = _db.caseClashConflictRecords();
+        QCOMPARE(records.size(), 1);
+        QCOMPARE(records.first().path, record.path);
+        QCOMPARE(records.first().baseFileId, record.baseFileId);
+        QCOMPARE(records.first().baseModtime, record.baseModtime);
+        QCOMPARE(records.first().baseEtag, record.baseEtag);
+        QCOMPARE(records.first().initialBasePath, record.initialBasePath);
+
+        _db.deleteCaseClashConflictByPathRecord(QString::fromUtf8(record.path));
+        QVERIFY(_db.caseClashConflictRecords().isEmpty());
+    }
+
+    void testRemotePermissions()
+    {
+        const auto all = RemotePermissions::fromServerString(QStringLiteral("WDNVCKRSMm"));
+        QCOMPARE(all.toDbValue(), QByteArray("WDNVCKRSMm"));
+        QCOMPARE(RemotePermissions::fromDbIntValue(all.toDbIntValue()), all);
+        const auto empty = RemotePermissions::fromServerString(QString());
+        QVERIFY(!empty.isNull());
+        QCOMPARE(RemotePermissions::fromDbIntValue(empty.toDbIntValue()), empty);
+        QVERIFY(RemotePermissions::fromDbIntValue(RemotePermissions().toDbIntValue()).isNull());
+        // Unknown letters are ignored
+        QCOMPARE(RemotePermissions::fromServerString(QStringLiteral("GWxD\u00e9")).toDbValue(), QByteArray("WD"));
+
+        SyncJournalFileRecord record;
+        record._path = "perm";
+        record._type = ItemTypeFile;
+        record._etag = "etag";
+        record._remotePerm = RemotePermissions::fromServerString(QStringLiteral("DNm"));
+        QVERIFY(_db.setFileRecord(record));
+        SyncJournalFileRecord storedRecord;
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("perm"), &storedRecord));
+        QCOMPARE(storedRecord._remotePerm, record._remotePerm);
+        QVERIFY(_db.deleteFileRecord("perm"));
+    }
+
+    void testRemotePermissionsMigration()
+    {
+        // A journal from before the permissions were stored as bits
+        const auto dbPath = _tempDir.path() + "/oldpermissions.db";
+        const QVector<QPair<QByteArray, QByteArray>> rows = {{"all", "WDNVCKRSMm"}, {"some", "DNm"}, {"empty", " "}, {"null", ""}};
+        {
+            SqlDatabase oldDb;
+            QVERIFY(oldDb.openOrCreateReadWrite(dbPath));
+            SqlQuery query(oldDb);
+            QCOMPARE(query.prepare("CREATE TABLE metadata(phash INTEGER(8), pathlen INTEGER, path VARCHAR(4096), inode INTEGER, uid INTEGER,"
+                                   " gid INTEGER, mode INTEGER, modtime INTEGER(8), type INTEGER, md5 VARCHAR(32), remotePerm VARCHAR(128),"
+                                   " PRIMARY KEY(phash));"), 0);
+            QVERIFY(query.exec());
+            for (const auto &row : rows) {
+                QCOMPARE(query.prepare("INSERT INTO metadata (phash, pathlen, path, type, md5, remotePerm) VALUES (?1, ?2, ?3, 0, 'etag', ?4);"), 0);
+                query.bindValue(1, SyncJournalDb::getPHash(row.first));
+                query.bindValue(2, row.first.size());
+                query.bindValue(3, row.first);
+                query.bindValue(4, row.second);
+                QVERIFY(query.exec());
+            }
+            oldDb.close();
+        }
+
+        SyncJournalDb db(dbPath);
+        for (const auto &row : rows) {
+            SyncJournalFileRecord record;
+            QVERIFY(db.getFileRecord(row.first, &record));
+            QVERIFY(record.isValid());
+            QCOMPARE(record._remotePerm, RemotePermissions::fromDbValue(row.second));
+        }
+
+        // Older clients still find the letters
+        SyncJournalFileRecord record;
+        QVERIFY(db.getFileRecord(QByteArrayLiteral("some"), &record));
+        record._remotePerm = RemotePermissions::fromServerString(QStringLiteral("WDR"));
+        QVERIFY(db.setFileRecord(record));
+        db.close();
+
+        SqlDatabase oldDb;
+        QVERIFY(oldDb.openOrCreateReadWrite(dbPath));
+        SqlQuery query(oldDb);
+        QCOMPARE(query.prepare("SELECT remotePerm FROM metadata WHERE path = 'some';"), 0);
+        QVERIFY(query.exec());
+        QVERIFY(query.next().hasData);
+        QCOMPARE(query.baValue(0), QByteArray("WDR"));
+
+        // An older client replaces the row without filling remotePermissions
+        QCOMPARE(query.prepare("INSERT OR REPLACE INTO metadata (phash, pathlen, path, type, md5, remotePerm) VALUES (?1, ?2, ?3, 0, 'etag', ?4);"), 0);
+        query.bindValue(1, SyncJournalDb::getPHash("some"));
+        query.bindValue(2, 4);
+        query.bindValue(3, QByteArrayLiteral("some"));
+        query.bindValue(4, QByteArrayLiteral("CK"));
+        QVERIFY(query.exec());
+        oldDb.close();
+
+        SyncJournalDb upgradedDb(dbPath);
+        QVERIFY(upgradedDb.getFileRecord(QByteArrayLiteral("some"), &record));
+        QVERIFY(record.isValid());
+        QCOMPARE(record._remotePerm, RemotePermissions::fromDbValue("CK"));
+        upgradedDb.close();
+    }
+
+    void testE2eMetadataCache()
+    {
+        QVERIFY(_db.e2eMetadataCache("folder", "etag1").isEmpty());
+
+        _db.setE2eMetadataCache("folder", "etag1", "data1");
+        QCOMPARE(_db.e2eMetadataCache("folder", "etag1"), QByteArray("data1"));
+        // Another etag means the folder changed since
+        QVERIFY(_db.e2eMetadataCache("folder", "etag2").isEmpty());
+
+        _db.setE2eMetadataCache("folder", "etag2", "data2");
+        QVERIFY(_db.e2eMetadataCache("folder", "etag1").isEmpty());
+        QCOMPARE(_db.e2eMetadataCache("folder", "etag2"), QByteArray("data2"));
+
+        _db.deleteE2eMetadataCache("folder");
+        QVERIFY(_db.e2eMetadataCache("folder", "etag2").isEmpty());
+    }
+
     void testAvoidReadFromDbOnNextSync()
     {
         auto invalidEtag = QByteArray("_invalid_");
@@ -269,6 +480,48 @@ private slots:
         QCOMPARE(getEtag("foodir/sub"), initialEtag);
     }
 
+    void testQueryStatistics()
+    {
+        const auto findStatement = [&](const QByteArray &sql) {
+            const auto statistics = _db.queryStatistics();
+            const auto it = std::find_if(statistics.cbegin(), statistics.cend(), [&](const PreparedSqlQueryManager::Statistics &statement) {
+                return statement.sql == sql;
+            });
+            return it == statistics.cend() ? SqlQueryStatistics{} : it->counters;
+        };
+
+        // Statements without a key are cached by their sql text
+        _db.close();
+        const auto before = findStatement("DELETE FROM blacklist WHERE path=?1");
+        _db.wipeErrorBlacklistEntry("stats/a");
+        _db.wipeErrorBlacklistEntry("stats/b");
+        _db.wipeErrorBlacklistEntry("stats/c");
+        auto counters = findStatement("DELETE FROM blacklist WHERE path=?1");
+        QCOMPARE(counters.prepares, before.prepares + 1);
+        QCOMPARE(counters.reuses, before.reuses + 2);
+        QCOMPARE(counters.executions, before.executions + 3);
+
+        SyncJournalFileRecord record;
+        record._path = "stats/file";
+        record._remotePerm = RemotePermissions::fromDbValue("RW");
+        QVERIFY(_db.setFileRecord(record));
+        QMap<QByteArray, SyncJournalDb::SubtreeRecordCount> subtreeCounts;
+        QVERIFY(_db.getSubtreeRecordCounts("stats", &subtreeCounts));
+        counters = findStatement("SELECT path, type FROM metadata WHERE (path > (?1||'/') AND path < (?1||'0'))");
+        QCOMPARE(counters.executions, 1ull);
+        QCOMPARE(counters.rows, 1ull);
+        QVERIFY(_db.deleteFileRecord("stats/file"));
+
+        // Reopening the journal prepares the statements again
+        _db.close();
+        _db.wipeErrorBlacklistEntry("stats/a");
+        counters = findStatement("DELETE FROM blacklist WHERE path=?1");
+        QCOMPARE(counters.prepares, before.prepares + 2);
+        QCOMPARE(counters.executions, before.executions + 4);
+
+        QVERIFY(!_db.queryStatisticsSummary().isEmpty());
+    }
+
     void testRecursiveDelete()
     {
         auto makeEntry = [&](const QByteArray &path) {
@@ -320,6 +573,79 @@ private slots:
         QVERIFY(checkElements());
     }
 
+    void testHydrationSummary()
+    {
+        auto makeEntry = [&](const QByteArray &path, ItemType type) {
+            SyncJournalFileRecord record;
+            record._path = path;
+            record._type = type;
+            record._remotePerm = RemotePermissions::fromDbValue("RW");
+            QVERIFY(_db.setFileRecord(record));
+        };
+        auto check = [&](const QByteArray &path, bool hydrated, bool dehydrated) {
+            const auto status = _db.hasHydratedOrDehydratedFiles(path);
+            QVERIFY(status);
+            QCOMPARE(status->hasHydrated, hydrated);
+            QCOMPARE(status->hasDehydrated, dehydrated);
+        };
+
+        makeEntry("hydration", ItemTypeDirectory);
+        makeEntry("hydration/sub", ItemTypeDirectory);
+        makeEntry("hydration/sub/file", ItemTypeFile);
+        makeEntry("hydration/sub/virtual", ItemTypeVirtualFile);
+        makeEntry("hydration/empty", ItemTypeDirectory);
+        makeEntry("hydrationsibling", ItemTypeVirtualFile);
+
+        check("hydration", true, true);
+        check("hydration/sub", true, true);
+        check("hydration/sub/file", true, false);
+        check("hydration/sub/virtual", false, true);
+        check("hydration/empty", false, false);
+        check("hydration/nonexistent", false, false);
+
+        // Changes after the summaries were loaded are picked up
+        makeEntry("hydration/sub/virtual", ItemTypeFile);
+        check("hydration", true, false);
+
+        // Writing a record that was just read or written doesn't look up its previous type
+        const auto typeLookups = [&] {
+            const auto statistics = _db.queryStatistics();
+            const auto it = std::find_if(statistics.cbegin(), statistics.cend(), [](const PreparedSqlQueryManager::Statistics &statement) {
+                return statement.sql == "SELECT type FROM metadata WHERE phash=?1;";
+            });
+            return it == statistics.cend() ? 0ull : it->counters.executions;
+        };
+        const auto lookupsBefore = typeLookups();
+        SyncJournalFileRecord record;
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("hydration/sub/file"), &record));
+        record._type = ItemTypeVirtualFile;
+        QVERIFY(_db.setFileRecord(record));
+        check("hydration/sub", true, true);
+        record._type = ItemTypeFile;
+        QVERIFY(_db.setFileRecord(record));
+        check("hydration/sub", true, false);
+        QCOMPARE(typeLookups(), lookupsBefore);
+        makeEntry("hydration/empty/virtual", ItemTypeVirtualFileDownload);
+        check("hydration/empty", false, true);
+        check("hydration", true, true);
+
+        QVERIFY(_db.deleteFileRecord("hydration/empty/virtual"));
+        check("hydration/empty", false, false);
+        check("hydration", true, false);
+
+        QVERIFY(_db.deleteFileRecord("hydration/sub", true));
+        check("hydration/sub", false, false);
+        check("hydration", false, false);
+        check("hydrationsibling", false, true);
+
+        // Reloading gives the same answers
+        _db.close();
+        check("hydration", false, false);
+        check("hydrationsibling", false, true);
+        QVERIFY(_db.deleteFileRecord("hydration", true));
+        QVERIFY(_db.deleteFileRecord("hydrationsibling"));
+    }
+
     void testPinState()
     {
         auto make = [&](const QByteArray &path, PinState state) {
@@ -422,6 +748,20 @@ private slots:
         QCOMPARE(getRecursive("local/local/local"), PinState::AlwaysLocal);
         QCOMPARE(getRecursive("local/local/local/local"), PinState::AlwaysLocal);
 
+        // Batch lookups agree with the single ones
+        const QVector<QByteArray> batch = {"", "online/local/inherit", "inherit/online/nonexistent", "nonexistent"};
+        const auto batchStates = _db.internalPinStates().effectiveForPathsRecursive(batch);
+        QVERIFY(batchStates);
+        QCOMPARE(batchStates->size(), batch.size());
+        for (const auto &path : batch) {
+            QCOMPARE(batchStates->value(path), getRecursive(path));
+        }
+
+        // The lookups survive reopening the journal
+        _db.close();
+        QCOMPARE(get("online/local/inherit"), PinState::AlwaysLocal);
+        QCOMPARE(getRecursive("online/local"), PinState::Inherited);
+
         // Check changing the root pin state
         make("", PinState::OnlineOnly);
         QCOMPARE(get("local"), PinState::AlwaysLocal);
@@ -453,6 +793,29 @@ private slots:
         QCOMPARE(list->size(), 0);
     }
 
+    void testJournalReader()
+    {
+        SyncJournalFileRecord record;
+        record._path = "reader/file";
+        record._inode = 42;
+        record._type = ItemTypeFile;
+        record._etag = "readeretag";
+        QVERIFY(_db.setFileRecord(record));
+
+        SyncJournalReader reader(&_db);
+        const auto storedRecord = reader.fileRecord("reader/file").result();
+        QVERIFY(storedRecord.isValid());
+        QCOMPARE(storedRecord._inode, 42ull);
+        QCOMPARE(storedRecord._etag, QByteArray("readeretag"));
+        QVERIFY(!reader.fileRecord("reader/nonexistent").result().isValid());
+
+        // Lookups run in the order they were started
+        auto first = reader.run([](SyncJournalDb &journal) { return journal.deleteFileRecord("reader/file"); });
+        auto second = reader.fileRecord("reader/file");
+        QVERIFY(first.result());
+        QVERIFY(!second.result().isValid());
+    }
+
 private:
     SyncJournalDb _db;
 };
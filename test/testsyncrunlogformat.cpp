@@ -0,0 +1,138 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "config.h"
+#include "completedsyncitem.h"
+#include "progressdispatcher.h"
+#include "syncrunlogformat.h"
+
+using namespace OCC;
+
+class TestSyncRunLogFormat : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testResponseTime_data()
+    {
+        QTest::addColumn<QByteArray>("header");
+        QTest::addColumn<QString>("expected");
+
+        QTest::newRow("http date") << QByteArray("Wed, 21 Oct 2015 07:28:00 GMT") << QStringLiteral("07:28:00");
+        QTest::newRow("short") << QByteArray("07:28") << QStringLiteral("07:28");
+        QTest::newRow("no time") << QByteArray("Wed, 21 Oct 2015") << QStringLiteral("Wed, 21 Oct 2015");
+        QTest::newRow("empty") << QByteArray() << QString();
+    }
+
+    void testResponseTime()
+    {
+        QFETCH(QByteArray, header);
+        QFETCH(QString, expected);
+        QCOMPARE(SyncRunLogFormat::responseTime(header), expected);
+    }
+
+    void testItemText()
+    {
+        SyncFileItem item;
+        item._file = QStringLiteral("A/a1");
+        item._renameTarget = QStringLiteral("A/a2");
+        item._instruction = CSYNC_INSTRUCTION_RENAME;
+        item._direction = SyncFileItem::Up;
+        item._status = SyncFileItem::Success;
+        item._responseTimeStamp = "Wed, 21 Oct 2015 07:28:00 GMT";
+        item._modtime = 1000;
+        item._etag = "etag";
+        item._size = 12;
+        item._fileId = "id";
+        item._requestId = "req";
+
+        const auto completed = CompletedSyncItem::create(item, ErrorCategory::NoError);
+        QVERIFY(SyncRunLogFormat::shouldLog(*completed));
+        QCOMPARE(SyncRunLogFormat::toText(SyncRunLogFormat::itemRecord(*completed)),
+            QStringLiteral("07:28:00||A/a1 -> A/a2|%1|1|1000|etag|12|id|%2||0|0|0|req|\n")
+                .arg(int(CSYNC_INSTRUCTION_RENAME))
+                .arg(int(SyncFileItem::Success)));
+
+        item._direction = SyncFileItem::None;
+        QVERIFY(!SyncRunLogFormat::shouldLog(*CompletedSyncItem::create(item, ErrorCategory::NoError)));
+    }
+
+    void testBinaryRoundTrip()
+    {
+        SyncFileItem item;
+        item._file = QStringLiteral("folder/ünïcode.txt");
+        item._instruction = CSYNC_INSTRUCTION_NEW;
+        item._direction = SyncFileItem::Down;
+        item._status = SyncFileItem::NormalError;
+        item._errorString = QStringLiteral("Server replied with an error");
+        item._httpErrorCode = 500;
+
+        QVector<SyncRunLogFormat::Record> records;
+        SyncRunLogFormat::Record header;
+        header.type = SyncRunLogFormat::RecordType::Header;
+        header.text = QStringLiteral("/home/user/Nextcloud/");
+        records.append(header);
+        SyncRunLogFormat::Record started;
+        started.type = SyncRunLogFormat::RecordType::SyncStarted;
+        started.timestamp = QDateTime::fromSecsSinceEpoch(1000000000, Qt::UTC);
+        records.append(started);
+        records.append(SyncRunLogFormat::itemRecord(*CompletedSyncItem::create(item, ErrorCategory::GenericError)));
+        SyncRunLogFormat::Record lap;
+        lap.type = SyncRunLogFormat::RecordType::Lap;
+        lap.text = QStringLiteral("Propagation starts");
+        lap.timestamp = started.timestamp.addSecs(1);
+        lap.lapMsec = 1000;
+        lap.totalMsec = 1000;
+        records.append(lap);
+
+        QByteArray data;
+        {
+            QDataStream out(&data, QIODevice::WriteOnly);
+            out.setVersion(SyncRunLogFormat::streamVersion);
+            for (const auto &record : records) {
+                SyncRunLogFormat::writeRecord(out, record);
+            }
+        }
+
+        QDataStream in(data);
+        in.setVersion(SyncRunLogFormat::streamVersion);
+        for (const auto &expected : records) {
+            SyncRunLogFormat::Record record;
+            QVERIFY(SyncRunLogFormat::readRecord(in, record));
+            QCOMPARE(SyncRunLogFormat::toText(record), SyncRunLogFormat::toText(expected));
+        }
+        QVERIFY(in.atEnd());
+    }
+
+    void testCompressedLog()
+    {
+#ifndef ZLIB_FOUND
+        QVERIFY(!SyncRunLogFormat::isBinaryLogSupported());
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        QVERIFY(SyncRunLogFormat::isBinaryLogSupported());
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const auto fileName = dir.filePath(QStringLiteral("folder_sync.log.bin.gz"));
+
+        const auto first = QByteArray(SyncRunLogFormat::binaryMagic) + QByteArray(1000, 'a');
+        const auto second = QByteArray(1000, 'b');
+        QVERIFY(SyncRunLogFormat::appendToBinaryLog(fileName, first));
+        QVERIFY(SyncRunLogFormat::appendToBinaryLog(fileName, second));
+
+        QVERIFY(QFileInfo(fileName).size() < first.size() + second.size());
+        QCOMPARE(SyncRunLogFormat::readBinaryLog(fileName), first + second);
+        QCOMPARE(SyncRunLogFormat::readBinaryLog(fileName, 16), first.left(16));
+        QVERIFY(SyncRunLogFormat::readBinaryLog(dir.filePath(QStringLiteral("missing"))).isEmpty());
+#endif
+    }
+};
+
+QTEST_APPLESS_MAIN(TestSyncRunLogFormat)
+#include "testsyncrunlogformat.moc"
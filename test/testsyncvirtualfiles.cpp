@@ -1373,6 +1373,12 @@ private slots:
         QCOMPARE(*vfs->availability("unspec"), VfsItemAvailability::AllDehydrated);
         QCOMPARE(*vfs->availability("unspec/file1" DVSUFFIX), VfsItemAvailability::AllDehydrated);
 
+        // Selections of several items, as for the context menu
+        QCOMPARE(*vfs->combinedAvailability({"local", "local/file1"}), VfsItemAvailability::AlwaysLocal);
+        QCOMPARE(*vfs->combinedAvailability({"online", "unspec", "nonexistent"}), VfsItemAvailability::AllDehydrated);
+        QCOMPARE(*vfs->combinedAvailability({"local", "online"}), VfsItemAvailability::Mixed);
+        QVERIFY(!vfs->combinedAvailability({"nonexistent"}));
+
         // Subitem pin states can ruin "pure" availabilities
         setPin("local/sub", PinState::OnlineOnly);
         QCOMPARE(*vfs->availability("local"), VfsItemAvailability::AllHydrated);
@@ -0,0 +1,234 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "config.h"
+#include "syncenginetestutils.h"
+#include "transfercompression.h"
+
+#include <QRandomGenerator>
+
+using namespace OCC;
+
+namespace {
+
+QByteArray textData(int size)
+{
+    QByteArray data;
+    int line = 0;
+    while (data.size() < size) {
+        data += "id;name;amount;comment\n" + QByteArray::number(line) + ";entry " + QByteArray::number(line % 17) + ";42.00;nothing to see\n";
+        ++line;
+    }
+    data.truncate(size);
+    return data;
+}
+
+QByteArray randomData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    QRandomGenerator generator(42);
+    for (auto &byte : data) {
+        byte = static_cast<char>(generator.bounded(256));
+    }
+    return data;
+}
+
+}
+
+class TestTransferCompression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        const auto text = textData(100000);
+        const auto compressed = TransferCompression::gzipCompress(text);
+        QVERIFY(!compressed.isEmpty());
+        QVERIFY(compressed.size() < text.size() / 4);
+        QCOMPARE(TransferCompression::gzipDecompress(compressed), text);
+
+        const auto random = randomData(100000);
+        QCOMPARE(TransferCompression::gzipDecompress(TransferCompression::gzipCompress(random)), random);
+
+        QVERIFY(TransferCompression::gzipDecompress("not gzip at all").isEmpty());
+        QVERIFY(TransferCompression::gzipDecompress(compressed.left(compressed.size() / 2)).isEmpty());
+#endif
+    }
+
+    void testIsCompressible()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        QVERIFY(TransferCompression::isCompressible(textData(100000)));
+        QVERIFY(!TransferCompression::isCompressible(randomData(100000)));
+        // too small to be worth it
+        QVERIFY(!TransferCompression::isCompressible(textData(1000)));
+#endif
+    }
+
+    void testMayCompress()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        QVERIFY(TransferCompression::mayCompress(QStringLiteral("A/export.csv"), 100000));
+        QVERIFY(TransferCompression::mayCompress(QStringLiteral("src/main.cpp"), 100000));
+        QVERIFY(TransferCompression::mayCompress(QStringLiteral("README"), 100000));
+        QVERIFY(!TransferCompression::mayCompress(QStringLiteral("A/export.csv"), 100));
+        QVERIFY(!TransferCompression::mayCompress(QStringLiteral("photo.JPG"), 100000));
+        QVERIFY(!TransferCompression::mayCompress(QStringLiteral("archive.zip"), 100000));
+        QVERIFY(!TransferCompression::mayCompress(QStringLiteral("movie.mp4"), 100000));
+#endif
+    }
+
+    void testCompressedUpload()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+
+        int nGzipPut = 0, nPlainPut = 0;
+        bool rejectGzip = false;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *outgoingData) -> QNetworkReply * {
+            if (op != QNetworkAccessManager::PutOperation) {
+                return nullptr;
+            }
+            if (request.rawHeader("Content-Encoding") != TransferCompression::gzipEncoding) {
+                ++nPlainPut;
+                return nullptr;
+            }
+            ++nGzipPut;
+            if (rejectGzip) {
+                return new FakeErrorReply(op, request, &parent, 415);
+            }
+            const auto payload = TransferCompression::gzipDecompress(outgoingData->readAll());
+            return new FakePutReply(fakeFolder.remoteModifier(), op, request, payload, &parent);
+        });
+
+        // Without the option nothing is compressed
+        fakeFolder.localModifier().insert("A/plain.csv", 100000, 'C');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 0);
+        QCOMPARE(nPlainPut, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._compressUploads = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        // Compressible files are sent gzip encoded, small and already compressed ones as they are
+        nGzipPut = nPlainPut = 0;
+        fakeFolder.localModifier().insert("A/export.csv", 100000, 'C');
+        fakeFolder.localModifier().insert("A/small.txt", 100, 'S');
+        fakeFolder.localModifier().insert("A/photo.jpg", 100000, 'P');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 1);
+        QCOMPARE(nPlainPut, 2);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(fakeFolder.currentRemoteState().find("A/export.csv")->size, 100000);
+
+        // A server refusing the encoding gets the plain upload, and no more gzip attempts
+        nGzipPut = nPlainPut = 0;
+        rejectGzip = true;
+        fakeFolder.localModifier().insert("B/export.csv", 100000, 'D');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 1);
+        QCOMPARE(nPlainPut, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(fakeFolder.syncEngine().account()->compressedUploadsRejected());
+
+        nGzipPut = nPlainPut = 0;
+        fakeFolder.localModifier().insert("C/export.csv", 100000, 'E');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 0);
+        QCOMPARE(nPlainPut, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+#endif
+    }
+
+    void testCompressedUploadStoredAsIs()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._compressUploads = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        // A server that ignores the Content-Encoding stores the gzip data as the file
+        int nGzipPut = 0, nPlainPut = 0;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *outgoingData) -> QNetworkReply * {
+            if (op != QNetworkAccessManager::PutOperation) {
+                return nullptr;
+            }
+            if (request.rawHeader("Content-Encoding") != TransferCompression::gzipEncoding) {
+                ++nPlainPut;
+                return nullptr;
+            }
+            ++nGzipPut;
+            return new FakePutReply(fakeFolder.remoteModifier(), op, request, outgoingData->readAll(), &parent);
+        });
+
+        // The stored size gives it away and the file is sent again as is
+        fakeFolder.localModifier().insert("A/export.csv", 100000, 'C');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 1);
+        QCOMPARE(nPlainPut, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(fakeFolder.currentRemoteState().find("A/export.csv")->size, 100000);
+        QVERIFY(fakeFolder.syncEngine().account()->compressedUploadsRejected());
+
+        // Nothing left to do
+        nGzipPut = nPlainPut = 0;
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(nGzipPut, 0);
+        QCOMPARE(nPlainPut, 0);
+#endif
+    }
+
+    void testDownloadAcceptEncoding()
+    {
+#ifndef ZLIB_FOUND
+        QSKIP("ZLIB not found.", SkipSingle);
+#else
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+
+        QMap<QString, QByteArray> acceptEncoding;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::GetOperation) {
+                acceptEncoding[request.url().path().section(QLatin1Char('/'), -1)] = request.rawHeader("Accept-Encoding");
+            }
+            return nullptr;
+        });
+
+        fakeFolder.remoteModifier().insert("A/notes.txt", 100000);
+        fakeFolder.remoteModifier().insert("A/photo.jpg", 100000);
+        fakeFolder.remoteModifier().insert("A/tiny.txt", 10);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // Compressible files leave the choice to the network stack, the others ask for identity
+        QCOMPARE(acceptEncoding.value("notes.txt"), QByteArray());
+        QCOMPARE(acceptEncoding.value("photo.jpg"), QByteArray("identity"));
+        QCOMPARE(acceptEncoding.value("tiny.txt"), QByteArray("identity"));
+#endif
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTransferCompression)
+#include "testtransfercompression.moc"
@@ -630,6 +630,81 @@ private slots:
         QVERIFY(!model->errorString().isEmpty());
     }
 
+    void testResultsInsertedTogether()
+    {
+        // make sure the model is empty
+        model->setSearchTerm(QStringLiteral(""));
+        QVERIFY(model->rowCount() == 0);
+
+        QSignalSpy searchInProgressChanged(
+            model.data(), &OCC::UnifiedSearchResultsListModel::isSearchInProgressChanged);
+        QSignalSpy rowsInserted(model.data(), &OCC::UnifiedSearchResultsListModel::rowsInserted);
+        model->setSearchTerm(QStringLiteral("together"));
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(model->isSearchInProgress());
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(!model->isSearchInProgress());
+
+        // all providers reply at about the same time, their results don't come in one insertion each
+        QVERIFY(model->rowCount() > 0);
+        QVERIFY(rowsInserted.count() > 0);
+        QVERIFY(rowsInserted.count() < fakeProvidersInitInfo.size());
+    }
+
+    void testPreviousSearchAborted()
+    {
+        // make sure the model is empty
+        model->setSearchTerm(QStringLiteral(""));
+        QVERIFY(model->rowCount() == 0);
+
+        QSignalSpy searchInProgressChanged(
+            model.data(), &OCC::UnifiedSearchResultsListModel::isSearchInProgressChanged);
+        model->setSearchTerm(QStringLiteral("abort"));
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(model->isSearchInProgress());
+
+        // typing on drops the running search, its replies must not show up
+        QSignalSpy rowsInserted(model.data(), &OCC::UnifiedSearchResultsListModel::rowsInserted);
+        model->setSearchTerm(QStringLiteral("aborted"));
+        QVERIFY(!model->isSearchInProgress());
+        QTest::qWait(searchResultsReplyDelay * 3);
+        QCOMPARE(rowsInserted.count(), 0);
+        QCOMPARE(model->rowCount(), 0);
+    }
+
+    void testCachedSearchShownRightAway()
+    {
+        // make sure the model is empty
+        model->setSearchTerm(QStringLiteral(""));
+        QVERIFY(model->rowCount() == 0);
+
+        QSignalSpy searchInProgressChanged(
+            model.data(), &OCC::UnifiedSearchResultsListModel::isSearchInProgressChanged);
+        model->setSearchTerm(QStringLiteral("again"));
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(!model->isSearchInProgress());
+        const auto numRows = model->rowCount();
+        QVERIFY(numRows > 0);
+
+        model->setSearchTerm(QStringLiteral(""));
+        QCOMPARE(model->rowCount(), 0);
+
+        // the results of the last search for the term are there before any request
+        searchInProgressChanged.clear();
+        model->setSearchTerm(QStringLiteral("again"));
+        QVERIFY(!model->isSearchInProgress());
+        QCOMPARE(model->rowCount(), numRows);
+
+        // and get replaced by the results of the new search
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(model->isSearchInProgress());
+        QCOMPARE(model->rowCount(), numRows);
+        QVERIFY(searchInProgressChanged.wait());
+        QVERIFY(!model->isSearchInProgress());
+        QCOMPARE(model->rowCount(), numRows);
+    }
+
     void cleanupTestCase()
     {
         FakeSearchResultsStorage::destroy();